@@ -13,7 +13,10 @@ document.addEventListener('DOMContentLoaded', () => {
             faults: null,
             notifications: null,
             systemInfo: null
-        }
+        },
+        // Push kanalı (SSE) durumu - bağlıyken polling devre dışı kalır
+        streamConnected: false,
+        streamListeners: {}
     };
 
     // Klavye navigasyonu için
@@ -64,16 +67,12 @@ function startSessionKeepalive() {
         clearInterval(sessionKeepaliveInterval);
     }
     
-    // Her 5 dakikada bir basit bir API çağrısı yap
+    // Her 5 dakikada bir oturumu yenile (push kanalı oturumu yenilemez)
     sessionKeepaliveInterval = setInterval(async () => {
         try {
-            const response = await fetch('/api/device-info', {
-                headers: {
-                    'Authorization': `Bearer ${state.token}`
-                }
-            });
+            const response = await secureFetch('/api/session/refresh');
             
-            if (response.ok) {
+            if (response && response.ok) {
                 console.log('🔄 Session keepalive');
             }
         } catch (error) {
@@ -82,27 +81,136 @@ function startSessionKeepalive() {
     }, 300000); // 5 dakika
 }
 
+// Sunucu push kanalı (SSE) - durum, LED, log, arıza ve link olayları
+let eventSource = null;
+const STREAM_EVENT_TYPES = ['status', 'led', 'log', 'fault', 'link'];
+const globalStreamListeners = {};
+
+function onGlobalStreamEvent(type, handler) {
+    (globalStreamListeners[type] = globalStreamListeners[type] || []).push(handler);
+}
+
+// Sayfaya özel dinleyici - sayfa değişince temizlenir
+function onPageStreamEvent(type, handler) {
+    (state.streamListeners[type] = state.streamListeners[type] || []).push(handler);
+}
+
+function startEventStream() {
+    if (!state.token || typeof EventSource === 'undefined') {
+        return; // Desteklenmiyorsa polling ile devam
+    }
+    if (eventSource) {
+        eventSource.close();
+    }
+    
+    eventSource = new EventSource(`/api/events?token=${encodeURIComponent(state.token)}`);
+    
+    eventSource.onopen = () => {
+        state.streamConnected = true;
+        console.log('📡 Olay akışı bağlandı');
+    };
+    
+    eventSource.onerror = () => {
+        // EventSource kendisi yeniden bağlanır; bu sürede polling devreye girer
+        state.streamConnected = false;
+    };
+    
+    STREAM_EVENT_TYPES.forEach(type => {
+        eventSource.addEventListener(type, (e) => {
+            let data;
+            try {
+                data = JSON.parse(e.data);
+            } catch (err) {
+                return;
+            }
+            (globalStreamListeners[type] || []).forEach(fn => fn(data));
+            (state.streamListeners[type] || []).forEach(fn => fn(data));
+        });
+    });
+    
+    // Oturum sunucu tarafında geçersizleşti - akışı kapat, polling 401 ile çıkış yapar
+    eventSource.addEventListener('auth', () => {
+        eventSource.close();
+        eventSource = null;
+        state.streamConnected = false;
+    });
+}
+
     // --- 2. SAYFA BAŞLATMA FONKSİYONLARI ---
     
     // Gösterge Paneli
 function initDashboardPage() {
     console.log("Gösterge paneli başlatılıyor...");
     
-    const updateStatus = () => {
-        secureFetch('/api/status')
+    // LED Panel başlatma - anlık görüntüdeki LED verisi buraya aktarılır
+    const ledPanel = initLedPanelForDashboard();
+    
+    // Durum, LED ve bildirimler tek istekte: /api/dashboard
+    let statusBase = null;
+    let snapshotVersion = -1;
+    const loadSnapshot = () => {
+        secureFetch('/api/dashboard')
             .then(response => response && response.json())
-            .then(data => data && updateDashboardUI(data))
+            .then(snap => {
+                if (!snap || snap.version === snapshotVersion) return;
+                snapshotVersion = snap.version;
+                
+                if (snap.status) {
+                    statusBase = { data: snap.status, receivedAt: Date.now() };
+                    updateDashboardUI(snap.status);
+                }
+                if (ledPanel) {
+                    // LED henüz arka planda okunmadıysa doğrudan sorgula
+                    if (snap.led) ledPanel.applyLedData(snap.led);
+                    else ledPanel.updateLedStatus();
+                }
+                if (snap.notifications) setNotificationBadge(snap.notifications.count);
+            })
             .catch(error => {
-                console.error('Durum verileri alınamadı:', error);
-                showMessage('Durum verileri alınamadı', 'error');
+                console.error('Panel verileri alınamadı:', error);
+                showMessage('Panel verileri alınamadı', 'error');
             });
     };
     
-    updateStatus();
-    state.pollingIntervals.status = setInterval(updateStatus, 5000);
+    loadSnapshot();
+    
+    // Push kanalı bağlıyken durum olaylarını dinle, saat/uptime'ı yerelde ilerlet
+    onPageStreamEvent('status', data => {
+        statusBase = { data, receivedAt: Date.now() };
+        updateDashboardUI(data);
+    });
+    onPageStreamEvent('link', data => {
+        const ethStatusEl = document.getElementById('ethernetStatus');
+        if (ethStatusEl) ethStatusEl.innerHTML = `<span class="status-indicator ${data.linkUp ? 'active' : 'error'}"></span> ${data.linkUp ? 'Bağlı' : 'Yok'}`;
+    });
+    
+    let pollTick = 0;
+    state.pollingIntervals.status = setInterval(() => {
+        if (!state.streamConnected) {
+            // Akış yoksa 3 saniyede bir anlık görüntüyü sorgula (durum + LED + bildirim)
+            if (++pollTick % 3 === 0) loadSnapshot();
+            return;
+        }
+        if (statusBase) tickDashboardClock(statusBase);
+    }, 1000);
+}
+
+// Son status olayından bu yana geçen süreyi saat ve uptime alanlarına ekle (istek atmaz)
+function tickDashboardClock(statusBase) {
+    const elapsed = Math.floor((Date.now() - statusBase.receivedAt) / 1000);
+    const data = statusBase.data;
+    
+    const base = new Date((data.datetime || '').replace(' ', 'T'));
+    if (!isNaN(base.getTime())) {
+        const now = new Date(base.getTime() + elapsed * 1000);
+        const pad = n => String(n).padStart(2, '0');
+        updateElement('currentDateTime', `${now.getFullYear()}-${pad(now.getMonth() + 1)}-${pad(now.getDate())} ${pad(now.getHours())}:${pad(now.getMinutes())}:${pad(now.getSeconds())}`);
+    }
     
-    // LED Panel başlatma - BURAYA TAŞIYIN
-    initLedPanelForDashboard();
+    if (typeof data.uptimeSeconds === 'number') {
+        const sec = data.uptimeSeconds + elapsed;
+        updateElement('uptime', `${Math.floor(sec / 3600)}:${String(Math.floor((sec % 3600) / 60)).padStart(2, '0')}:${String(sec % 60).padStart(2, '0')}`);
+    }
 }
 
 // Yeni fonksiyon olarak ekleyin:
@@ -128,8 +236,15 @@ function initLedPanelForDashboard() {
                 return;
             }
             
-            const data = await response.json();
-            
+            applyLedData(await response.json());
+        } catch (error) {
+            console.error('LED güncelleme hatası:', error);
+        }
+    }
+    
+    // /api/led/status yanıtı ve push kanalı 'led' olayı aynı formatta
+    function applyLedData(data) {
+        try {
             if (data.success && data.parsed && data.parsed.valid) {
                 updateLedVisualsInDashboard(data.parsed);
                 
@@ -345,19 +460,16 @@ function initLedPanelForDashboard() {
         });
     }
     
-    // İlk yükleme
-    updateLedStatus();
+    // Push kanalı bağlıyken LED değişiklikleri olay olarak gelir
+    onPageStreamEvent('led', data => {
+        if (ledAutoRefresh) applyLedData(data);
+    });
     
-    // 3 saniyede bir otomatik güncelle (sadece dashboard'ta)
-    window.ledUpdateInterval = setInterval(() => {
-        if (window.location.hash === '#dashboard' || window.location.hash === '') {
-            updateLedStatus();
-        } else {
-            // Dashboard dışındaysa interval'i temizle
-            clearInterval(window.ledUpdateInterval);
-            window.ledUpdateInterval = null;
-        }
-    }, 3000);
+    // İlk yükleme ve periyodik yenileme initDashboardPage'deki /api/dashboard üzerinden
+    return {
+        applyLedData: data => { if (ledAutoRefresh) applyLedData(data); },
+        updateLedStatus
+    };
 }
    
 // Network Ayarları Sayfası - SADECE STATİK IP VERSİYONU
@@ -537,25 +649,15 @@ function initNetworkPage() {
             
             if (response && response.ok) {
                 const result = await response.json();
-                showMessage(result.message || 'Network ayarları kaydedildi! Cihaz yeniden başlatılıyor...', 'success');
+                showMessage(result.message || 'Ağ ayarları uygulanıyor...', 'success', 8000);
                 
-                // Countdown timer göster
-                let countdown = 10;
-                const countdownInterval = setInterval(() => {
-                    showMessage(`Cihaz ${countdown} saniye içinde yeniden başlatılıyor...`, 'warning');
-                    countdown--;
-                    
-                    if (countdown < 0) {
-                        clearInterval(countdownInterval);
-                        // Yeni IP ile yönlendirme
-                        const newIP = formData.get('staticIP');
-                        if (newIP) {
-                            window.location.href = `http://${newIP}`;
-                        } else {
-                            window.location.href = '/';
-                        }
-                    }
-                }, 1000);
+                // Ayar yaklaşık 1 sn içinde uygulanır; yeni adreste giriş yapılıp onaylanmalı
+                const newIP = result.newIP || formData.get('staticIP');
+                const timeout = result.confirmTimeout || 120;
+                showMessage(`Yeni adrese yönlendiriliyorsunuz. ${timeout} sn içinde onaylanmazsa önceki ayara dönülür.`, 'warning', 8000);
+                setTimeout(() => {
+                    window.location.href = newIP ? `http://${newIP}/` : '/';
+                }, 3000);
                 
             } else {
                 const errorText = response ? await response.text() : 'Ağ hatası';
@@ -955,9 +1057,9 @@ function escapeHtml(text) {
     function initSystemInfoPage() {
         const updateSystemInfo = async () => {
             try {
-                const response = await secureFetch('/api/system-info');
-                if (response && response.ok) {
-                    const data = await response.json();
+                const result = await fetchJsonConditional('/api/system-info');
+                if (result && !result.notModified) {
+                    const data = result.data;
                     
                     // Hardware bilgileri
                     updateElement('chipModel', data.hardware.chip);
@@ -3076,10 +3178,19 @@ function initLogPage() {
     let currentPage = 1;
     let totalPages = 1;
     let totalLogs = 0;
+    let totalLogsPartial = false;   // Sunucu günlük tarama sınırına takıldı: toplam alt sınır
     let allLogs = [];
     let filteredLogs = [];
     let autoRefreshActive = true;
     let refreshIntervalId = null;
+    let logsDirty = false; // Push kanalından yeni log geldi mi?
+    let lastLogSeq = null; // /api/logs/tail imleci (ilk sayfa görünümü)
+    let logBootId = null;  // İmlecin ait olduğu açılış; cihaz yeniden başlarsa sunucu reset döner
+    let logPageSize = 50;
+    let tailInFlight = false;
+    let logGeneration = 0; // Tam yükleme yapılınca eski tail yanıtları yok sayılır
+    
+    onPageStreamEvent('log', () => { logsDirty = true; });
     
     // Mevcut filtreler
     const currentFilters = {
@@ -3179,7 +3290,7 @@ function initLogPage() {
         
         const totalLogCountEl = document.getElementById('totalLogCount');
         if (totalLogCountEl) {
-            totalLogCountEl.textContent = totalLogs;
+            totalLogCountEl.textContent = totalLogs + (totalLogsPartial ? '+' : '');
         }
         
         const firstBtn = document.getElementById('firstPageBtn');
@@ -3249,6 +3360,8 @@ function initLogPage() {
                 <span class="log-level level-${log.l.toLowerCase()}">${log.l}</span>
                 <span class="log-source">${log.s}</span>
                 <span class="log-message">${highlightedMessage}</span>
+                ${log.n ? `<span class="log-repeat" title="${log.t} – ${log.tl}">×${log.n}</span>` : ''}
+                ${log.ml ? `<span class="log-last" title="${log.tl}">son: ${escapeHtml(log.ml)}</span>` : ''}
             `;
             
             fragment.appendChild(logEntry);
@@ -3259,7 +3372,7 @@ function initLogPage() {
 
     // İstatistikleri güncelle
     function updateLogStats() {
-        updateElement('totalLogs', totalLogs.toString());
+        updateElement('totalLogs', totalLogs.toString() + (totalLogsPartial ? '+' : ''));
         updateElement('lastLogUpdate', new Date().toLocaleTimeString());
     }
 
@@ -3298,13 +3411,18 @@ function initLogPage() {
                 search: currentFilters.search
             });
             
-            const response = await secureFetch(`/api/logs?${params}`);
-            if (response && response.ok) {
-                const data = await response.json();
+            logGeneration++;
+            const result = await fetchJsonConditional(`/api/logs?${params}`);
+            if (result && !result.notModified) {
+                const data = result.data;
                 
                 currentPage = data.currentPage || 1;
                 totalPages = data.totalPages || 1;
                 totalLogs = data.totalLogs || 0;
+                totalLogsPartial = !!data.partial;
+                logPageSize = data.pageSize || logPageSize;
+                lastLogSeq = (data.lastSeq !== undefined) ? data.lastSeq : null;
+                logBootId = (data.bootId !== undefined) ? data.bootId : null;
                 
                 allLogs = data.logs || [];
                 filteredLogs = allLogs;
@@ -3314,7 +3432,7 @@ function initLogPage() {
                     updateElement('warningCount', data.stats.warnCount.toString());
                 }
                 
-                updateSourceFilter();
+                updateSourceFilter(data.sources);
                 renderLogs();
                 updateLogStats();
                 updatePaginationDisplay();
@@ -3327,13 +3445,68 @@ function initLogPage() {
         }
     }
 
+    // Sadece son imleçten sonra eklenen logları çek ve ilk sayfanın başına ekle.
+    // timeoutMs > 0 ise sunucu yeni kayıt gelene kadar bekletir (uzun bekleme).
+    async function fetchLogTail(timeoutMs) {
+        if (tailInFlight || lastLogSeq === null) return;
+        tailInFlight = true;
+        const generation = logGeneration;
+        
+        try {
+            const params = new URLSearchParams({
+                since: lastLogSeq,
+                timeout: timeoutMs,
+                level: currentFilters.level,
+                source: currentFilters.source,
+                search: currentFilters.search
+            });
+            
+            if (logBootId !== null) params.set('boot', logBootId);
+            const response = await secureFetch(`/api/logs/tail?${params}`, { cache: 'no-store' });
+            if (!response || !response.ok) return;
+            const data = await response.json();
+            
+            // Sayfa/filtre değiştiyse veya duraklatıldıysa bu yanıt geçersiz
+            if (generation !== logGeneration || !logContainer.isConnected || currentPage !== 1 || state.logPaused) return;
+            
+            if (data.reset) {
+                await fetchLogs();
+                return;
+            }
+            
+            lastLogSeq = data.lastSeq;
+            if (data.stats) {
+                updateElement('errorCount', data.stats.errorCount.toString());
+                updateElement('warningCount', data.stats.warnCount.toString());
+            }
+            
+            const newLogs = data.logs || [];
+            if (newLogs.length > 0) {
+                allLogs = newLogs.concat(allLogs).slice(0, logPageSize);
+                filteredLogs = allLogs;
+                totalLogs += newLogs.length;
+                totalPages = Math.max(1, Math.ceil(totalLogs / logPageSize));
+                
+                updateSourceFilter();
+                renderLogs();
+                updateLogStats();
+                updatePaginationDisplay();
+            }
+        } catch (error) {
+            console.error('Log takip hatası:', error);
+        } finally {
+            tailInFlight = false;
+        }
+    }
+
     // Kaynak filtresi güncelle
-    function updateSourceFilter() {
+    function updateSourceFilter(knownSources) {
         if (!logSourceFilter) return;
         
         const currentValue = logSourceFilter.value;
         const sources = new Set(['all']);
         
+        (knownSources || []).forEach(source => sources.add(source));
         allLogs.forEach(log => sources.add(log.s));
         
         logSourceFilter.innerHTML = '<option value="all">Tümü</option>';
@@ -3356,10 +3529,23 @@ function initLogPage() {
         
         if (autoRefreshActive && interval > 0) {
             refreshIntervalId = setInterval(() => {
-                if (currentPage === 1 && !state.logPaused) {
+                if (currentPage !== 1 || state.logPaused) return;
+                
+                if (lastLogSeq === null) {
                     fetchLogs();
+                } else if (state.streamConnected) {
+                    // Akış bağlıyken sadece yeni log geldiyse artımlı sorgula
+                    if (logsDirty) {
+                        logsDirty = false;
+                        fetchLogTail(0);
+                    }
+                } else {
+                    // Push kanalı yoksa sunucu yeni kayıt gelene kadar bekletir
+                    fetchLogTail(20000);
                 }
             }, interval);
+            // Sayfa değişince loadPage tarafından temizlenir
+            state.pollingIntervals.logs = refreshIntervalId;
             console.log(`⏱️ Otomatik yenileme: ${interval/1000}s`);
         }
     }
@@ -3741,7 +3927,11 @@ function initBackupPage() {
 // Yedek indirme fonksiyonu (global olarak tanımlanmalı - window nesnesine ekle)
 window.downloadBackup = async function downloadBackup() {
     try {
-        const response = await secureFetch('/api/backup/download');
+        const params = new URLSearchParams();
+        if (document.getElementById('backupIncludeLogs')?.checked) params.set('logs', '1');
+        if (document.getElementById('backupIncludeStats')?.checked) params.set('stats', '1');
+        const query = params.toString();
+        const response = await secureFetch('/api/backup/download' + (query ? '?' + query : ''));
         
         if (response && response.ok) {
             // Blob olarak indirme
@@ -3749,7 +3939,7 @@ window.downloadBackup = async function downloadBackup() {
             const url = window.URL.createObjectURL(blob);
             const a = document.createElement('a');
             a.href = url;
-            a.download = `teias_eklim_backup_${new Date().toISOString().slice(0, 10)}.json`;
+            a.download = `teias_eklim_backup_${new Date().toISOString().slice(0, 10)}.tbk`;
             document.body.appendChild(a);
             a.click();
             document.body.removeChild(a);
@@ -3783,6 +3973,14 @@ window.downloadBackup = async function downloadBackup() {
 
     function logout() {
         Object.values(state.pollingIntervals).forEach(clearInterval);
+        if (eventSource) {
+            eventSource.close();
+            eventSource = null;
+        }
+        // Sunucudaki oturum kaydını da kapat (diğer operatörlerin oturumları açık kalır)
+        if (state.token) {
+            fetch('/logout', { headers: { 'Authorization': `Bearer ${state.token}` }, keepalive: true }).catch(() => {});
+        }
         localStorage.removeItem('sessionToken');
         window.location.href = '/login.html';
     }
@@ -3811,8 +4009,35 @@ window.downloadBackup = async function downloadBackup() {
         }
     }
 
+    // Koşullu GET: son ETag'i If-None-Match olarak gönder, 304 gelirse önceki veriyi kullan
+    const conditionalCache = new Map();
+    const CONDITIONAL_CACHE_LIMIT = 20;
+    async function fetchJsonConditional(url) {
+        const cached = conditionalCache.get(url);
+        const headers = cached ? { 'If-None-Match': cached.etag } : {};
+        const response = await secureFetch(url, { headers, cache: 'no-store' });
+        if (!response) return null;
+        
+        if (response.status === 304 && cached) {
+            return { data: cached.data, notModified: true };
+        }
+        if (!response.ok) return null;
+        
+        const data = await response.json();
+        const etag = response.headers.get('ETag');
+        if (etag) {
+            conditionalCache.delete(url);
+            conditionalCache.set(url, { etag, data });
+            if (conditionalCache.size > CONDITIONAL_CACHE_LIMIT) {
+                conditionalCache.delete(conditionalCache.keys().next().value);
+            }
+        }
+        return { data, notModified: false };
+    }
+
     async function loadPage(pageName) {
         Object.values(state.pollingIntervals).forEach(clearInterval);
+        state.streamListeners = {};
 
         const page = pages[pageName] || pages['dashboard'];
         const mainContent = document.getElementById('main-content');
@@ -3833,8 +4058,8 @@ window.downloadBackup = async function downloadBackup() {
                         mainContent.innerHTML = `<div class="error">Sayfa başlatılırken bir hata oluştu.</div>`;
                     }
                 }
-                // Bildirim sayısını güncelle
-                updateNotificationCount();
+                // Bildirim sayısını güncelle (panel bunu /api/dashboard ile zaten alıyor)
+                if (page !== pages.dashboard) updateNotificationCount();
             } else {
                 mainContent.innerHTML = `<div class="error">Sayfa yüklenemedi (Hata: ${response ? response.status : 'Ağ Hatası'})</div>`;
             }
@@ -3944,17 +4169,23 @@ function showMessage(text, type = 'info', duration = 4000) {
     console.log(`[${type.toUpperCase()}] ${text}`);
 }
 
-    // Notification sistemi
+    // Notification sistemi - imleçten sonra yeni bildirim yoksa sunucu boş liste döner
+    let lastNotificationId = 0;
+
+    function setNotificationBadge(count) {
+        const badge = document.getElementById('notificationCount');
+        if (badge) {
+            badge.textContent = count;
+            badge.style.display = count > 0 ? 'block' : 'none';
+        }
+    }
+
     async function updateNotificationCount() {
         try {
-            const response = await secureFetch('/api/notifications');
-            if (response && response.ok) {
-                const data = await response.json();
-                const badge = document.getElementById('notificationCount');
-                if (badge) {
-                    badge.textContent = data.count;
-                    badge.style.display = data.count > 0 ? 'block' : 'none';
-                }
+            const result = await fetchJsonConditional(`/api/notifications?since=${lastNotificationId}`);
+            if (result && !result.notModified) {
+                lastNotificationId = result.data.lastId || lastNotificationId;
+                setNotificationBadge(result.data.count);
             }
         } catch (error) {
             console.error('Bildirim hatası:', error);
@@ -4031,20 +4262,74 @@ function showMessage(text, type = 'info', duration = 4000) {
             const response = await secureFetch('/api/notifications');
             if (response && response.ok) {
                 const data = await response.json();
-                console.log('Bildirimler:', data);
+                console.log('Bildirimler:', data.items);
                 // TODO: Bildirim popup'ı göster
+                
+                // Gösterilenleri okundu işaretle
+                if (data.count > 0) {
+                    const body = new URLSearchParams({ upTo: data.lastId });
+                    const readResponse = await secureFetch('/api/notifications/read', { method: 'POST', body });
+                    if (readResponse && readResponse.ok) setNotificationBadge(0);
+                }
             }
         });
 
         // Session keepalive başlat
         startSessionKeepalive();
         
-        // Bildirim güncelleme timer'ı
-        setInterval(updateNotificationCount, 30000); // 30 saniyede bir
+        // Push kanalı - yeni uyarı/hata ve arıza olaylarını dinle
+        let notificationsDirty = false;
+        onGlobalStreamEvent('log', data => {
+            if (data.l === 'ERROR' || data.l === 'WARN') notificationsDirty = true;
+        });
+        onGlobalStreamEvent('fault', data => {
+            if (data.newFaults > 0) {
+                showMessage(`⚠️ ${data.newFaults} yeni arıza kaydı (toplam ${data.count})`, 'warning', 6000);
+            }
+        });
+        onGlobalStreamEvent('link', data => {
+            if (data.linkUp) showMessage('✅ Ethernet bağlantısı geri geldi', 'success');
+        });
+        startEventStream();
+        
+        // Bildirim güncelleme timer'ı - akış bağlıyken sadece yeni uyarı varsa
+        setInterval(() => {
+            if (!state.streamConnected || notificationsDirty) {
+                notificationsDirty = false;
+                updateNotificationCount();
+            }
+        }, 30000); // 30 saniyede bir
         
         // Router'ı dinle ve ilk sayfayı yükle
         window.addEventListener('hashchange', router);
         router();
+        
+        // Canlı ağ değişikliği onay bekliyorsa sor
+        checkPendingNetworkChange();
+    }
+
+    // Yeni adrese geçildikten sonra onay verilmezse cihaz önceki ayara döner
+    async function checkPendingNetworkChange() {
+        try {
+            const response = await secureFetch('/api/network');
+            if (!response || !response.ok) return;
+            const data = await response.json();
+            if (!data.pending || !data.pending.remaining) return;
+            
+            const accepted = confirm(`Yeni ağ ayarı (${data.pending.ip}) onay bekliyor. ` +
+                `${data.pending.remaining} sn içinde onaylanmazsa önceki ayara dönülecek.\n\nBu adres çalışıyor, onaylıyor musunuz?`);
+            if (!accepted) return;
+            
+            const result = await secureFetch('/api/network/confirm', { method: 'POST' });
+            if (result && result.ok) {
+                showMessage('✅ Ağ ayarı onaylandı ve kaydedildi', 'success');
+            } else {
+                const error = result ? await result.json().catch(() => ({})) : {};
+                showMessage(error.error || 'Ağ ayarı onaylanamadı', 'error');
+            }
+        } catch (error) {
+            console.error('Ağ onayı kontrol hatası:', error);
+        }
     }
 
     main();
@@ -3,11 +3,30 @@
 
 #include <Arduino.h>
 
+// Oturum tablosu: 128 bit jeton (32 hex karakter) ile açık adreslemeli
+// (doğrusal yoklama) sabit tablo. Her oturum kendi bitiş zamanını, rolünü
+// ve istemci IP'sini taşır; süresi dolanlar erişildikçe temizlenir.
+// Tablo yalnızca webServerTask içinden kullanılır.
+#define MAX_SESSIONS          8     // Aynı anda açık oturum
+#define SESSION_TABLE_SIZE    16    // 2'nin kuvveti, MAX_SESSIONS'ın en az iki katı
+#define SESSION_TOKEN_BYTES   16
+
+enum SessionRole {
+    ROLE_USER = 0,
+    ROLE_ADMIN = 1
+};
+
 bool checkSession();
 void handleUserLogin();
 void handleUserLogout();
-void refreshSession();
-bool isTokenValid(const String& token); 
+bool isTokenValid(const String& token);       // Süreyi yenilemez (SSE heartbeat)
+bool isAdminSession();                        // Geçerli isteğin oturumu yönetici mi
+void endAllSessions();                        // Parola değişince
+int getActiveSessionCount();
 
-#endif
+// Route dispatch: Authorization başlığı istek başına bir kez ayrıştırılır
+void beginRequestSession();
+void endRequestSession();
+const String& getRequestToken();
 
+#endif
@@ -0,0 +1,101 @@
+#ifndef BACKUP_ARCHIVE_H
+#define BACKUP_ARCHIVE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "mbedtls/sha256.h"
+#include "lzss_codec.h"
+
+// Yedek arşivi (.tbk) düzeni:
+//   başlık : "TBK2" | sürüm (1) | bayraklar (1) | ayrılmış (2)
+//   gövde  : LZSS ile sıkıştırılmış bölüm akışı; her bölüm
+//            [tip (1)] [uzunluk (4, little-endian)] [veri]
+//   son ek : "TBKE" | ham uzunluk (4) | ayar özeti (32) | içerik özeti (32)
+// Ayar özeti (SHA-256) yalnızca ayar bölümünün verisini kapsar ve değişmemiş
+// yapılandırmanın tekrar yedeklenmesini önler. İçerik özeti tüm ham akışı
+// kapsar; geri yüklemede ayarlar uygulanmadan önce doğrulanır.
+#define BACKUP_ARCHIVE_VERSION   2
+#define BACKUP_HEADER_SIZE       8
+#define BACKUP_TRAILER_SIZE      72
+#define BACKUP_DIGEST_SIZE       32
+
+// Bayraklar: meta ve ayar bölümleri her zaman yazılır
+#define BACKUP_INCLUDE_LOGS      0x01    // Log günlüğü segmentleri
+#define BACKUP_INCLUDE_STATS     0x02    // Çalışma istatistikleri
+
+#define BACKUP_SECTION_META      'M'     // JSON
+#define BACKUP_SECTION_SETTINGS  'S'     // JSON (v1 yedek şeması)
+#define BACKUP_SECTION_STATS     'T'     // JSON
+#define BACKUP_SECTION_LOG       'L'     // [segment no (4)] + segment baytları
+
+struct BackupTrailer {
+    uint32_t rawLength;
+    uint8_t configDigest[BACKUP_DIGEST_SIZE];
+    uint8_t contentDigest[BACKUP_DIGEST_SIZE];
+};
+
+// Bölümleri sıkıştırarak out'a yazar; özetler yazım sırasında hesaplanır.
+// Bölüm uzunluğu önceden bildirilir, veri parça parça verilebilir.
+class BackupArchiveWriter {
+public:
+    BackupArchiveWriter(Print& out, uint8_t flags);
+    ~BackupArchiveWriter();
+
+    void beginSection(uint8_t type, uint32_t length);
+    void write(const uint8_t* data, size_t length);
+    void writeSection(uint8_t type, const String& data);
+    void finish(BackupTrailer& trailer);
+
+private:
+    void writeRaw(const uint8_t* data, size_t length);
+
+    Print& out;
+    LzssEncoder encoder;
+    mbedtls_sha256_context contentHash;
+    mbedtls_sha256_context configHash;
+    uint32_t rawLength;
+    bool inSettings;
+};
+
+// Arşivi sırayla okur; geçerli bölümün verisi Stream olarak sunulur
+// (ArduinoJson doğrudan ayrıştırabilir). verify() akışın kalanını tüketip
+// içerik özetini son ekle karşılaştırır.
+class BackupArchiveReader : public Stream {
+public:
+    explicit BackupArchiveReader(File& file);
+    ~BackupArchiveReader();
+
+    bool valid() const { return headerValid; }
+    uint8_t flags() const { return archiveFlags; }
+    const BackupTrailer& trailer() const { return archiveTrailer; }
+
+    bool nextSection(uint8_t& type, uint32_t& length);   // Önceki bölümün kalanı atlanır
+    bool verify();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override { return 0; }
+    void flush() override {}
+
+private:
+    int rawRead();
+    void hashPending();
+
+    LzssDecoder decoder;
+    mbedtls_sha256_context contentHash;
+    BackupTrailer archiveTrailer;
+    bool headerValid;
+    uint8_t archiveFlags;
+    uint32_t rawCount;
+    uint32_t sectionLeft;
+    int peeked;
+    uint8_t hashBuffer[64];
+    uint8_t hashFill;
+};
+
+bool isBackupArchive(File& file);                        // Konumu değiştirmez
+bool readBackupTrailer(File& file, BackupTrailer& trailer);
+void backupDigest(const String& data, uint8_t* digest);
+
+#endif // BACKUP_ARCHIVE_H
\ No newline at end of file
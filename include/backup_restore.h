@@ -3,14 +3,23 @@
 
 #include <Arduino.h>
 
+// Yüklenen yedek RAM'de biriktirilmez; parçalar staging dosyasına yazılır,
+// yükleme bitince akıştan ayrıştırılıp doğrulanır ve tek ayar kaydı olarak uygulanır.
+#define BACKUP_UPLOAD_MAX_BYTES  262144    // Log içeren arşivler için
+#define BACKUP_STAGING_FILE      "/restore_upload.tmp"
+
+// Otomatik yedek yalnızca ayar özeti son yedekten farklıysa yazılır (backup_archive.h)
+#define AUTO_BACKUP_CHECK_INTERVAL 3600000  // ms
+#define AUTO_BACKUP_KEEP           7
+
 // Function declarations
-String exportSettingsToJSON();
 String getBackupTimestamp();
-bool importSettingsFromJSON(const String& jsonData);
-bool saveBackupToFile(const String& filename);
+bool importSettingsFromStream(Stream& input);
+bool saveBackupToFile(const String& filename, uint8_t flags = 0);   // flags: BACKUP_INCLUDE_*
 bool loadBackupFromFile(const String& filename);
 void handleBackupDownload();
-void handleBackupUpload();
+void handleBackupUpload();     // Yükleme parçaları
+void handleBackupRestore();    // Yükleme sonrası yanıt
 void createAutomaticBackup();
 
 #endif // BACKUP_RESTORE_H
\ No newline at end of file
@@ -0,0 +1,104 @@
+#ifndef CIVIL_TIME_H
+#define CIVIL_TIME_H
+
+#include <Arduino.h>
+
+// Tarih-saat çekirdeği: değerler epoch saniye + ms olarak taşınır, metne
+// sadece çıkışta (dsPIC komutu, ISO, ekran) çağıranın tamponuna çevrilir.
+// ESP32 sistem saati ve dsPIC yerel saattedir; epoch da yerel saatin
+// saat dilimi uygulanmamış karşılığıdır.
+// epoch < CIVIL_EPOCH_VALID_MIN: değer yok / saat ayarlanmamış.
+#define CIVIL_EPOCH_VALID_MIN 1600000000UL   // 2020 öncesi
+
+// Tampon boyutları (sonlandırıcı dahil)
+#define CIVIL_DATE_SIZE      11   // "2025-02-27", "27/02/2025"
+#define CIVIL_TIME_SIZE      9    // "11:22:33"
+#define CIVIL_DATETIME_SIZE  20   // "2025-02-27 11:22:33"
+#define CIVIL_COMMAND_SIZE   8    // "112233c", "270225f"
+#define CIVIL_WIRE_SIZE      20   // "D:25/02/27 11:22:33"
+
+struct CivilTime {
+    uint32_t epoch;
+    uint16_t ms;
+
+    bool isValid() const { return epoch >= CIVIL_EPOCH_VALID_MIN; }
+};
+
+struct CivilFields {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+};
+
+// 1970-01-01'den bu yana gün (proleptik Gregoryen)
+constexpr int32_t civilDaysFromDate(int year, unsigned month, unsigned day) {
+    int y = year - (month <= 2 ? 1 : 0);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+constexpr bool civilIsLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+constexpr uint8_t civilDaysInMonth(int year, unsigned month) {
+    return month == 2 ? (civilIsLeapYear(year) ? 29 : 28)
+         : (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+}
+
+constexpr bool civilFieldsValid(int year, unsigned month, unsigned day,
+                                unsigned hour, unsigned minute, unsigned second) {
+    return year >= 2000 && year <= 2099 && month >= 1 && month <= 12 &&
+           day >= 1 && day <= civilDaysInMonth(year, month) &&
+           hour <= 23 && minute <= 59 && second <= 59;
+}
+
+constexpr uint32_t civilEpoch(int year, unsigned month, unsigned day,
+                              unsigned hour, unsigned minute, unsigned second) {
+    return (uint32_t)civilDaysFromDate(year, month, day) * 86400UL +
+           hour * 3600UL + minute * 60UL + second;
+}
+
+constexpr CivilFields civilFields(uint32_t epoch) {
+    uint32_t z = epoch / 86400 + 719468;
+    uint32_t era = z / 146097;
+    uint32_t doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+    uint32_t secs = epoch % 86400;
+    return CivilFields{
+        (uint16_t)(yoe + era * 400 + (month <= 2 ? 1 : 0)),
+        (uint8_t)month,
+        (uint8_t)(doy - (153 * mp + 2) / 5 + 1),
+        (uint8_t)(secs / 3600),
+        (uint8_t)(secs / 60 % 60),
+        (uint8_t)(secs % 60)
+    };
+}
+
+// Sistem saati (ayarlanmamışsa epoch = 0)
+CivilTime civilNow();
+
+// Ayrıştırma - geçersiz alan/aralıkta false, out değişmez
+bool parseDsPICDateTime(const char* text, CivilTime& out);                 // "[D:]YY/MM/DD HH:MM:SS"
+bool parseIsoDateTime(const char* date, const char* time, CivilTime& out);   // "YYYY-MM-DD", "HH:MM:SS"
+
+// Biçimlendirme - yazılan uzunluğu döner (size yetmezse 0).
+// Geçersiz değer sıfırlarla yazılır ("0000-00-00").
+size_t formatIsoDate(const CivilTime& value, char* out, size_t size);        // 2025-02-27
+size_t formatIsoTime(const CivilTime& value, char* out, size_t size);        // 11:22:33
+size_t formatIsoDateTime(const CivilTime& value, char* out, size_t size);    // 2025-02-27 11:22:33
+size_t formatDisplayDate(const CivilTime& value, char* out, size_t size);    // 27/02/2025
+size_t formatDsPICDateTime(const CivilTime& value, char* out, size_t size);  // D:25/02/27 11:22:33
+size_t formatDsPICTimeCommand(const CivilTime& value, char* out, size_t size);   // 112233c
+size_t formatDsPICDateCommand(const CivilTime& value, char* out, size_t size);   // 270225f
+
+#endif // CIVIL_TIME_H
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef CLIENT_LIMITER_H
+#define CLIENT_LIMITER_H
+
+#include <Arduino.h>
+
+// İstemci (IP) başına token bucket tablosu: istek hızı ve giriş hataları.
+// Her istemcinin kendi kovası vardır; bir istemcinin aşırı isteği veya hatalı
+// girişleri diğerlerini etkilemez. Tablo dolunca en uzun süredir görülmeyen
+// (kilitli olmayan) istemci çıkarılır. Yalnızca webServerTask içinden kullanılır.
+#define CLIENT_TABLE_SIZE         16
+#define RATE_BUCKET_CAPACITY      20       // Ani istek hakkı
+#define RATE_REFILL_MS            3000     // Bir istek hakkının dolma süresi (20/dk)
+#define LOGIN_FAILURE_CAPACITY    5        // Kilitlenmeden önceki hatalı deneme hakkı
+#define LOGIN_FAILURE_REFILL_MS   60000    // Bir hatalı deneme hakkının geri gelme süresi
+#define LOGIN_LOCKOUT_MS          300000   // Haklar bitince kilit süresi (5 dk)
+
+bool clientAllowRequest(const IPAddress& ip);             // RATE_LIMITED route'lar için
+unsigned long clientLoginLockRemaining(const IPAddress& ip);   // ms, kilit yoksa 0
+bool clientLoginFailed(const IPAddress& ip);              // true: bu hata ile kilitlendi
+void clientLoginSucceeded(const IPAddress& ip);
+int clientLoginAttemptsLeft(const IPAddress& ip);
+
+#endif // CLIENT_LIMITER_H
\ No newline at end of file
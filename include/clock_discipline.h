@@ -0,0 +1,43 @@
+#ifndef CLOCK_DISCIPLINE_H
+#define CLOCK_DISCIPLINE_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// dsPIC saatine göre ESP32 sistem saati disiplini.
+// dsPIC saniye çözünürlüğünde okur; her DN ölçümü gönderme/alma anlarıyla
+// (esp_timer_get_time) birlikte "dsPIC - ESP32" farkı için bir aralık verir.
+// Sorgular tahmini saniye sınırına denk getirilir; her örnek aralığı yarıya
+// indirir. Fark adım yerine adjtime ile kaydırılarak düzeltilir, sürüklenme
+// (ppm) örneklerden hesaplanıp sürekli telafi edilir. Sürüklenme belirlendikçe
+// sorgu aralığı uzar.
+#define CLOCK_STEP_THRESHOLD_US    1000000   // Bundan büyük fark adımla düzeltilir
+#define CLOCK_SLEW_DEADBAND_US     5000      // Bundan küçük fark düzeltilmez
+#define CLOCK_TARGET_WIDTH_US      80000     // Faz belirsizliği hedefi (±40 ms)
+#define CLOCK_BURST_MAX_SAMPLES    8         // Hedefe inmek için art arda en fazla örnek
+#define CLOCK_SYNC_MIN_INTERVAL    300000    // ms - varsayılan/en kısa sorgu aralığı
+#define CLOCK_SYNC_MAX_INTERVAL    3600000   // ms - sürüklenme biliniyorsa en uzun aralık
+#define CLOCK_DRIFT_APPLY_INTERVAL 60000     // ms - sürüklenme telafisi adımı
+#define CLOCK_DRIFT_HISTORY        8         // Sürüklenme regresyonu örnek sayısı
+#define CLOCK_DRIFT_MIN_SPAN       600       // s - sürüklenme için gereken en kısa gözlem süresi
+
+struct ClockDisciplineStatus {
+    bool locked;               // Faz belirsizliği hedefin altında
+    int32_t lastCorrectionUs;  // Son örnekte uygulanan düzeltme
+    uint32_t uncertaintyUs;    // Aralık yarı genişliği
+    float driftPpm;            // dsPIC'e göre ESP32 sürüklenmesi (+: ESP32 geri kalıyor)
+    bool driftKnown;
+    unsigned long intervalMs;  // Geçerli sorgu aralığı
+    unsigned int samples;
+};
+
+// DN ölçümünü işler: reference = dsPIC'in okuduğu saniye (yerel saat epoch'u)
+void clockDisciplineSample(time_t reference, int64_t sentUs, int64_t receivedUs);
+void clockDisciplineMiss();                // Ölçüm başarısız - burst'ü sonlandır
+void clockDisciplineInvalidate();          // dsPIC saati elle değiştirildi: modeli sıfırla, hemen ölç
+bool clockDisciplineDue();                 // Sorgu zamanı geldi mi
+uint32_t clockDisciplineWaitMs();          // Sorguyu tahmini saniye sınırına denk getirmek için bekleme
+void processClockDiscipline();             // Sürüklenme telafisi - checkTimeSync içinden
+ClockDisciplineStatus getClockDisciplineStatus();
+
+#endif // CLOCK_DISCIPLINE_H
\ No newline at end of file
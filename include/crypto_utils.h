@@ -3,8 +3,37 @@
 
 #include <Arduino.h>
 
+// Parola özetleri sürümlüdür:
+//   v0 (eski): 64 hex karakter, tek tur SHA-256(salt + parola)
+//   v1:        "$p2$<tur>$<64 hex>" - PBKDF2-HMAC-SHA256 (donanım SHA motoru)
+// Tur sayısı ilk açılışta ~PASSWORD_HASH_TARGET_MS sürecek şekilde ölçülür ve
+// saklanır. Eski veya daha az turlu özetler başarılı girişte yeniden üretilir.
+#define PASSWORD_HASH_TARGET_MS      200
+#define PASSWORD_HASH_MIN_ITERATIONS 4096
+#define PASSWORD_HASH_MAX_ITERATIONS 200000
+
 String sha256(const String& data, const String& salt);
 // Fonksiyon adını daha anlaşılır hale getirelim
-String generateRandomToken(int length = 32); 
+String generateRandomToken(int length = 32);
+
+void initPasswordHashing();                      // loadSettings'ten önce
+uint32_t getPasswordHashIterations();
+String hashPassword(const String& password, const String& salt);
+bool verifyPassword(const String& password, const String& salt, const String& storedHash);
+bool passwordHashNeedsUpgrade(const String& storedHash);
+bool constantTimeEquals(const String& a, const String& b);
+
+// Yazılım / donanım SHA-256 karşılaştırması (KB/s) ve giriş başına PBKDF2 süresi.
+// İstenen boyut, HASH_BENCHMARK_CHUNK'lık tek bir tamponun tekrar tekrar
+// özetlenmesiyle elde edilir; tampon ayrılamazsa false döner.
+#define HASH_BENCHMARK_CHUNK 4096    // 64'ün katı olmalı
+struct HashBenchmark {
+    uint32_t bytes;
+    float softwareKBps;
+    float hardwareKBps;
+    uint32_t iterations;
+    uint32_t pbkdf2Ms;
+};
+bool runHashBenchmark(uint32_t bytes, HashBenchmark& result);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef DASHBOARD_SNAPSHOT_H
+#define DASHBOARD_SNAPSHOT_H
+
+#include <Arduino.h>
+
+// Gösterge paneli için önceden hesaplanmış anlık görüntü.
+// Her bölüm (durum, LED, bildirimler, sistem, zaman, arıza) kendi verisi
+// değiştiğinde arka planda yeniden üretilir; /api/dashboard sadece birleştirir.
+void initDashboardSnapshot();
+void updateDashboardSnapshot();                    // uartTask döngüsünden çağrılır
+void handleDashboardAPI();                         // GET /api/dashboard
+
+// Bölüm besleyicileri - herhangi bir task'tan çağrılabilir
+void notifyFaultCount(int count);                  // Arıza sayısı her okunduğunda
+unsigned long getFaultCountAge();                  // Son doğrulamadan bu yana geçen ms
+int getLastFaultCount();                           // Henüz okunmadıysa -1
+
+unsigned long getDashboardVersion();
+String getDashboardLedJSON();                      // Son bilinen LED durumu (boşsa henüz okunmadı)
+
+#endif // DASHBOARD_SNAPSHOT_H
\ No newline at end of file
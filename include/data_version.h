@@ -0,0 +1,24 @@
+#ifndef DATA_VERSION_H
+#define DATA_VERSION_H
+
+#include <Arduino.h>
+
+// Veri alanları - her biri içeriği değiştikçe artan bir sürüm sayacı tutar.
+// JSON API'leri ETag'i bu sayaçtan üretir; If-None-Match eşleşirse
+// doküman hiç oluşturulmadan 304 döner.
+enum DataDomain {
+    DATA_LOGS = 0,          // addLog / clearLogs
+    DATA_NOTIFICATIONS,     // ERROR/WARN logları
+    DATA_SYSTEM,            // Sistem bilgisi örneklemesi (dashboard işi)
+    DATA_FAULTS,            // Arıza sayısı değişimi / silme
+    DATA_SETTINGS,          // saveSettingsStore (cihaz/TM adı, ağ, hesap...)
+    DATA_DOMAIN_COUNT
+};
+
+void initDataVersions();
+void bumpDataVersion(DataDomain domain);
+uint32_t getDataVersion(DataDomain domain);
+String getDataETag(DataDomain domain);
+uint32_t getBootId();                    // Her açılışta rastgele; imleçlerin hangi açılışa ait olduğunu ayırır
+
+#endif // DATA_VERSION_H
\ No newline at end of file
@@ -2,12 +2,11 @@
 #define DATETIME_HANDLER_H
 
 #include <Arduino.h>
+#include "civil_time.h"
 
 // DateTime işleme yapısı
 struct DateTimeData {
-    String rawData;
-    String date;
-    String time;
+    CivilTime value;           // dsPIC'in son DN yanıtı
     unsigned long lastUpdate;
     bool isValid;
 };
@@ -18,7 +17,7 @@ extern DateTimeData datetimeData;
 // Komut geçmişi yapısı
 struct CommandHistory {
     String command;
-    String timestamp;
+    CivilTime at;              // Saat ayarlanmamışsa epoch = açılıştan bu yana saniye
     bool success;
     String response;
 };
@@ -26,18 +25,13 @@ struct CommandHistory {
 // Fonksiyon tanımlamaları
 bool requestDateTimeFromDsPIC();
 bool parseeDateTimeResponse(const String& response);
-bool setDateTimeToDsPIC(const String& date, const String& time);
-String formatDateCommand(const String& date);
-String formatTimeCommand(const String& time);
-bool validateDateTime(const String& date, const String& time);
-String getCurrentESP32DateTime();
+bool setDateTimeToDsPIC(const CivilTime& value);
+void getCurrentESP32DateTime(char* out, size_t size);   // Saat yoksa "Uptime: HH:MM:SS"
 bool syncWithESP32Time();
 void addCommandToHistory(const String& command, bool success, const String& response);
 String getCommandHistoryJSON();
 
 // Yardımcı fonksiyonlar
-String formatDateForDisplay(const String& rawDate);
-String formatTimeForDisplay(const String& rawTime);
 bool isDateTimeDataValid();
 void clearDateTimeData();
 
@@ -0,0 +1,29 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+
+// Push kanalı (Server-Sent Events) olay tipleri
+enum StreamEventType {
+    EVT_STATUS = 0,   // Durum değişikliği (ethernet, zaman senkronu, cihaz adı...)
+    EVT_LED = 1,      // LED / alarm bitmap değişikliği
+    EVT_LOG = 2,      // Yeni log kaydı
+    EVT_FAULT = 3,    // Arıza sayısı değişikliği
+    EVT_LINK = 4      // Ethernet link up/down
+};
+
+struct LogEntry;
+
+void initEventStream();
+void handleEventStreamAPI();                       // GET /api/events?token=...
+void processEventStream();                         // webServerTask döngüsünden çağrılır
+
+// Olay yayınlama - herhangi bir task'tan çağrılabilir, abone yoksa hiçbir şey yapmaz
+void publishEvent(StreamEventType type, const String& jsonData);
+void publishLogEvent(const LogEntry& entry);
+void publishLinkEvent(bool linkUp);
+
+bool hasEventSubscribers();
+int getEventSubscriberCount();
+
+#endif // EVENT_STREAM_H
\ No newline at end of file
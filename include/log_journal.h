@@ -0,0 +1,42 @@
+#ifndef LOG_JOURNAL_H
+#define LOG_JOURNAL_H
+
+#include <Arduino.h>
+#include <vector>
+#include "log_system.h"
+
+// LittleFS üzerinde kalıcı log günlüğü.
+// Kayıtlar sabit boyutlu segment dosyalarına CRC korumalı olarak eklenir;
+// en eski segment dolunca silinir. Yazma işlemi RAM tamponundan toplu
+// olarak arka planda yapılır (flash aşınmasını sınırlamak için).
+#define JOURNAL_DIR "/logs"
+#define JOURNAL_SEGMENT_SIZE 16384        // Segment başına bayt
+#define JOURNAL_MAX_SEGMENTS 16           // Toplam ~256 KB, ~3600 kayıt: RAM halkasının (2000) yaklaşık iki katı
+#define JOURNAL_FLUSH_INTERVAL 10000      // ms - normal toplu yazma aralığı
+#define JOURNAL_FLUSH_THRESHOLD 64        // Bu kadar kayıt birikirse beklemeden yaz
+#define JOURNAL_QUERY_SCAN_LIMIT 1000     // Sorgu başına okunabilecek en fazla kayıt
+
+void initLogJournal();                    // LittleFS ve initLogSystem'den sonra
+void processLogJournal();                 // uartTask döngüsünden çağrılır
+void flushLogJournal();                   // Bekleyen kayıtları hemen yaz (yeniden başlatma öncesi)
+void clearLogJournal();                   // clearLogs içinden
+
+// Yedekleme için segment listesi (eskiden yeniye). Boyutlar alındığı andaki
+// değerdir; okuyucu en fazla bu kadar bayt kopyalar.
+struct JournalSegmentRef {
+    uint32_t number;
+    size_t size;
+};
+size_t snapshotJournalSegments(JournalSegmentRef* out, size_t maxCount);
+String getJournalSegmentPath(uint32_t number);
+
+// RAM'de artık bulunmayan (önceki açılışlar dahil) kayıtların sayısı.
+// Segment ve tampon sayaçlarından hesaplanır; tek boyutlu filtre (-1 = hepsi).
+size_t countJournalHistory(int level, int source);
+// En yeniden eskiye: filtreye uyanlardan skip kadar atla, en fazla maxCount kayıt ekle.
+// countAll ise tüm segmentler taranır ve toplam eşleşme sayısı döner.
+// JOURNAL_QUERY_SCAN_LIMIT kayıt okununca durur; *partial true olur ve
+// dönen sayı o ana kadarki eşleşmelerdir (alt sınır).
+size_t queryJournalHistory(const LogQuery& query, size_t skip, size_t maxCount, std::vector<LogEntry>& out, bool countAll, bool* partial = NULL);
+
+#endif // LOG_JOURNAL_H
\ No newline at end of file
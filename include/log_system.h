@@ -12,32 +12,235 @@ enum LogLevel {
     SUCCESS = 4
 };
 
+#define LOG_LEVEL_COUNT 5
+
+// Tamponda tutulan kompakt kayıt (24 bayt).
+// Zaman damgası sayı olarak saklanır, metne sadece gösterilirken çevrilir.
+// epoch < LOG_EPOCH_VALID_MIN ise saat henüz senkron değildir ve değer
+// açılıştan bu yana geçen saniyedir.
+struct LogRecord {
+    uint32_t epoch;        // Unix saniye (veya uptime saniye)
+    uint32_t seq;          // Açılıştan beri artan kayıt numarası
+    uint16_t ms;           // Milisaniye
+    uint16_t msgOffset;    // Mesajın arena içindeki konumu
+    uint16_t msgLength;    // Mesaj uzunluğu (bayt, sonlandırıcısız)
+    uint8_t level;         // LogLevel
+    uint8_t source;        // Kaynak tablosundaki indeks
+    uint16_t prevSameLevel;    // İndeks: aynı seviyedeki bir önceki kaydın slot'u
+    uint16_t prevSameSource;   // İndeks: aynı kaynaktaki bir önceki kaydın slot'u
+    uint16_t repeat;       // Tekrar penceresinde bu kayda katlanan ek tekrar sayısı
+    uint16_t repeatSpan;   // İlk ile son tekrar arası (saniye)
+};
+
+#define LOG_NO_SLOT 0xFFFF
+
+// Okuma tarafındaki görünüm - kayıttan mesaj kopyalanarak oluşturulur
 struct LogEntry {
-    String timestamp;
-    String message;
+    uint32_t seq;
+    uint32_t epoch;
+    uint16_t ms;
     LogLevel level;
-    String source;
-    unsigned long millis_time;
+    uint8_t source;
+    uint16_t repeat;       // 0: tekil kayıt
+    uint32_t lastEpoch;    // Son tekrarın zamanı (tekrar yoksa epoch)
+    String message;        // İlk olayın metni
+    String lastMessage;    // Son tekrarın metni (kırpılmış, tekrar yoksa boş)
+};
+
+#define LOG_EPOCH_VALID_MIN 1600000000UL   // 2020 öncesi epoch = senkron yok
+#define LOG_MAX_MESSAGE_LENGTH 512         // Daha uzun mesajlar kırpılır
+#define LOG_MAX_SOURCES 32                 // Kaynak tablosu kapasitesi
+#define LOG_QUEUE_SIZE 128                 // addLog kuyruğu (2'nin kuvveti)
+#define LOG_SOURCE_NONE -2                 // Bilinmeyen kaynak filtresi: hiçbir kayıt eşleşmez
+#define LOG_REPEAT_WINDOW 10000            // ms - aynı mesaj şablonu bu süre içinde tek kayda katlanır
+#define LOG_REPEAT_SLOTS 32                // Son mesaj parmak izleri tablosu
+#define LOG_REPEAT_LAST_SIZE 64            // Son tekrar metninden saklanan bayt
+#define LOG_CLEAR_TIMEOUT 2000             // ms - clearLogs sink onayı için en fazla bekler
+#define LOG_FORMAT_BUFFER_SIZE 192         // addLogf yığın tamponu (uzun mesajlar kuyruğun büyük bloğuna biçimlenir)
+
+// Derleme zamanı log seviyesi. LOG_COMPILE_LEVEL'in üstündeki makrolar boş
+// ifadeye dönüşür; argümanları hiç değerlendirilmez, mesaj biçimlenmez.
+// SUCCESS, INFO ile aynı kademededir.
+#define LOG_RANK_ERROR 0
+#define LOG_RANK_WARN  1
+#define LOG_RANK_INFO  2
+#define LOG_RANK_DEBUG 3
+
+#ifndef LOG_COMPILE_LEVEL
+#ifdef DEBUG_MODE
+#define LOG_COMPILE_LEVEL LOG_RANK_DEBUG
+#else
+#define LOG_COMPILE_LEVEL LOG_RANK_INFO
+#endif
+#endif
+
+// Log sorgusu - filtreler sayfalamadan önce uygulanır
+struct LogQuery {
+    int level = -1;        // -1: tüm seviyeler
+    int source = -1;       // -1: tüm kaynaklar, LOG_SOURCE_NONE: eşleşme yok
+    String search;         // Küçük harfli arama terimi (boş = arama yok)
+
+    // Sonuç sayısı indeks sayaçlarından O(1) bulunabilir mi?
+    bool countFromIndex() const { return search.length() == 0 && !(level >= 0 && source >= 0); }
 };
 
-// Dinamik log sistemi için değişkenler
-extern std::vector<LogEntry> logStorage;  // Dinamik log depolama
-extern const int MAX_LOG_SIZE;            // Maksimum log sayısı (500 olarak ayarlanacak)
+// Sabit kapasiteli dairesel log tamponu.
+// Kayıtlar sabit bir dizide, mesaj baytları ortak bir dairesel arenada durur.
+// Ekleme O(1): kayıt dizisi veya arena dolunca en eski kayıtlar düşürülür.
+// İndeksler mantıksaldır: at(0) en eski, newest(0) en yeni kayıt.
+// Ekleme sırasında seviye/kaynak zincirleri ve sayaçları güncellenir; filtreli
+// sorgular sadece eşleşen kayıtları dolaşır, sayımlar O(1) okunur.
+class LogRingBuffer {
+public:
+    LogRingBuffer(size_t capacity, size_t arenaSize);
+
+    uint32_t push(uint32_t epoch, uint16_t ms, LogLevel level, uint8_t source, const char* msg, size_t length);
+    // Kayıt RAM'de değilse false; last: son tekrarın metni (kırpılmış)
+    bool addRepeats(uint32_t seq, uint16_t repeats, uint32_t lastEpoch, const char* last, size_t lastLength);
+    void clear();
+
+    size_t size() const { return count; }
+    size_t capacity() const { return recordCapacity; }
+    bool empty() const { return count == 0; }
+    uint32_t lastSeq() const { return nextSeq - 1; }
+
+    const LogRecord& at(size_t index) const { return records[(head + recordCapacity - count + index) % recordCapacity]; }
+    const LogRecord& newest(size_t index) const { return at(count - 1 - index); }
+
+    // Zincir başı / önceki halka - geçersiz (üzerine yazılmış) slot için LOG_NO_SLOT
+    uint16_t newestSlotForLevel(uint8_t level) const;
+    uint16_t newestSlotForSource(uint8_t source) const;
+    uint16_t previousSlot(uint16_t slot, bool byLevel) const;
+    const LogRecord& slotRecord(uint16_t slot) const { return records[slot]; }
+    uint16_t newestSlot() const { return (head + recordCapacity - 1) % recordCapacity; }
+
+    size_t levelCount(uint8_t level) const { return level < LOG_LEVEL_COUNT ? levelCounts[level] : 0; }
+    size_t sourceCount(uint8_t source) const { return source < LOG_MAX_SOURCES ? sourceCounts[source] : 0; }
+
+    // Kalıcı günlüğe yazılmış ve hâlâ RAM'de duran kayıtların sayaçları
+    void markPersisted(uint32_t uptoSeq);
+    size_t persistedCount() const { return persistedTotal; }
+    size_t persistedLevelCount(uint8_t level) const { return level < LOG_LEVEL_COUNT ? persistedLevelCounts[level] : 0; }
+    size_t persistedSourceCount(uint8_t source) const { return source < LOG_MAX_SOURCES ? persistedSourceCounts[source] : 0; }
+
+    const char* messageData(const LogRecord& record) const { return arena + record.msgOffset; }
+    // Katlanan kaydın son tekrar metni; yoksa NULL (kilit altında çağrılır)
+    const char* lastMessageData(const LogRecord& record, size_t& length) const;
+    String messageOf(const LogRecord& record) const;
+    LogEntry entryOf(const LogRecord& record) const;
+    LogEntry entryAt(size_t index) const { return entryOf(at(index)); }
+
+    // Okurlar kayıtları kopyalarken yazıcılarla çakışmamak için kilitler
+    void lock() const;
+    void unlock() const;
+
+private:
+    void dropOldest();
+    void resetIndex();
+    bool reserveArena(size_t length, size_t& offset);
+    bool liveLink(uint16_t slot, uint32_t newerThan) const;
+
+    LogRecord* records;
+    char* arena;
+    size_t recordCapacity;
+    size_t arenaSize;
+    size_t head;           // Bir sonraki yazılacak kayıt slot'u
+    size_t count;
+    size_t arenaHead;      // Arenada bir sonraki yazma konumu
+    uint32_t nextSeq;
+    uint16_t levelHead[LOG_LEVEL_COUNT];
+    uint16_t sourceHead[LOG_MAX_SOURCES];
+    uint16_t levelCounts[LOG_LEVEL_COUNT];
+    uint16_t sourceCounts[LOG_MAX_SOURCES];
+    uint32_t persistedSeq;
+    uint16_t persistedTotal;
+    uint16_t persistedLevelCounts[LOG_LEVEL_COUNT];
+    uint16_t persistedSourceCounts[LOG_MAX_SOURCES];
+
+    // Katlanan kayıtların son tekrar metinleri - kayıt başına değil, açık
+    // tekrar pencereleri kadar yer; en eski girdi dönüşümlü ezilir
+    struct RepeatText {
+        uint32_t seq;      // 0: boş
+        uint8_t length;
+        char text[LOG_REPEAT_LAST_SIZE];
+    };
+    RepeatText repeatTexts[LOG_REPEAT_SLOTS];
+    uint8_t repeatTextNext;
+    mutable SemaphoreHandle_t mutex;
+};
+
+// Kapsam boyunca log tamponunu kilitli tutan yardımcı
+class LogReadLock {
+public:
+    explicit LogReadLock(const LogRingBuffer& buffer) : buf(buffer) { buf.lock(); }
+    ~LogReadLock() { buf.unlock(); }
+private:
+    const LogRingBuffer& buf;
+};
+
+// Log sistemi için değişkenler
+extern LogRingBuffer logStorage;          // Dairesel log depolama
+extern const int MAX_LOG_SIZE;            // Maksimum log sayısı
+extern const int LOG_ARENA_SIZE;          // Mesaj arenası (bayt)
 extern const int PAGE_SIZE;               // Sayfa başına log sayısı (50)
 
 
 void initLogSystem();
-void addLog(const String& msg, LogLevel level, const String& source);
+void addLog(const String& msg, LogLevel level, const String& source);   // Kilitsiz, kuyruğa ekler
+void addLogf(LogLevel level, const char* source, const char* format, ...) __attribute__((format(printf, 3, 4)));
+bool waitForLogSink(uint32_t timeoutMs);      // Kuyruk boşalana kadar bekle (yeniden başlatma öncesi)
+uint32_t getLogRepeatBarrier();               // Tekrar penceresi hâlâ açık en eski kaydın seq'i (yoksa 0)
+
+// Seviye makroları: LOG_DEBUG("UART", "Yanıt: %s", response.c_str())
+#define LOG_DISABLED(...) do {} while (0)
+
+#if LOG_COMPILE_LEVEL >= LOG_RANK_ERROR
+#define LOG_ERROR(source, format, ...) addLogf(ERROR, source, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_DISABLED()
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_RANK_WARN
+#define LOG_WARN(source, format, ...) addLogf(WARN, source, format, ##__VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_DISABLED()
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_RANK_INFO
+#define LOG_INFO(source, format, ...) addLogf(INFO, source, format, ##__VA_ARGS__)
+#define LOG_SUCCESS(source, format, ...) addLogf(SUCCESS, source, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_DISABLED()
+#define LOG_SUCCESS(...) LOG_DISABLED()
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_RANK_DEBUG
+#define LOG_DEBUG(source, format, ...) addLogf(DEBUG, source, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISABLED()
+#endif
 
 String logLevelToString(LogLevel level);
-void clearLogs();
+int logLevelFromString(const String& name);   // Bilinmeyen ad için -1
+bool clearLogs();                             // Sink uygulayana kadar bekler; zaman aşımında false
 String getFormattedTimestamp();
 String getFormattedTimestampFallback();
+const char* getCurrentTimestamp();            // Bu saniyenin metni - beklemez, kopyalanmadan bir saniye geçerli
+void refreshClockCache();                     // Sistem saati ayarlandıktan sonra
+
+// Kaynak adları bir kez tabloya alınır, kayıtlar sadece indeksi taşır
+uint8_t internLogSource(const String& name);
+int findLogSource(const String& name);        // Tabloya eklemeden arar, yoksa -1
+const char* getLogSourceName(uint8_t id);
+int getLogSourceCount();                      // Tablodaki kaynak sayısı (id'ler 0..n-1)
+String formatLogTimestamp(uint32_t epoch);   // Gösterim anında metne çevirir
 
-// Pagination için yeni fonksiyonlar
+// Sorgu ve sayfalama (RAM + kalıcı günlük)
+bool logMatchesQuery(const LogQuery& query, uint8_t level, uint8_t source, const char* message, size_t length);
+// Toplam eşleşme döner; günlük tarama sınırına takılırsa *partial true ve toplam alt sınırdır
+size_t queryLogs(const LogQuery& query, int pageNumber, std::vector<LogEntry>& out, bool* partial = NULL);
+void getLogLevelCounts(size_t counts[LOG_LEVEL_COUNT]);                                 // O(1) seviye sayaçları
 int getTotalLogCount();
 int getTotalPageCount();
-std::vector<LogEntry> getLogsPage(int pageNumber);
-void trimOldLogs();  // Eski logları temizle (MAX_LOG_SIZE'ı aşınca)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef LOG_TAIL_H
+#define LOG_TAIL_H
+
+#include <Arduino.h>
+
+// Artımlı log takibi: GET /api/logs/tail?since=<seq>[&timeout=<ms>]
+// Sadece since'den sonra eklenen kayıtlar döner. Yeni kayıt yoksa ve timeout
+// verilmişse bağlantı park edilir; yeni kayıt gelince veya süre dolunca yanıtlanır.
+#define LOG_TAIL_MAX_WAITERS   4        // Aynı anda bekleyen istek sayısı
+#define LOG_TAIL_MAX_TIMEOUT   25000    // ms - tarayıcı/proxy zaman aşımının altında
+#define LOG_TAIL_MAX_ENTRIES   100      // Daha fazlası için istemci tam sayfa çeker
+
+void handleLogTailAPI();
+void processLogTail();                  // webServerTask döngüsünden çağrılır
+
+#endif // LOG_TAIL_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef LZSS_CODEC_H
+#define LZSS_CODEC_H
+
+#include <Arduino.h>
+
+// Küçük pencereli LZSS akış sıkıştırıcısı (yedek arşivleri için).
+// Çıktı 8 öğelik gruplardır: bir bayrak baytı (bit=1 eşleşme, LSB önce),
+// ardından değişmez bayt veya 2 baytlık eşleşme:
+//   [uzaklık-1 düşük 8 bit] [uzaklık-1 üst 2 bit << 6 | uzunluk-3]
+// Sıkıştırma ~7 KB, açma 1 KB RAM kullanır; girdi boyutundan bağımsızdır.
+#define LZSS_WINDOW_BITS  10
+#define LZSS_WINDOW_SIZE  (1 << LZSS_WINDOW_BITS)      // 1024 bayt geçmiş
+#define LZSS_MIN_MATCH    3
+#define LZSS_MAX_MATCH    (LZSS_MIN_MATCH + 63)        // 66
+#define LZSS_HASH_BITS    9
+#define LZSS_MAX_CHAIN    16                           // Konum başına denenecek aday
+
+class LzssEncoder {
+public:
+    explicit LzssEncoder(Print& out);
+
+    size_t write(const uint8_t* data, size_t length);
+    void finish();                                     // Kalan girdiyi sıkıştır, son grubu yaz
+    uint32_t outputBytes() const { return written; }
+
+private:
+    void compress(size_t limit);
+    void slide();
+    void insertHash(size_t position);
+    void emitLiteral(uint8_t value);
+    void emitMatch(uint16_t offset, uint8_t length);
+    void flushGroup();
+
+    Print& out;
+    uint8_t buffer[2 * LZSS_WINDOW_SIZE];
+    int16_t head[1 << LZSS_HASH_BITS];                 // -1: aday yok
+    int16_t prev[2 * LZSS_WINDOW_SIZE];
+    size_t filled;
+    size_t position;
+    uint8_t group[1 + 8 * 2];
+    uint8_t groupLength;
+    uint8_t groupItems;
+    uint32_t written;
+};
+
+class LzssDecoder {
+public:
+    LzssDecoder(Stream& in, size_t compressedLength);
+
+    int read();                                        // Sonraki ham bayt; akış bittiyse -1
+
+private:
+    int nextInput();
+    uint8_t put(uint8_t value);
+
+    Stream& in;
+    size_t remaining;
+    uint8_t window[LZSS_WINDOW_SIZE];
+    uint16_t windowPos;
+    uint8_t flags;
+    uint8_t flagCount;
+    uint16_t copyFrom;
+    uint8_t copyLeft;
+};
+
+#endif // LZSS_CODEC_H
\ No newline at end of file
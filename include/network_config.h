@@ -21,12 +21,33 @@ struct NetworkConfig {
 // Global değişken extern declaration
 extern NetworkConfig netConfig;
 
+// Canlı ağ değişikliği: yeni statik ayar yeniden başlatmadan ETH.config ile uygulanır,
+// dinleyiciler ve mDNS yeni adresle yeniden açılır. Operatör yeni adresten
+// NETWORK_CONFIRM_TIMEOUT_MS içinde onaylamazsa önceki ayara dönülür; onaylanana
+// kadar yeni ayar kalıcı kaydedilmez. Yalnızca webServerTask içinden kullanılır.
+#define NETWORK_APPLY_DELAY_MS      500      // HTTP yanıtı eski adresten gitsin diye
+#define NETWORK_CONFIRM_TIMEOUT_MS  120000   // 2 dk
+
+struct StaticNetworkConfig {
+    IPAddress ip;
+    IPAddress gateway;
+    IPAddress subnet;
+    IPAddress dns1;
+    IPAddress dns2;
+};
+
 // Fonksiyon tanımlamaları
 void loadNetworkConfig();
 void saveNetworkConfig(bool useDHCP, String ip, String gw, String sn, String d1, String d2);
 void initEthernetAdvanced();
 void setupNetworkEvents();
 void networkReconnectionTask();
+void initMDNS();
+
+bool requestNetworkChange(const StaticNetworkConfig& next);   // false: onay bekleyen değişiklik var
+bool confirmNetworkChange(const IPAddress& via);             // via: isteğin geldiği yerel adres
+void processNetworkChange();                                 // webServerTask döngüsünden çağrılır
+bool getPendingNetworkChange(StaticNetworkConfig& pending, unsigned long& remainingMs);
 
 // Yardımcı fonksiyonlar
 String getNetworkConfigJSON();
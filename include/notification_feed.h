@@ -0,0 +1,30 @@
+#ifndef NOTIFICATION_FEED_H
+#define NOTIFICATION_FEED_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+struct LogEntry;
+
+// Uyarı/hata bildirimleri için ayrı sınırlı halka.
+// Log sink'i ERROR/WARN kayıtlarını geldikçe ekler; istekler log tamponunu taramaz.
+// Her bildirim artan bir id taşır; okundu durumu tek bir "readUpTo" imlecidir,
+// okunmamış sayısı O(1) hesaplanır.
+#define NOTIFICATION_CAPACITY 32
+
+void initNotificationFeed();                     // initLogSystem içinden, sink task'ından önce
+void notificationOnLog(const LogEntry& entry);   // Log sink'inden - burada log yazılmamalı
+void resetNotifications();                       // clearLogs içinden
+
+uint32_t getNotificationLastId();
+uint32_t getUnreadNotificationCount();
+void markNotificationsRead(uint32_t upToId);
+uint32_t getNotificationVersion();               // Ekleme/okuma/temizlemede artar
+
+// since'den yeni bildirimleri en yeniden eskiye yazar (en fazla maxItems)
+void writeNotificationsJSON(JsonDocument& doc, uint32_t since, int maxItems);
+
+void handleNotificationAPI();        // GET  /api/notifications?since=<id>
+void handleNotificationReadAPI();    // POST /api/notifications/read (upTo=<id>, yoksa hepsi)
+
+#endif // NOTIFICATION_FEED_H
\ No newline at end of file
@@ -36,9 +36,6 @@ String formatTime(const String& timeStr);
 void parseTimeData(const String& data);
 void readBackendData();
 bool isTimeDataValid();
-String getCurrentDateTime();
-String getCurrentDate();
-String getCurrentTime();
 bool isValidIPOrDomain(const String& address);
 bool isNTPSynced();
 void resetNTPSettings();
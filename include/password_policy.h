@@ -19,7 +19,6 @@ struct PasswordPolicy {
 extern PasswordPolicy passwordPolicy;
 
 // Function declarations
-void loadPasswordPolicy();
 void savePasswordPolicy();
 bool isPasswordComplex(const String& password);
 bool isPasswordInHistory(const String& password);
@@ -0,0 +1,51 @@
+#ifndef ROUTE_METRICS_H
+#define ROUTE_METRICS_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+// Route bazlı ölçümler: istek sayısı, durum kodları, gecikme histogramı,
+// yanıt boyutu ve UART bekleme süresi. /metrics üzerinden Prometheus
+// metin formatında sunulur. Cihaz/istasyon adı ve trafik bilgisi içerdiği için
+// diğer veri API'leri gibi oturum ister: toplayıcı bir oturum token'ını
+// "Authorization: Bearer <token>" başlığıyla gönderir (Prometheus'ta
+// authorization.credentials_file). Düzenli toplama oturumu canlı tutar;
+// yeniden başlatma veya çıkıştan sonra token yenilenmelidir.
+
+// WebServer'ın send/sendContent/streamFile/on çağrılarını gölgeleyerek
+// durum kodunu ve yanıt boyutunu yakalar; on() ile kaydedilen her handler
+// otomatik olarak ölçülür. Dahili çağrılar temel sınıfa gider, çift sayım olmaz.
+class MeteredWebServer : public WebServer {
+public:
+    using WebServer::WebServer;
+
+    void on(const String& path, THandlerFunction handler);
+    void on(const String& path, HTTPMethod method, THandlerFunction handler);
+    void on(const String& path, HTTPMethod method, THandlerFunction handler, THandlerFunction uploadHandler);
+    void onNotFound(THandlerFunction handler);
+
+    void send(int code, const char* contentType = NULL, const String& content = String());
+    void send(int code, const String& contentType, const String& content);
+    void send(int code, const char* contentType, const char* content);
+    void sendContent(const String& content);
+    void sendContent(const char* content, size_t length);
+
+    template<typename T>
+    size_t streamFile(T& file, const String& contentType, int code = 200) {
+        size_t sent = WebServer::streamFile(file, contentType, code);
+        recordResponse(code, sent);
+        return sent;
+    }
+
+private:
+    void recordResponse(int code, size_t bytes);
+};
+
+int registerRouteMetrics(const String& path, HTTPMethod method);
+void beginRouteRequest(int routeId);
+void endRouteRequest();
+void addRouteUartTime(unsigned long micros);   // UART kilidi bırakılırken çağrılır
+
+void handleMetricsAPI();                       // GET /metrics
+
+#endif // ROUTE_METRICS_H
\ No newline at end of file
@@ -3,8 +3,16 @@
 
 #include <Arduino.h>
 #include <WebServer.h>
+#include "route_metrics.h"
 #include <ETH.h>
 
+// Ad uzunluk sınırları (bayt, UTF-8). Ayar kaydındaki alanlar bunlardan büyüktür;
+// sınırı aşan değer kırpılmaz, kaydetme/geri yükleme reddedilir.
+#define DEVICE_NAME_MAX_LENGTH 50
+#define TM_NAME_MAX_LENGTH     50
+#define USERNAME_MIN_LENGTH    3
+#define USERNAME_MAX_LENGTH    30
+
 struct Settings {
     IPAddress local_IP;
     IPAddress gateway;
@@ -18,14 +26,11 @@ struct Settings {
     String passwordHash;
     long currentBaudRate;
     
-    // isLoggedIn yerine bu alanı kullanacağız
-    String sessionToken; 
-    unsigned long sessionStartTime;
-    bool isAdminSession;  // YÖNETİCİ OTURUMU İŞARETİ
+    // Oturumlar auth_system'deki tabloda; burada sadece hareketsizlik süresi
     unsigned long SESSION_TIMEOUT;
 };
 
-extern WebServer server;
+extern MeteredWebServer server;
 extern Settings settings;
 
 void loadSettings();
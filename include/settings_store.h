@@ -0,0 +1,39 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+
+// Kalıcı ayarların tek kaydı: ağ, cihaz, hesap, parola politikası, NTP ve
+// PBKDF2 tur sayısı NVS'te tek, sürümlü ve CRC korumalı blob olarak tutulur.
+// RAM önbelleği settings, passwordPolicy ve ntpConfig global'leridir; okumalar
+// her zaman bunlardan yapılır. Değişiklikten sonra saveSettingsStore() çağrılır;
+// art arda gelen kayıtlar birleştirilip uartTask'ta tek flash yazımı yapılır.
+#define SETTINGS_STORE_NAMESPACE    "cfg-store"
+#define SETTINGS_STORE_VERSION      1
+#define SETTINGS_WRITE_DELAY_MS     1500     // Son değişiklikten sonra sessizlik süresi
+#define SETTINGS_WRITE_MAX_DELAY_MS 10000    // İlk değişiklikten sonra en geç yazım
+#define SETTINGS_WRITE_RETRY_MS     5000     // Başarısız yazımdan sonra yeniden deneme aralığı
+
+struct SettingsStoreStats {
+    uint32_t saves;          // saveSettingsStore çağrıları
+    uint32_t writes;         // Gerçek flash yazımları
+    uint32_t skipped;        // İçerik değişmediği için atlanan yazımlar
+    uint32_t failures;       // Başarısız flash yazımları (kayıt kirli kalır)
+    bool dirty;              // Bekleyen yazım var mı
+    bool migrated;           // Bu açılışta eski namespace'lerden taşındı mı
+    bool corrupt;            // Bu açılışta kayıt bozuk bulundu, varsayılanlarla açıldı
+};
+
+void initSettingsStore();            // LittleFS'ten sonra, initPasswordHashing/loadSettings'ten önce
+void saveSettingsStore();            // Global'lerin anlık görüntüsünü al, yazımı ertele
+void processSettingsStore();         // uartTask döngüsünden çağrılır
+void flushSettingsStore();           // Bekleyen yazımı hemen yap (yeniden başlatma öncesi)
+SettingsStoreStats getSettingsStoreStats();
+
+// Son kaydedilen cihaz/TM adı - global String'lere dokunmadan, herhangi bir task'tan
+void getStoredDeviceNames(String& deviceName, String& transformerStation);
+
+uint32_t getStoredHashIterations();  // 0: henüz ölçülmedi
+void setStoredHashIterations(uint32_t iterations);
+
+#endif // SETTINGS_STORE_H
\ No newline at end of file
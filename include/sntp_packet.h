@@ -0,0 +1,41 @@
+#ifndef SNTP_PACKET_H
+#define SNTP_PACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// SNTP paket biçimi (RFC 4330) - soket ve saat kaynağından bağımsız saf
+// işlevler. Arduino başlığı kullanmaz; [env:native] altında test edilir.
+#define NTP_PACKET_SIZE    48
+#define NTP_UNIX_OFFSET    2208988800UL   // 1900 -> 1970 saniye farkı
+#define NTP_MODE_CLIENT    3
+#define NTP_MODE_SERVER    4
+#define NTP_LI_NONE        0
+#define NTP_LI_ALARM       3              // Saat senkron değil
+#define NTP_STRATUM_UNSYNC 16
+#define NTP_PRECISION      -20            // ~1 µs (gettimeofday çözünürlüğü)
+
+// Yanıt başlığı alanları
+struct SNTPHeader {
+    bool synced;
+    uint8_t stratum;
+    uint32_t rootDispersion;   // NTP kısa biçim (16.16 saniye)
+    uint32_t referenceId;
+    uint32_t referenceSec;
+    uint32_t referenceFrac;
+};
+
+// Yerel saat (saniye + µs) -> NTP zaman damgası (UTC, 32.32)
+void sntpTimestamp(int64_t localSec, uint32_t usec, int32_t timezoneHours, uint32_t& sec, uint32_t& frac);
+
+// Yanıtlanacak istek mi: en az 48 bayt, istemci modu (3), NTPv1-4
+bool sntpIsClientRequest(const uint8_t* packet, size_t length);
+
+// İsteği yerinde yanıta çevirir; alma zamanı yazılır, gönderme zamanı sntpSetTransmit ile
+void sntpBuildResponse(uint8_t* packet, const SNTPHeader& header, uint32_t receiveSec, uint32_t receiveFrac);
+void sntpSetTransmit(uint8_t* packet, uint32_t sec, uint32_t frac);
+
+uint32_t sntpReadU32(const uint8_t* p);
+void sntpWriteU32(uint8_t* p, uint32_t value);
+
+#endif // SNTP_PACKET_H
\ No newline at end of file
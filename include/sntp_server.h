@@ -0,0 +1,27 @@
+#ifndef SNTP_SERVER_H
+#define SNTP_SERVER_H
+
+#include <Arduino.h>
+
+// LAN cihazları için SNTP sunucusu (UDP 123, RFC 4330).
+// Yanıtlar dsPIC'e disipline edilmiş ESP32 saatinden verilir. Alma zamanı
+// paket soketten alınır alınmaz, gönderme zamanı sendto'dan hemen önce
+// okunur. Kendi görevinde çalışır; HTTP ve UART görevlerine dokunmaz.
+#define SNTP_PORT                 123
+#define SNTP_TASK_PRIORITY        2        // Web göreviyle eşit: sel halinde HTTP'yi aç bırakmaz
+#define SNTP_MAX_REQUESTS_PER_SEC 1000     // Fazlası yanıtlanmadan düşürülür
+#define SNTP_STRATUM_SYNCED       3        // NTP sunucusu -> dsPIC -> ESP32
+#define SNTP_SYNC_MAX_AGE         7200000  // ms - son DN ölçümü bundan eskiyse senkron sayılmaz
+
+struct SNTPStats {
+    bool running;
+    bool synced;             // Şu an senkron yanıt veriliyor mu
+    uint8_t stratum;
+    uint32_t requests;       // Yanıtlanan istek
+    uint32_t dropped;        // Hız sınırı veya geçersiz paket
+};
+
+void initSNTPServer();                   // Ethernet başlatıldıktan sonra
+SNTPStats getSNTPStats();
+
+#endif // SNTP_SERVER_H
\ No newline at end of file
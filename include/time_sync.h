@@ -2,11 +2,11 @@
 #define TIME_SYNC_H
 
 #include <Arduino.h>
+#include "civil_time.h"
 
 // Zaman verilerini saklamak için yapı
 struct TimeData {
-    String lastDate;   // "2025-02-22"
-    String lastTime;   // "11:22:33"
+    CivilTime lastReading = {0, 0};   // Son başarılı DN yanıtı
     unsigned long lastSync = 0;
     unsigned int syncCount = 0;
     unsigned int failCount = 0;
@@ -18,9 +18,6 @@ extern TimeData timeData;
 
 // Fonksiyonlar
 bool requestTimeFromDsPIC();
-void updateSystemTime();
-String getCurrentDate();
-String getCurrentDateTime();
 bool isTimeSynced();
 void checkTimeSync();
 void initTimeSync(); // YENİ FONKSİYON
@@ -47,6 +47,8 @@ bool requestLastNFaults(int count, std::vector<String>& faultData); // Son N ar
 
 // Genel komut gönderme
 bool sendCustomCommand(const String& command, String& response, unsigned long timeout = 0);
+// Gönderimin bittiği ve yanıtın alındığı anlar (esp_timer µs) - saat disiplini için
+bool sendTimedCommand(const String& command, String& response, unsigned long timeout, int64_t& sentUs, int64_t& receivedUs);
 bool sendTestCommand(const String& testCmd);
 bool sendToSecondCard(const String& data);
 void initUART3();
@@ -56,6 +58,10 @@ bool requestNTPFromDsPIC(String& ntp1, String& ntp2);
 // NTP ayarlarını sadece ikinci karta gönder (UART3)
 bool sendNTPToSecondCardOnly(const String& ntp1, const String& ntp2);
 
+// UART hattı kilidi - farklı task'lardan gelen komut/yanıt çiftlerinin karışmaması için
+bool lockUART(unsigned long timeoutMs = 5000);
+void unlockUART();
+
 // Yardımcı fonksiyonlar
 void clearUARTBuffer();
 String safeReadUARTResponse(unsigned long timeout);
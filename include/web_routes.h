@@ -4,6 +4,30 @@
 #define WEB_ROUTES_H
 
 #include <Arduino.h>
+#include <WebServer.h>
+#include <ArduinoJson.h>
+#include "data_version.h"
+#include "log_system.h"
+
+// Route tablosu tanımları
+enum RouteAuth {
+    ROUTE_PUBLIC = 0,     // Oturum gerekmez (veya handler kendi kontrol eder)
+    ROUTE_SESSION = 1     // Geçerli oturum jetonu gerekli
+};
+
+enum RouteRate {
+    RATE_NONE = 0,
+    RATE_LIMITED = 1      // checkRateLimit() uygulanır
+};
+
+struct RouteDef {
+    const char* path;
+    HTTPMethod method;
+    RouteAuth auth;
+    RouteRate rate;
+    void (*handler)();
+    void (*uploadHandler)();  // Sadece dosya yükleme route'ları için
+};
 
 void setupWebRoutes();
 void serveStaticFile(const String& path, const String& contentType);
@@ -11,6 +35,25 @@ String getUptime();
 void addSecurityHeaders();
 bool checkRateLimit();
 
+// İstek bittikten sonra açık tutulan (SSE, uzun bekleme) soketlere yazım.
+// Engellemez: verinin tamamı gönderim tamponuna sığmazsa false döner ve
+// çağıran istemciyi düşürür; takılmış istemci web task'ını durduramaz.
+bool writeClientNonBlocking(WiFiClient& client, const char* data, size_t length);
+
+// Koşullu GET (ETag / If-None-Match)
+bool clientHasCurrentVersion(DataDomain domain);
+void sendNotModified(DataDomain domain);
+bool handleConditionalGet(DataDomain domain);
+
+// Ortak JSON üreticileri (API ve push kanalı)
+String buildStatusJSON();
+bool buildLedStatusJSON(JsonDocument& doc, bool success, const String& ledResponse);
+
+// Log API'lerinin ortak parçaları (/api/logs ve /api/logs/tail)
+LogQuery parseLogQueryArgs();                            // level/source/search parametreleri
+void addLogEntryJSON(JsonArray& logs, const LogEntry& log);
+void addLogStatsJSON(JsonDocument& doc);                 // İndeks sayaçlarından seviye istatistikleri
+
 // API Handler fonksiyonları
 void handleStatusAPI();
 void handleGetSettingsAPI();
@@ -38,15 +81,15 @@ void handleClearLogsAPI();
 void handleSystemInfoAPI();
 void handleSessionRefresh();
 void handleUARTTestAPI();
+void handleUARTSendAPI();
 void handleDeviceInfoAPI();
 void handleSystemRebootAPI();
+void handleHashBenchmarkAPI();
 
 // Network API'leri
 void handleGetNetworkAPI();
 void handlePostNetworkAPI();
-
-// Notification API
-void handleNotificationAPI();
+void handleConfirmNetworkAPI();
 
 // DateTime API handlers
 void handleGetDateTimeAPI();
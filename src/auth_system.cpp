@@ -3,53 +3,232 @@
 #include "log_system.h"
 #include "crypto_utils.h"
 #include "password_policy.h"
+#include "client_limiter.h"
 #include <WebServer.h>
 #include <ArduinoJson.h>
+#include "settings_store.h"
 
 extern Settings settings;
-extern WebServer server;
+extern MeteredWebServer server;
 extern PasswordPolicy passwordPolicy;
 
-static int loginAttempts = 0;
-static unsigned long lockoutTime = 0;
-const int MAX_LOGIN_ATTEMPTS = 5;
-const unsigned long LOCKOUT_DURATION = 300000; // 5 dakika
 
 // Yönetici bilgileri (sabit tanımlı)
 const String ADMIN_USERNAME = "eklim";
 const String ADMIN_PASSWORD = "mdhc06*";
 
-// Oturumu jeton ile kontrol et
-bool checkSession() {
-    String token = "";
+struct SessionSlot {
+    uint8_t token[SESSION_TOKEN_BYTES];
+    bool used;
+    uint8_t role;              // SessionRole
+    IPAddress clientIP;
+    unsigned long expiresAt;   // millis - aktivite oldukça ileri alınır
+};
+static SessionSlot sessionTable[SESSION_TABLE_SIZE];
+static int sessionCount = 0;
+
+// Route dispatch sırasında geçerli isteğin oturum bilgisi
+struct RequestSession {
+    bool active;    // Dispatch içindeyiz
+    bool checked;   // Oturum bu istek için doğrulandı mı
+    bool valid;
+    uint8_t role;
+    String token;
+};
+static RequestSession requestSession = { false, false, false, ROLE_USER, "" };
+
+// "Bearer a1b2c3d4..." formatındaki Authorization başlığından jetonu çıkar
+static String parseBearerToken() {
     if (server.hasHeader("Authorization")) {
-        // "Bearer a1b2c3d4..." formatını bekliyoruz
         String authHeader = server.header("Authorization");
         if (authHeader.startsWith("Bearer ")) {
-            token = authHeader.substring(7);
+            return authHeader.substring(7);
+        }
+    }
+    return "";
+}
+
+void beginRequestSession() {
+    requestSession.active = true;
+    requestSession.checked = false;
+    requestSession.valid = false;
+    requestSession.role = ROLE_USER;
+    requestSession.token = parseBearerToken();
+}
+
+void endRequestSession() {
+    requestSession.active = false;
+    requestSession.checked = false;
+    requestSession.token = "";
+}
+
+const String& getRequestToken() {
+    return requestSession.token;
+}
+
+static bool sessionExpired(const SessionSlot& slot, unsigned long now) {
+    return (long)(now - slot.expiresAt) >= 0;
+}
+
+// Jeton rastgele olduğu için ilk 4 baytı doğrudan karma değeri olarak kullanılabilir
+static int homeSlot(const uint8_t* token) {
+    uint32_t hash = ((uint32_t)token[0] << 24) | ((uint32_t)token[1] << 16) | ((uint32_t)token[2] << 8) | token[3];
+    return hash & (SESSION_TABLE_SIZE - 1);
+}
+
+// Sabit süreli karşılaştırma - eşleşen bayt sayısı zamanlamadan çıkarılamaz
+static bool tokensEqual(const uint8_t* a, const uint8_t* b) {
+    uint8_t diff = 0;
+    for (int i = 0; i < SESSION_TOKEN_BYTES; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+static bool decodeToken(const String& text, uint8_t* out) {
+    if (text.length() != SESSION_TOKEN_BYTES * 2) return false;
+    for (int i = 0; i < SESSION_TOKEN_BYTES * 2; i++) {
+        char c = text.charAt(i);
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+        else return false;
+        out[i / 2] = (i % 2 == 0) ? (nibble << 4) : (out[i / 2] | nibble);
+    }
+    return true;
+}
+
+static String encodeToken(const uint8_t* token) {
+    char hex[SESSION_TOKEN_BYTES * 2 + 1];
+    for (int i = 0; i < SESSION_TOKEN_BYTES; i++) {
+        sprintf(hex + i * 2, "%02x", token[i]);
+    }
+    return String(hex);
+}
+
+// Slotu boşalt ve arkasındaki yoklama zincirini geri kaydır (mezar taşı bırakmaz)
+static void removeSlot(int index) {
+    sessionTable[index].used = false;
+    sessionCount--;
+
+    int hole = index;
+    int next = (index + 1) & (SESSION_TABLE_SIZE - 1);
+    while (sessionTable[next].used) {
+        int home = homeSlot(sessionTable[next].token);
+        // home, (hole, next] aralığında değilse kayıt deliğe taşınabilir
+        bool stays = (hole < next) ? (home > hole && home <= next) : (home > hole || home <= next);
+        if (!stays) {
+            sessionTable[hole] = sessionTable[next];
+            sessionTable[next].used = false;
+            hole = next;
+        }
+        next = (next + 1) & (SESSION_TABLE_SIZE - 1);
+    }
+}
+
+static void purgeExpiredSessions() {
+    unsigned long now = millis();
+    for (int i = 0; i < SESSION_TABLE_SIZE; i++) {
+        // Geri kaydırma aynı slota yeni bir kayıt getirebilir
+        while (sessionTable[i].used && sessionExpired(sessionTable[i], now)) {
+            removeSlot(i);
+        }
+    }
+}
+
+// Jetonun slotu; süresi dolmuşsa burada silinir
+static int findSession(const String& tokenText) {
+    uint8_t token[SESSION_TOKEN_BYTES];
+    if (sessionCount == 0 || !decodeToken(tokenText, token)) return -1;
+
+    int index = homeSlot(token);
+    for (int probe = 0; probe < SESSION_TABLE_SIZE && sessionTable[index].used; probe++) {
+        if (tokensEqual(sessionTable[index].token, token)) {
+            if (sessionExpired(sessionTable[index], millis())) {
+                removeSlot(index);
+                addLog("Oturum zaman aşımına uğradı", INFO, "AUTH");
+                return -1;
+            }
+            return index;
         }
+        index = (index + 1) & (SESSION_TABLE_SIZE - 1);
     }
+    return -1;
+}
 
-    if (token.length() == 0 || settings.sessionToken.length() == 0 || token != settings.sessionToken) {
-        return false;
+// Yeni oturum aç ve jetonu döndür. Tablo doluysa önce süresi dolanlar,
+// yine yer yoksa bitişine en az kalan oturum çıkarılır.
+static String createSession(SessionRole role) {
+    if (sessionCount >= MAX_SESSIONS) purgeExpiredSessions();
+    if (sessionCount >= MAX_SESSIONS) {
+        int oldest = -1;
+        for (int i = 0; i < SESSION_TABLE_SIZE; i++) {
+            if (sessionTable[i].used && (oldest < 0 || (long)(sessionTable[i].expiresAt - sessionTable[oldest].expiresAt) < 0)) {
+                oldest = i;
+            }
+        }
+        addLog("⚠️ Oturum tablosu dolu, en eski oturum kapatıldı: " + sessionTable[oldest].clientIP.toString(), WARN, "AUTH");
+        removeSlot(oldest);
     }
 
-    if (millis() - settings.sessionStartTime > settings.SESSION_TIMEOUT) {
-        settings.sessionToken = ""; // Jetonu geçersiz kıl
-        addLog("Oturum zaman aşımına uğradı", INFO, "AUTH");
-        return false;
+    uint8_t token[SESSION_TOKEN_BYTES];
+    esp_fill_random(token, sizeof(token));
+
+    int index = homeSlot(token);
+    while (sessionTable[index].used) {
+        index = (index + 1) & (SESSION_TABLE_SIZE - 1);
     }
-    
+
+    SessionSlot& slot = sessionTable[index];
+    memcpy(slot.token, token, sizeof(token));
+    slot.used = true;
+    slot.role = role;
+    slot.clientIP = server.client().remoteIP();
+    slot.expiresAt = millis() + settings.SESSION_TIMEOUT;
+    sessionCount++;
+
+    return encodeToken(token);
+}
+
+// Jetonu doğrula ve aktivite varsa oturum süresini yenile
+static bool validateSession(const String& token) {
+    int index = findSession(token);
+    if (index < 0) return false;
+
     // Aktivite olduğunda oturum süresini yenile
-    settings.sessionStartTime = millis();
+    sessionTable[index].expiresAt = millis() + settings.SESSION_TIMEOUT;
+    requestSession.role = sessionTable[index].role;
     return true;
 }
 
+// Oturumu jeton ile kontrol et - dispatch içinde istek başına bir kez doğrulanır
+bool checkSession() {
+    if (!requestSession.active) {
+        return validateSession(parseBearerToken());
+    }
+    if (!requestSession.checked) {
+        requestSession.valid = validateSession(requestSession.token);
+        requestSession.checked = true;
+    }
+    return requestSession.valid;
+}
+
+static void upgradePasswordHash(const String& password) {
+    String upgraded = hashPassword(password, settings.passwordSalt);
+    if (upgraded.length() == 0) return;
+
+    settings.passwordHash = upgraded;
+    saveSettingsStore();
+    LOG_INFO("AUTH", "🔐 Parola özeti PBKDF2'ye yükseltildi (%lu tur)", (unsigned long)getPasswordHashIterations());
+}
+
 void handleUserLogin() {
-    // Rate limiting kontrolü
-    if (lockoutTime > 0 && millis() < lockoutTime) {
-        unsigned long remainingTime = (lockoutTime - millis()) / 1000;
-        addLog("Çok fazla başarısız giriş denemesi. Kalan süre: " + String(remainingTime) + "s", WARN, "AUTH");
+    // İstemci bazlı kilit - diğer istemciler etkilenmez
+    IPAddress clientIP = server.client().remoteIP();
+    unsigned long lockRemaining = clientLoginLockRemaining(clientIP);
+    if (lockRemaining > 0) {
+        unsigned long remainingTime = (lockRemaining + 999) / 1000;
+        addLog("Çok fazla başarısız giriş denemesi (" + clientIP.toString() + "). Kalan süre: " + String(remainingTime) + "s", WARN, "AUTH");
         server.send(429, "application/json", 
             "{\"error\":\"Çok fazla başarısız deneme. " + String(remainingTime) + " saniye sonra tekrar deneyin.\"}");
         return;
@@ -74,18 +253,15 @@ void handleUserLogin() {
     // YÖNETİCİ GİRİŞİ KONTROLÜ
     if (u == ADMIN_USERNAME && p == ADMIN_PASSWORD) {
         // Yönetici girişi başarılı
-        settings.sessionToken = generateRandomToken(32);
-        settings.sessionStartTime = millis();
-        settings.isAdminSession = true; // Yönetici oturumu işareti
-        loginAttempts = 0;
-        lockoutTime = 0;
+        String token = createSession(ROLE_ADMIN);
+        clientLoginSucceeded(clientIP);
         
         addLog("✅ YÖNETİCİ girişi başarılı: " + u, SUCCESS, "AUTH");
         
         // Yönetici için şifre değiştirme zorunluluğu YOK
         String response = "{";
         response += "\"success\":true,";
-        response += "\"token\":\"" + settings.sessionToken + "\",";
+        response += "\"token\":\"" + token + "\",";
         response += "\"mustChangePassword\":false,"; // Her zaman false
         response += "\"isAdmin\":true,"; // Yönetici işareti
         response += "\"redirectUrl\":\"/\"";
@@ -97,13 +273,13 @@ void handleUserLogin() {
 
     // NORMAL KULLANICI GİRİŞİ KONTROLÜ
     if (u == settings.username) {
-        String hashedAttempt = sha256(p, settings.passwordSalt);
-        if (hashedAttempt == settings.passwordHash) {
-            settings.sessionToken = generateRandomToken(32);
-            settings.sessionStartTime = millis();
-            settings.isAdminSession = false; // Normal kullanıcı oturumu
-            loginAttempts = 0;
-            lockoutTime = 0;
+        if (verifyPassword(p, settings.passwordSalt, settings.passwordHash)) {
+            // Eski (tek tur SHA-256) veya daha az turlu özet: parola elimizdeyken yükselt
+            if (passwordHashNeedsUpgrade(settings.passwordHash)) {
+                upgradePasswordHash(p);
+            }
+            String token = createSession(ROLE_USER);
+            clientLoginSucceeded(clientIP);
             
             addLog("✅ Başarılı giriş: " + u, SUCCESS, "AUTH");
             
@@ -115,7 +291,7 @@ void handleUserLogin() {
             // JSON response
             String response = "{";
             response += "\"success\":true,";
-            response += "\"token\":\"" + settings.sessionToken + "\",";
+            response += "\"token\":\"" + token + "\",";
             response += "\"mustChangePassword\":" + String(mustChange ? "true" : "false");
             response += ",\"isAdmin\":false"; // Normal kullanıcı
             
@@ -140,45 +316,49 @@ void handleUserLogin() {
         }
     }
 
-    // Başarısız giriş işlemi
-    loginAttempts++;
-    addLog("❌ Başarısız giriş denemesi (#" + String(loginAttempts) + "): " + u, ERROR, "AUTH");
+    // Başarısız giriş işlemi - hak bu istemcinin kovasından düşer
+    bool locked = clientLoginFailed(clientIP);
+    addLog("❌ Başarısız giriş denemesi (" + clientIP.toString() + ", kalan hak " + String(clientLoginAttemptsLeft(clientIP)) + "): " + u, ERROR, "AUTH");
 
-    // Maksimum deneme sayısına ulaşıldı mı?
-    if (loginAttempts >= MAX_LOGIN_ATTEMPTS) {
-        lockoutTime = millis() + LOCKOUT_DURATION;
-        addLog("🔒 IP adresi " + String(LOCKOUT_DURATION/1000) + " saniye kilitlendi", WARN, "AUTH");
+    // Haklar bitti mi?
+    if (locked) {
+        addLog("🔒 IP adresi " + clientIP.toString() + " " + String(LOGIN_LOCKOUT_MS/1000) + " saniye kilitlendi", WARN, "AUTH");
         server.send(429, "application/json", 
-            "{\"error\":\"Çok fazla başarısız deneme. " + String(LOCKOUT_DURATION/1000) + " saniye sonra tekrar deneyin.\"}");
+            "{\"error\":\"Çok fazla başarısız deneme. " + String(LOGIN_LOCKOUT_MS/1000) + " saniye sonra tekrar deneyin.\"}");
         return;
     }
 
     server.send(401, "application/json", "{\"success\":false, \"error\":\"Kullanıcı adı veya şifre hatalı!\"}");
 }
 
+// Sadece isteği yapan oturum kapanır; diğer operatörler etkilenmez
 void handleUserLogout() {
-    settings.sessionToken = "";
-    settings.isAdminSession = false; // Yönetici oturumunu temizle
+    int index = findSession(getRequestToken());
+    if (index >= 0) removeSlot(index);
     addLog("🚪 Çıkış yapıldı", INFO, "AUTH");
     server.send(200, "application/json", "{\"success\":true}");
 }
 
-// Sadece gelen jetonun geçerli olup olmadığını kontrol eder (WebSocket için)
+// Sadece gelen jetonun geçerli olup olmadığını kontrol eder (SSE için)
 bool isTokenValid(const String& token) {
-    if (token.length() == 0 || settings.sessionToken.length() == 0 || token != settings.sessionToken) {
-        return false;
-    }
-
-    if (millis() - settings.sessionStartTime > settings.SESSION_TIMEOUT) {
-        return false;
-    }
-
-    // WebSocket aktivitesi için oturum süresini yenilemeyelim,
+    // SSE aktivitesi için oturum süresini yenilemeyelim,
     // bu sadece API isteklerinde olmalı.
-    return true;
+    return findSession(token) >= 0;
 }
 
 // Yönetici oturumu kontrolü
 bool isAdminSession() {
-    return settings.isAdminSession;
+    return checkSession() && requestSession.role == ROLE_ADMIN;
+}
+
+void endAllSessions() {
+    for (int i = 0; i < SESSION_TABLE_SIZE; i++) {
+        sessionTable[i].used = false;
+    }
+    sessionCount = 0;
+}
+
+int getActiveSessionCount() {
+    purgeExpiredSessions();
+    return sessionCount;
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+// backup_archive.cpp - Sıkıştırılmış ve özetli yedek arşivi
+#include "backup_archive.h"
+
+static const uint8_t archiveMagic[4] = { 'T', 'B', 'K', '2' };
+static const uint8_t trailerMagic[4] = { 'T', 'B', 'K', 'E' };
+
+static void putLE32(uint8_t* p, uint32_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+static uint32_t getLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static size_t bodyLength(File& file) {
+    size_t size = file.size();
+    return size > BACKUP_HEADER_SIZE + BACKUP_TRAILER_SIZE ? size - BACKUP_HEADER_SIZE - BACKUP_TRAILER_SIZE : 0;
+}
+
+BackupArchiveWriter::BackupArchiveWriter(Print& out, uint8_t flags)
+    : out(out), encoder(out), rawLength(0), inSettings(false) {
+    mbedtls_sha256_init(&contentHash);
+    mbedtls_sha256_init(&configHash);
+    mbedtls_sha256_starts(&contentHash, 0);
+    mbedtls_sha256_starts(&configHash, 0);
+
+    uint8_t header[BACKUP_HEADER_SIZE] = { 0 };
+    memcpy(header, archiveMagic, sizeof(archiveMagic));
+    header[4] = BACKUP_ARCHIVE_VERSION;
+    header[5] = flags;
+    out.write(header, sizeof(header));
+}
+
+BackupArchiveWriter::~BackupArchiveWriter() {
+    mbedtls_sha256_free(&contentHash);
+    mbedtls_sha256_free(&configHash);
+}
+
+void BackupArchiveWriter::writeRaw(const uint8_t* data, size_t length) {
+    mbedtls_sha256_update(&contentHash, data, length);
+    encoder.write(data, length);
+    rawLength += length;
+}
+
+void BackupArchiveWriter::beginSection(uint8_t type, uint32_t length) {
+    uint8_t header[5];
+    header[0] = type;
+    putLE32(header + 1, length);
+    writeRaw(header, sizeof(header));
+    inSettings = type == BACKUP_SECTION_SETTINGS;
+}
+
+void BackupArchiveWriter::write(const uint8_t* data, size_t length) {
+    if (inSettings) mbedtls_sha256_update(&configHash, data, length);
+    writeRaw(data, length);
+}
+
+void BackupArchiveWriter::writeSection(uint8_t type, const String& data) {
+    beginSection(type, data.length());
+    write((const uint8_t*)data.c_str(), data.length());
+}
+
+void BackupArchiveWriter::finish(BackupTrailer& trailer) {
+    encoder.finish();
+    trailer.rawLength = rawLength;
+    mbedtls_sha256_finish(&configHash, trailer.configDigest);
+    mbedtls_sha256_finish(&contentHash, trailer.contentDigest);
+
+    uint8_t tail[BACKUP_TRAILER_SIZE];
+    memcpy(tail, trailerMagic, sizeof(trailerMagic));
+    putLE32(tail + 4, trailer.rawLength);
+    memcpy(tail + 8, trailer.configDigest, BACKUP_DIGEST_SIZE);
+    memcpy(tail + 8 + BACKUP_DIGEST_SIZE, trailer.contentDigest, BACKUP_DIGEST_SIZE);
+    out.write(tail, sizeof(tail));
+}
+
+bool isBackupArchive(File& file) {
+    size_t position = file.position();
+    uint8_t magic[sizeof(archiveMagic)];
+    file.seek(0);
+    bool result = file.read(magic, sizeof(magic)) == sizeof(magic) && memcmp(magic, archiveMagic, sizeof(magic)) == 0;
+    file.seek(position);
+    return result;
+}
+
+bool readBackupTrailer(File& file, BackupTrailer& trailer) {
+    if (file.size() < BACKUP_HEADER_SIZE + BACKUP_TRAILER_SIZE) return false;
+
+    uint8_t tail[BACKUP_TRAILER_SIZE];
+    file.seek(file.size() - BACKUP_TRAILER_SIZE);
+    if (file.read(tail, sizeof(tail)) != sizeof(tail)) return false;
+    if (memcmp(tail, trailerMagic, sizeof(trailerMagic)) != 0) return false;
+
+    trailer.rawLength = getLE32(tail + 4);
+    memcpy(trailer.configDigest, tail + 8, BACKUP_DIGEST_SIZE);
+    memcpy(trailer.contentDigest, tail + 8 + BACKUP_DIGEST_SIZE, BACKUP_DIGEST_SIZE);
+    return true;
+}
+
+void backupDigest(const String& data, uint8_t* digest) {
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, (const unsigned char*)data.c_str(), data.length());
+    mbedtls_sha256_finish(&ctx, digest);
+    mbedtls_sha256_free(&ctx);
+}
+
+BackupArchiveReader::BackupArchiveReader(File& file)
+    : decoder(file, bodyLength(file)), headerValid(false), archiveFlags(0),
+      rawCount(0), sectionLeft(0), peeked(-1), hashFill(0) {
+    mbedtls_sha256_init(&contentHash);
+    mbedtls_sha256_starts(&contentHash, 0);
+    setTimeout(0);   // Bölüm sonunda read() -1 döner; readBytes beklemesin
+
+    uint8_t header[BACKUP_HEADER_SIZE];
+    if (!readBackupTrailer(file, archiveTrailer)) return;
+    file.seek(0);
+    if (file.read(header, sizeof(header)) != sizeof(header)) return;
+    if (memcmp(header, archiveMagic, sizeof(archiveMagic)) != 0 || header[4] != BACKUP_ARCHIVE_VERSION) return;
+
+    archiveFlags = header[5];
+    headerValid = true;
+}
+
+BackupArchiveReader::~BackupArchiveReader() {
+    mbedtls_sha256_free(&contentHash);
+}
+
+// Özet, donanım SHA çağrılarını azaltmak için 64 baytlık bloklarla güncellenir
+void BackupArchiveReader::hashPending() {
+    if (hashFill == 0) return;
+    mbedtls_sha256_update(&contentHash, hashBuffer, hashFill);
+    hashFill = 0;
+}
+
+int BackupArchiveReader::rawRead() {
+    if (!headerValid) return -1;
+    int value = decoder.read();
+    if (value < 0) return -1;
+
+    hashBuffer[hashFill++] = value;
+    if (hashFill == sizeof(hashBuffer)) hashPending();
+    rawCount++;
+    return value;
+}
+
+bool BackupArchiveReader::nextSection(uint8_t& type, uint32_t& length) {
+    while (sectionLeft > 0 && rawRead() >= 0) sectionLeft--;
+    sectionLeft = 0;
+    peeked = -1;
+
+    uint8_t header[5];
+    for (size_t i = 0; i < sizeof(header); i++) {
+        int value = rawRead();
+        if (value < 0) return false;
+        header[i] = value;
+    }
+    type = header[0];
+    length = getLE32(header + 1);
+    sectionLeft = length;
+    return true;
+}
+
+int BackupArchiveReader::available() {
+    return sectionLeft + (peeked >= 0 ? 1 : 0);
+}
+
+int BackupArchiveReader::read() {
+    if (peeked >= 0) {
+        int value = peeked;
+        peeked = -1;
+        return value;
+    }
+    if (sectionLeft == 0) return -1;
+    int value = rawRead();
+    if (value < 0) {
+        sectionLeft = 0;   // Kesik arşiv; verify() başarısız olur
+        return -1;
+    }
+    sectionLeft--;
+    return value;
+}
+
+int BackupArchiveReader::peek() {
+    if (peeked < 0) peeked = read();
+    return peeked;
+}
+
+bool BackupArchiveReader::verify() {
+    if (!headerValid) return false;
+    while (rawRead() >= 0) {}
+    hashPending();
+
+    uint8_t digest[BACKUP_DIGEST_SIZE];
+    mbedtls_sha256_finish(&contentHash, digest);
+    return rawCount == archiveTrailer.rawLength &&
+           memcmp(digest, archiveTrailer.contentDigest, BACKUP_DIGEST_SIZE) == 0;
+}
\ No newline at end of file
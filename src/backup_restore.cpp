@@ -1,25 +1,27 @@
 #include "backup_restore.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
-#include <Preferences.h>
 #include "settings.h"
+#include "settings_store.h"
 #include "log_system.h"
+#include "log_journal.h"
 #include "ntp_handler.h"
-#include "crypto_utils.h"
+#include "civil_time.h"
 #include "auth_system.h"  // checkSession için
+#include "backup_archive.h"
+#include "uart_handler.h"
+#include "dashboard_snapshot.h"
+#include "clock_discipline.h"
+#include "sntp_server.h"
 #include <WebServer.h>
 
-extern WebServer server;
+extern MeteredWebServer server;
 
-// Ayarları JSON formatında export et
-String exportSettingsToJSON() {
-    // JSON document oluştur (2KB buffer) - Yeni ArduinoJson v7 syntax
+// Ayar bölümü: yalnızca yapılandırma (zaman damgası vb. yok), böylece özeti
+// ayarlar değişmedikçe aynı kalır. Şema v1 JSON yedeğiyle aynıdır.
+static void buildSettingsJSON(String& output) {
     JsonDocument doc;
-    
-    // Versiyon bilgisi
     doc["version"] = "1.0";
-    doc["timestamp"] = getFormattedTimestamp();
-    doc["deviceId"] = ETH.macAddress();
     
     // Network ayarları
     JsonObject network = doc["network"].to<JsonObject>();
@@ -46,24 +48,124 @@ String exportSettingsToJSON() {
     ntp["timezone"] = ntpConfig.timezone;
     ntp["enabled"] = ntpConfig.enabled;
     
-    // Log ayarları
-    JsonObject logging = doc["logging"].to<JsonObject>();
-    logging["maxLogs"] = 50;
-    //logging["currentLogs"] = totalLogs;
+    serializeJson(doc, output);
+}
+
+static void buildMetaJSON(String& output, uint8_t flags) {
+    JsonDocument doc;
+    doc["format"] = BACKUP_ARCHIVE_VERSION;
+    doc["timestamp"] = getFormattedTimestamp();
+    doc["deviceId"] = ETH.macAddress();
+    doc["deviceName"] = settings.deviceName;
+    doc["logs"] = (flags & BACKUP_INCLUDE_LOGS) != 0;
+    doc["stats"] = (flags & BACKUP_INCLUDE_STATS) != 0;
     
     // Sistem bilgileri
     JsonObject system = doc["system"].to<JsonObject>();
-    system["freeHeap"] = ESP.getFreeHeap();
     system["chipRevision"] = ESP.getChipRevision();
     system["sdkVersion"] = ESP.getSdkVersion();
     system["flashSize"] = ESP.getFlashChipSize();
     
-    // JSON'u string'e serialize et
-    String output;
-    serializeJsonPretty(doc, output);
+    serializeJson(doc, output);
+}
+
+static void buildStatsJSON(String& output) {
+    JsonDocument doc;
+    doc["uptime"] = millis() / 1000;
+    doc["freeHeap"] = ESP.getFreeHeap();
+    doc["minFreeHeap"] = ESP.getMinFreeHeap();
+    
+    JsonObject uart = doc["uart"].to<JsonObject>();
+    uart["sent"] = uartStats.totalFramesSent;
+    uart["received"] = uartStats.totalFramesReceived;
+    uart["frameErrors"] = uartStats.frameErrors;
+    uart["checksumErrors"] = uartStats.checksumErrors;
+    uart["timeoutErrors"] = uartStats.timeoutErrors;
+    uart["successRate"] = uartStats.successRate;
+    
+    // Arızalar dsPIC'te tutulur; burada son okunan sayı
+    JsonObject faults = doc["faults"].to<JsonObject>();
+    faults["count"] = getLastFaultCount();
+    faults["ageMs"] = getFaultCountAge();
+    
+    ClockDisciplineStatus clock = getClockDisciplineStatus();
+    JsonObject time = doc["clock"].to<JsonObject>();
+    time["locked"] = clock.locked;
+    time["uncertaintyMs"] = clock.uncertaintyUs / 1000.0f;
+    time["driftPpm"] = clock.driftPpm;
+    time["samples"] = clock.samples;
+    
+    SNTPStats sntp = getSNTPStats();
+    doc["sntp"]["requests"] = sntp.requests;
+    doc["sntp"]["dropped"] = sntp.dropped;
+    
+    SettingsStoreStats store = getSettingsStoreStats();
+    doc["settingsStore"]["saves"] = store.saves;
+    doc["settingsStore"]["writes"] = store.writes;
+    
+    serializeJson(doc, output);
+}
+
+// Günlük segmentleri olduğu gibi kopyalanır. Kopya sırasında silinen segmentin
+// eksik kısmı sıfırla doldurulur; kayıtlar CRC'li olduğundan okuyucu atlar.
+static void writeLogSections(BackupArchiveWriter& writer) {
+    flushLogJournal();
+    
+    JournalSegmentRef refs[JOURNAL_MAX_SEGMENTS];
+    size_t count = snapshotJournalSegments(refs, JOURNAL_MAX_SEGMENTS);
+    uint8_t buffer[512];
+    
+    for (size_t i = 0; i < count; i++) {
+        writer.beginSection(BACKUP_SECTION_LOG, 4 + refs[i].size);
+        uint8_t number[4] = {
+            (uint8_t)refs[i].number, (uint8_t)(refs[i].number >> 8),
+            (uint8_t)(refs[i].number >> 16), (uint8_t)(refs[i].number >> 24)
+        };
+        writer.write(number, sizeof(number));
+        
+        File file = LittleFS.open(getJournalSegmentPath(refs[i].number), "r");
+        size_t left = refs[i].size;
+        while (left > 0) {
+            size_t chunk = left < sizeof(buffer) ? left : sizeof(buffer);
+            size_t got = file ? file.read(buffer, chunk) : 0;
+            if (got < chunk) memset(buffer + got, 0, chunk - got);
+            writer.write(buffer, chunk);
+            left -= chunk;
+        }
+        if (file) file.close();
+    }
+}
+
+// Arşivi out'a akıt: meta, ayarlar, istenirse istatistik ve loglar
+static bool writeBackupArchive(Print& out, uint8_t flags, BackupTrailer& trailer) {
+    BackupArchiveWriter* writer = new (std::nothrow) BackupArchiveWriter(out, flags);
+    if (writer == NULL) {
+        addLog("❌ Yedek için bellek yetersiz", ERROR, "BACKUP");
+        return false;
+    }
+    
+    String section;
+    buildMetaJSON(section, flags);
+    writer->writeSection(BACKUP_SECTION_META, section);
     
-    addLog("✅ Ayarlar JSON formatında export edildi", SUCCESS, "BACKUP");
-    return output;
+    section = "";
+    buildSettingsJSON(section);
+    writer->writeSection(BACKUP_SECTION_SETTINGS, section);
+    
+    if (flags & BACKUP_INCLUDE_STATS) {
+        section = "";
+        buildStatsJSON(section);
+        writer->writeSection(BACKUP_SECTION_STATS, section);
+    }
+    section = "";
+    
+    if (flags & BACKUP_INCLUDE_LOGS) {
+        writeLogSections(*writer);
+    }
+    
+    writer->finish(trailer);
+    delete writer;
+    return true;
 }
 
 String getBackupTimestamp() {
@@ -76,147 +178,246 @@ String getBackupTimestamp() {
     return String(buffer);
 }
 
-// handleBackupDownload fonksiyonunda kullanım
-String filename = "teias_backup_" + getBackupTimestamp() + ".json";
+// Geri yüklenecek ayarlar: önce tamamı doğrulanır, sonra tek seferde yazılır
+struct RestorePlan {
+    bool hasNetwork = false;
+    IPAddress localIP, gateway, subnet, dns;
+
+    bool hasDevice = false;
+    String deviceName, tmName;
+    long baudRate = 0;
+
+    bool hasUser = false;
+    String username;
+    unsigned long sessionTimeout = 0;
+
+    bool hasNtp = false;
+    String server1, server2;
+    int timezone = 0;
+    bool enabled = true;
+};
+
+// Yalnızca bilinen alanlar belleğe alınır; bilinmeyen bölümler ayrıştırılırken atlanır
+static void buildRestoreFilter(JsonDocument& filter) {
+    filter["version"] = true;
+    filter["network"]["localIP"] = true;
+    filter["network"]["gateway"] = true;
+    filter["network"]["subnet"] = true;
+    filter["network"]["dns"] = true;
+    filter["device"]["name"] = true;
+    filter["device"]["tmName"] = true;
+    filter["device"]["baudRate"] = true;
+    filter["user"]["username"] = true;
+    filter["user"]["sessionTimeout"] = true;
+    filter["ntp"]["server1"] = true;
+    filter["ntp"]["server2"] = true;
+    filter["ntp"]["timezone"] = true;
+    filter["ntp"]["enabled"] = true;
+}
+
+static bool isValidUsername(const String& username) {
+    if (username.length() < USERNAME_MIN_LENGTH || username.length() > USERNAME_MAX_LENGTH) return false;
+    for (char c : username) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+              (c >= '0' && c <= '9') || c == '_' || c == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool rejectRestore(const String& reason) {
+    addLog("❌ Backup doğrulanamadı: " + reason, ERROR, "RESTORE");
+    return false;
+}
+
+// JSON'u akıştan ayrıştır ve doğrula; herhangi bir alan geçersizse hiçbir şey uygulanmaz
+static bool readRestorePlan(Stream& input, RestorePlan& plan) {
+    JsonDocument filter;
+    buildRestoreFilter(filter);
 
-// JSON'dan ayarları import et
-bool importSettingsFromJSON(const String& jsonData) {
-    // JSON parse et - Yeni ArduinoJson v7 syntax
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, jsonData);
-    
+    DeserializationError error = deserializeJson(doc, input, DeserializationOption::Filter(filter));
     if (error) {
         addLog("❌ JSON parse hatası: " + String(error.c_str()), ERROR, "RESTORE");
         return false;
     }
-    
+
     // Versiyon kontrolü
     String version = doc["version"] | "unknown";
     if (version != "1.0") {
         addLog("⚠️ Uyumsuz backup versiyonu: " + version, WARN, "RESTORE");
     }
-    
-    // Preferences'ı aç
-    Preferences prefs;
-    prefs.begin("app-settings", false);
-    
-    try {
-        // Network ayarlarını yükle
-        if (doc["network"].is<JsonObject>()) {
-            JsonObject network = doc["network"];
-            
-            String ipStr = network["localIP"] | "192.168.1.160";
-            String gwStr = network["gateway"] | "192.168.1.1";
-            String snStr = network["subnet"] | "255.255.255.0";
-            String dnsStr = network["dns"] | "8.8.8.8";
-            
-            // IP validasyonu ve kaydetme
-            IPAddress testIP;
-            if (testIP.fromString(ipStr)) {
-                prefs.putString("local_ip", ipStr);
-                settings.local_IP.fromString(ipStr);
-            }
-            if (testIP.fromString(gwStr)) {
-                prefs.putString("gateway", gwStr);
-                settings.gateway.fromString(gwStr);
-            }
-            if (testIP.fromString(snStr)) {
-                prefs.putString("subnet", snStr);
-                settings.subnet.fromString(snStr);
-            }
-            if (testIP.fromString(dnsStr)) {
-                prefs.putString("dns", dnsStr);
-                settings.primaryDNS.fromString(dnsStr);
-            }
-        }
-        
-        // Cihaz bilgilerini yükle
-        if (doc["device"].is<JsonObject>()) {
-            JsonObject device = doc["device"];
-            
-            String devName = device["name"] | "TEİAŞ EKLİM";
-            String tmName = device["tmName"] | "Belirtilmemiş";
-            long baudRate = device["baudRate"] | 115200;
-            
-            prefs.putString("dev_name", devName);
-            prefs.putString("tm_name", tmName);
-            prefs.putLong("baudrate", baudRate);
-            
-            settings.deviceName = devName;
-            settings.transformerStation = tmName;
-            settings.currentBaudRate = baudRate;
-        }
-        
-        // Kullanıcı ayarlarını yükle (şifre hariç)
-        if (doc["user"].is<JsonObject>()) {
-            JsonObject user = doc["user"];
-            
-            String username = user["username"] | "admin";
-            unsigned long timeout = user["sessionTimeout"] | 1800000;
-            
-            prefs.putString("username", username);
-            settings.username = username;
-            settings.SESSION_TIMEOUT = timeout;
+
+    if (doc["network"].is<JsonObject>()) {
+        JsonObject network = doc["network"];
+        String ipStr = network["localIP"] | "192.168.1.160";
+        String gwStr = network["gateway"] | "192.168.1.1";
+        String snStr = network["subnet"] | "255.255.255.0";
+        String dnsStr = network["dns"] | "8.8.8.8";
+
+        if (!plan.localIP.fromString(ipStr) || !plan.gateway.fromString(gwStr) ||
+            !plan.subnet.fromString(snStr) || !plan.dns.fromString(dnsStr)) {
+            return rejectRestore("geçersiz ağ adresi");
         }
-        
-        // NTP ayarlarını yükle
-        if (doc["ntp"].is<JsonObject>()) {
-            JsonObject ntp = doc["ntp"];
-            
-            String server1 = ntp["server1"] | "pool.ntp.org";
-            String server2 = ntp["server2"] | "time.google.com";
-            int timezone = ntp["timezone"] | 3;
-            bool enabled = ntp["enabled"] | true;
-            
-            // NTP ayarlarını kaydet
-            Preferences ntpPrefs;
-            ntpPrefs.begin("ntp-config", false);
-            ntpPrefs.putString("ntp_server1", server1);
-            ntpPrefs.putString("ntp_server2", server2);
-            ntpPrefs.putInt("timezone", timezone);
-            ntpPrefs.putBool("enabled", enabled);
-            ntpPrefs.end();
-            
-            // Global NTP config'i güncelle
-            server1.toCharArray(ntpConfig.ntpServer1, sizeof(ntpConfig.ntpServer1));
-            server2.toCharArray(ntpConfig.ntpServer2, sizeof(ntpConfig.ntpServer2));
-            ntpConfig.timezone = timezone;
-            ntpConfig.enabled = enabled;
+        plan.hasNetwork = true;
+    }
+
+    if (doc["device"].is<JsonObject>()) {
+        JsonObject device = doc["device"];
+        plan.deviceName = device["name"] | "TEİAŞ EKLİM";
+        plan.tmName = device["tmName"] | "Belirtilmemiş";
+        plan.baudRate = device["baudRate"] | 115200;
+
+        if (plan.deviceName.length() < 3 || plan.deviceName.length() > DEVICE_NAME_MAX_LENGTH) return rejectRestore("cihaz adı");
+        if (plan.tmName.length() > TM_NAME_MAX_LENGTH) return rejectRestore("TM adı");
+        if (plan.baudRate <= 0 || plan.baudRate > 2000000) return rejectRestore("baudrate");
+        plan.hasDevice = true;
+    }
+
+    if (doc["user"].is<JsonObject>()) {
+        JsonObject user = doc["user"];
+        plan.username = user["username"] | "admin";
+        plan.sessionTimeout = user["sessionTimeout"] | 1800000;
+
+        if (!isValidUsername(plan.username)) return rejectRestore("kullanıcı adı");
+        if (plan.sessionTimeout < 60000 || plan.sessionTimeout > 86400000) return rejectRestore("oturum süresi");
+        plan.hasUser = true;
+    }
+
+    if (doc["ntp"].is<JsonObject>()) {
+        JsonObject ntp = doc["ntp"];
+        plan.server1 = ntp["server1"] | "pool.ntp.org";
+        plan.server2 = ntp["server2"] | "time.google.com";
+        plan.timezone = ntp["timezone"] | 3;
+        plan.enabled = ntp["enabled"] | true;
+
+        if (plan.server1.length() == 0 || plan.server1.length() >= sizeof(ntpConfig.ntpServer1) ||
+            plan.server2.length() >= sizeof(ntpConfig.ntpServer2)) {
+            return rejectRestore("NTP sunucusu");
         }
-        
-        prefs.end();
-        
-        addLog("✅ Ayarlar başarıyla import edildi", SUCCESS, "RESTORE");
-        addLog("⚠️ Yeniden başlatma gerekli", WARN, "RESTORE");
-        
-        return true;
-        
-    } catch (...) {
-        prefs.end();
-        addLog("❌ Ayarlar import edilemedi", ERROR, "RESTORE");
-        return false;
+        if (plan.timezone < -12 || plan.timezone > 14) return rejectRestore("saat dilimi");
+        plan.hasNtp = true;
     }
+
+    return true;
 }
 
-// Backup dosyasını kaydet
-bool saveBackupToFile(const String& filename) {
-    // JSON backup oluştur
-    String jsonBackup = exportSettingsToJSON();
+// Doğrulanmış ayarları RAM'e uygula; ayar kaydı tek blob olarak yazılır
+static void applyRestorePlan(const RestorePlan& plan) {
+    if (plan.hasNetwork) {
+        settings.local_IP = plan.localIP;
+        settings.gateway = plan.gateway;
+        settings.subnet = plan.subnet;
+        settings.primaryDNS = plan.dns;
+    }
+
+    if (plan.hasDevice) {
+        settings.deviceName = plan.deviceName;
+        settings.transformerStation = plan.tmName;
+        settings.currentBaudRate = plan.baudRate;
+    }
+
+    if (plan.hasUser) {
+        settings.username = plan.username;
+        settings.SESSION_TIMEOUT = plan.sessionTimeout;
+    }
+
+    if (plan.hasNtp) {
+        plan.server1.toCharArray(ntpConfig.ntpServer1, sizeof(ntpConfig.ntpServer1));
+        plan.server2.toCharArray(ntpConfig.ntpServer2, sizeof(ntpConfig.ntpServer2));
+        ntpConfig.timezone = plan.timezone;
+        ntpConfig.enabled = plan.enabled;
+    }
+
+    saveSettingsStore();
+}
+
+// JSON'dan ayarları import et
+bool importSettingsFromStream(Stream& input) {
+    RestorePlan plan;
+    if (!readRestorePlan(input, plan)) return false;
+
+    applyRestorePlan(plan);
+    addLog("✅ Ayarlar başarıyla import edildi", SUCCESS, "RESTORE");
+    addLog("⚠️ Yeniden başlatma gerekli", WARN, "RESTORE");
+    return true;
+}
+
+// Arşivden geri yükle: ayar bölümü okunurken ayrıştırılır, ancak içerik özeti
+// doğrulandıktan sonra uygulanır
+static bool importBackupArchive(File& file) {
+    BackupArchiveReader reader(file);
+    if (!reader.valid()) return rejectRestore("arşiv başlığı geçersiz");
+
+    RestorePlan plan;
+    bool found = false;
+    uint8_t type;
+    uint32_t length;
+    while (reader.nextSection(type, length)) {
+        if (type != BACKUP_SECTION_SETTINGS || found) continue;
+        if (!readRestorePlan(reader, plan)) return false;
+        found = true;
+    }
+
+    if (!reader.verify()) return rejectRestore("içerik özeti uyuşmuyor");
+    if (!found) return rejectRestore("ayar bölümü yok");
+
+    applyRestorePlan(plan);
+    addLog("✅ Ayarlar arşivden import edildi (özet doğrulandı)", SUCCESS, "RESTORE");
+    return true;
+}
+
+// Biçimi ilk baytlardan ayırt et: .tbk arşivi veya v1 JSON
+static bool importBackupFile(File& file) {
+    return isBackupArchive(file) ? importBackupArchive(file) : importSettingsFromStream(file);
+}
+
+// Yüklenen dosyayı doğrula ve uygula; staging dosyası her durumda silinir
+static bool applyStagedBackup() {
+    File file = LittleFS.open(BACKUP_STAGING_FILE, "r");
+    if (!file) return false;
+
+    bool result = importBackupFile(file);
+    file.close();
+    LittleFS.remove(BACKUP_STAGING_FILE);
+    return result;
+}
+
+// Arşivi önce geçici dosyaya yaz, tamamlanınca yerine taşı
+static bool writeBackupFile(const String& filename, uint8_t flags, BackupTrailer& trailer) {
+    String path = "/" + filename;
+    String tempPath = path + ".tmp";
     
-    // Dosyaya yaz
-    File file = LittleFS.open("/" + filename, "w");
+    File file = LittleFS.open(tempPath, "w");
     if (!file) {
         addLog("❌ Backup dosyası oluşturulamadı: " + filename, ERROR, "BACKUP");
         return false;
     }
     
-    file.print(jsonBackup);
+    bool ok = writeBackupArchive(file, flags, trailer);
+    bool complete = ok && file.size() >= BACKUP_HEADER_SIZE + BACKUP_TRAILER_SIZE;
+    size_t size = file.size();
     file.close();
     
-    addLog("✅ Backup dosyası kaydedildi: " + filename, SUCCESS, "BACKUP");
+    if (!complete) {
+        LittleFS.remove(tempPath);
+        addLog("❌ Backup yazılamadı (disk dolu?): " + filename, ERROR, "BACKUP");
+        return false;
+    }
+    
+    LittleFS.remove(path);
+    LittleFS.rename(tempPath, path);
+    addLog("✅ Backup dosyası kaydedildi: " + filename + " (" + String(trailer.rawLength) + " → " + String(size) + " bayt)", SUCCESS, "BACKUP");
     return true;
 }
 
+// Backup dosyasını kaydet
+bool saveBackupToFile(const String& filename, uint8_t flags) {
+    BackupTrailer trailer;
+    return writeBackupFile(filename, flags, trailer);
+}
+
 // Backup dosyasından yükle
 bool loadBackupFromFile(const String& filename) {
     // Dosyayı aç
@@ -226,117 +427,231 @@ bool loadBackupFromFile(const String& filename) {
         return false;
     }
     
-    // JSON'u oku
-    String jsonData = file.readString();
+    bool result = importBackupFile(file);
     file.close();
-    
-    // Import et
-    return importSettingsFromJSON(jsonData);
+    return result;
 }
 
-// Web API handler - Backup indir
-void handleBackupDownload() {
-    if (!checkSession()) {
-        server.send(401, "text/plain", "Unauthorized");
-        return;
+// Sıkıştırılmış arşivi HTTP chunk'ları halinde gönderir
+class ChunkedResponse : public Print {
+public:
+    size_t write(uint8_t value) override {
+        return write(&value, 1);
+    }
+    
+    size_t write(const uint8_t* data, size_t length) override {
+        for (size_t i = 0; i < length; i++) {
+            buffer[used++] = data[i];
+            if (used == sizeof(buffer)) sendBuffer();
+        }
+        return length;
     }
     
-    // JSON backup oluştur
-    String jsonBackup = exportSettingsToJSON();
+    void finish() {
+        sendBuffer();
+        server.sendContent("");   // Son chunk
+    }
+    
+private:
+    void sendBuffer() {
+        if (used == 0) return;
+        server.sendContent((const char*)buffer, used);
+        used = 0;
+    }
+    
+    uint8_t buffer[1024];
+    size_t used = 0;
+};
+
+// Web API handler - Backup indir (?logs=1&stats=1 ile operasyonel veriler eklenir)
+void handleBackupDownload() {
+    uint8_t flags = 0;
+    if (server.arg("logs") == "1") flags |= BACKUP_INCLUDE_LOGS;
+    if (server.arg("stats") == "1") flags |= BACKUP_INCLUDE_STATS;
     
     // Dosya adı oluştur
-    String filename = "teias_backup_" + getCurrentDate() + ".json";
-    filename.replace(".", "_");
-    filename.replace(" ", "_");
-    filename.replace(":", "_");
-    
-    // HTTP response headers - Blob indirme için güncellendi
-    server.setContentLength(jsonBackup.length());
-    server.sendHeader("Content-Type", "application/json");
+    char date[CIVIL_DATE_SIZE];
+    formatIsoDate(civilNow(), date, sizeof(date));
+    String filename = "teias_backup_" + String(date) + ".tbk";
+    
+    // Boyut önceden bilinmez; arşiv sıkıştırılırken chunked olarak gönderilir
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
     server.sendHeader("Content-Disposition", "attachment; filename=\"" + filename + "\"");
     server.sendHeader("Access-Control-Expose-Headers", "Content-Disposition");
+    server.send(200, "application/octet-stream", "");
+    
+    ChunkedResponse* response = new (std::nothrow) ChunkedResponse();
+    if (response == NULL) {
+        server.sendContent("");
+        return;
+    }
     
-    // JSON'u gönder
-    server.send(200, "application/json", jsonBackup);
+    BackupTrailer trailer;
+    writeBackupArchive(*response, flags, trailer);
+    response->finish();
+    delete response;
     
-    addLog("📥 Backup indirildi", INFO, "BACKUP");
+    addLog("📥 Backup indirildi (" + String(trailer.rawLength) + " bayt ham)", INFO, "BACKUP");
 }
 
-// Web API handler - Backup yükle
+// Yükleme durumu: parçalar staging dosyasına yazılır, sonuç handleBackupRestore'da bildirilir
+enum UploadState { UPLOAD_IDLE, UPLOAD_RECEIVING, UPLOAD_READY, UPLOAD_REJECTED };
+
+static UploadState uploadState = UPLOAD_IDLE;
+static File stagingFile;
+static size_t stagedBytes = 0;
+static int rejectCode = 0;
+static const char* rejectMessage = "";
+
+static void rejectUpload(int code, const char* message) {
+    if (stagingFile) stagingFile.close();
+    LittleFS.remove(BACKUP_STAGING_FILE);
+    uploadState = UPLOAD_REJECTED;
+    rejectCode = code;
+    rejectMessage = message;
+}
+
+// Web API upload handler - parçaları RAM'de biriktirmeden dosyaya yaz
 void handleBackupUpload() {
-    if (!checkSession()) {
-        server.send(401, "text/plain", "Unauthorized");
-        return;
-    }
-    
     HTTPUpload& upload = server.upload();
-    static String uploadedData = "";
-    
+
     if (upload.status == UPLOAD_FILE_START) {
-        uploadedData = "";
+        // Oturum yalnızca ilk parçada kontrol edilir
+        if (!checkSession()) {
+            rejectUpload(401, "Unauthorized");
+            return;
+        }
+        stagingFile = LittleFS.open(BACKUP_STAGING_FILE, "w");
+        if (!stagingFile) {
+            rejectUpload(500, "Staging file could not be created");
+            return;
+        }
+        stagedBytes = 0;
+        uploadState = UPLOAD_RECEIVING;
         addLog("📤 Backup yükleme başladı: " + upload.filename, INFO, "RESTORE");
-        
+
     } else if (upload.status == UPLOAD_FILE_WRITE) {
-        // Veriyi biriktir
-        for (size_t i = 0; i < upload.currentSize; i++) {
-            uploadedData += (char)upload.buf[i];
+        if (uploadState != UPLOAD_RECEIVING) return;
+        if (stagedBytes + upload.currentSize > BACKUP_UPLOAD_MAX_BYTES) {
+            rejectUpload(413, "Backup file too large");
+            return;
         }
-        
+        if (stagingFile.write(upload.buf, upload.currentSize) != upload.currentSize) {
+            rejectUpload(507, "Not enough storage for backup");
+            return;
+        }
+        stagedBytes += upload.currentSize;
+
     } else if (upload.status == UPLOAD_FILE_END) {
-        // Import işlemini başlat
-        if (importSettingsFromJSON(uploadedData)) {
-            server.send(200, "text/plain", "Backup successfully restored. Device will restart.");
-            
-            // 2 saniye sonra restart
-            delay(2000);
-            ESP.restart();
-        } else {
-            server.send(400, "text/plain", "Backup restore failed");
+        if (uploadState != UPLOAD_RECEIVING) return;
+        stagingFile.close();
+        uploadState = UPLOAD_READY;
+
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
+        rejectUpload(400, "Upload aborted");
+    }
+}
+
+// Web API handler - yükleme bittikten sonra doğrula ve uygula
+void handleBackupRestore() {
+    UploadState state = uploadState;
+    uploadState = UPLOAD_IDLE;
+
+    if (state == UPLOAD_REJECTED) {
+        addLog("❌ Backup yükleme reddedildi: " + String(rejectMessage), ERROR, "RESTORE");
+        server.send(rejectCode, "text/plain", rejectMessage);
+        return;
+    }
+    if (state != UPLOAD_READY) {
+        server.send(400, "text/plain", "No backup file received");
+        return;
+    }
+
+    if (!applyStagedBackup()) {
+        server.send(400, "text/plain", "Backup restore failed");
+        return;
+    }
+
+    server.send(200, "text/plain", "Backup successfully restored. Device will restart.");
+
+    // 2 saniye sonra restart
+    delay(2000);
+    flushSettingsStore();
+    flushLogJournal();
+    ESP.restart();
+}
+
+// Son otomatik yedeğin ayar özeti; açılıştan sonra ilk kontrolde dosyadan okunur
+static uint8_t lastAutoDigest[BACKUP_DIGEST_SIZE];
+static bool lastAutoDigestKnown = false;
+
+static void loadLatestAutoDigest() {
+    String newest = "";
+    File root = LittleFS.open("/");
+    File file = root.openNextFile();
+    while (file) {
+        String fname = file.name();
+        if (fname.startsWith("auto_backup_") && fname.endsWith(".tbk") && fname > newest) {
+            newest = fname;
         }
-        
-        uploadedData = "";
+        file = root.openNextFile();
+    }
+    if (newest == "") return;
+    
+    File backup = LittleFS.open("/" + newest, "r");
+    BackupTrailer trailer;
+    if (backup && readBackupTrailer(backup, trailer)) {
+        memcpy(lastAutoDigest, trailer.configDigest, BACKUP_DIGEST_SIZE);
+        lastAutoDigestKnown = true;
     }
+    if (backup) backup.close();
 }
 
-// Otomatik backup oluştur (her gün)
+// Otomatik backup: ayarlar son yedekten beri değiştiyse yazılır
 void createAutomaticBackup() {
-    static unsigned long lastBackup = 0;
-    const unsigned long BACKUP_INTERVAL = 86400000; // 24 saat
-    
-    if (millis() - lastBackup > BACKUP_INTERVAL) {
-        // Tarih damgalı dosya adı
-        String filename = "auto_backup_" + getCurrentDate() + ".json";
-        filename.replace(".", "_");
-        filename.replace(" ", "_");
-        filename.replace(":", "_");
-        
-        // Eski backupları temizle (max 7 adet)
-        File root = LittleFS.open("/");
-        File file = root.openNextFile();
-        int backupCount = 0;
-        String oldestBackup = "";
-        
-        while (file) {
-            String fname = file.name();
-            if (fname.startsWith("auto_backup_")) {
-                backupCount++;
-                if (oldestBackup == "" || fname < oldestBackup) {
-                    oldestBackup = fname;
-                }
+    String settingsJson;
+    buildSettingsJSON(settingsJson);
+    uint8_t digest[BACKUP_DIGEST_SIZE];
+    backupDigest(settingsJson, digest);
+    
+    if (!lastAutoDigestKnown) loadLatestAutoDigest();
+    if (lastAutoDigestKnown && memcmp(digest, lastAutoDigest, BACKUP_DIGEST_SIZE) == 0) {
+        LOG_DEBUG("BACKUP", "Ayarlar değişmedi, otomatik backup atlandı");
+        return;
+    }
+    
+    // Tarih damgalı dosya adı (aynı gün içindeki değişiklik aynı dosyayı günceller)
+    char date[CIVIL_DATE_SIZE];
+    formatIsoDate(civilNow(), date, sizeof(date));
+    String filename = "auto_backup_" + String(date) + ".tbk";
+    
+    // Eski backupları temizle (max AUTO_BACKUP_KEEP adet)
+    File root = LittleFS.open("/");
+    File file = root.openNextFile();
+    int backupCount = 0;
+    String oldestBackup = "";
+    
+    while (file) {
+        String fname = file.name();
+        if (fname.startsWith("auto_backup_")) {
+            backupCount++;
+            if (oldestBackup == "" || fname < oldestBackup) {
+                oldestBackup = fname;
             }
-            file = root.openNextFile();
-        }
-        
-        // 7'den fazla backup varsa en eskisini sil
-        if (backupCount >= 7 && oldestBackup != "") {
-            LittleFS.remove("/" + oldestBackup);
-            addLog("🗑️ Eski backup silindi: " + oldestBackup, INFO, "BACKUP");
-        }
-        
-        // Yeni backup oluştur
-        if (saveBackupToFile(filename)) {
-            lastBackup = millis();
-            addLog("💾 Otomatik backup oluşturuldu", SUCCESS, "BACKUP");
         }
+        file = root.openNextFile();
+    }
+    
+    if (backupCount >= AUTO_BACKUP_KEEP && oldestBackup != "" && !LittleFS.exists("/" + filename)) {
+        LittleFS.remove("/" + oldestBackup);
+        addLog("🗑️ Eski backup silindi: " + oldestBackup, INFO, "BACKUP");
+    }
+    
+    // Yeni backup oluştur (istatistikler küçük; loglar otomatik yedeğe eklenmez)
+    BackupTrailer trailer;
+    if (writeBackupFile(filename, BACKUP_INCLUDE_STATS, trailer)) {
+        memcpy(lastAutoDigest, trailer.configDigest, BACKUP_DIGEST_SIZE);
+        lastAutoDigestKnown = true;
+        addLog("💾 Otomatik backup oluşturuldu", SUCCESS, "BACKUP");
     }
 }
\ No newline at end of file
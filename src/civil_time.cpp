@@ -0,0 +1,181 @@
+// civil_time.cpp - Tarih-saat ayrıştırma ve tampona biçimlendirme
+#include "civil_time.h"
+#include <sys/time.h>
+
+static_assert(civilEpoch(2025, 2, 27, 11, 22, 33) == 1740655353UL, "civilEpoch");
+static_assert(civilFields(1740655353UL).day == 27 && civilFields(1740655353UL).month == 2 &&
+              civilFields(1740655353UL).year == 2025 && civilFields(1740655353UL).second == 33, "civilFields");
+static_assert(civilDaysInMonth(2024, 2) == 29 && civilDaysInMonth(2100, 2) == 28, "civilDaysInMonth");
+
+CivilTime civilNow() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if ((uint32_t)tv.tv_sec < CIVIL_EPOCH_VALID_MIN) return CivilTime{0, 0};
+    return CivilTime{(uint32_t)tv.tv_sec, (uint16_t)(tv.tv_usec / 1000)};
+}
+
+// Sabit genişlikte ondalık alan oku
+static bool readDigits(const char*& p, int width, unsigned& value) {
+    value = 0;
+    for (int i = 0; i < width; i++) {
+        if (p[i] < '0' || p[i] > '9') return false;
+        value = value * 10 + (p[i] - '0');
+    }
+    p += width;
+    return true;
+}
+
+static bool expectChar(const char*& p, char c) {
+    if (*p != c) return false;
+    p++;
+    return true;
+}
+
+static bool readClock(const char*& p, unsigned& hour, unsigned& minute, unsigned& second) {
+    return readDigits(p, 2, hour) && expectChar(p, ':') &&
+           readDigits(p, 2, minute) && expectChar(p, ':') &&
+           readDigits(p, 2, second);
+}
+
+static bool buildCivil(int year, unsigned month, unsigned day,
+                       unsigned hour, unsigned minute, unsigned second, CivilTime& out) {
+    if (!civilFieldsValid(year, month, day, hour, minute, second)) return false;
+    out.epoch = civilEpoch(year, month, day, hour, minute, second);
+    out.ms = 0;
+    return true;
+}
+
+bool parseDsPICDateTime(const char* text, CivilTime& out) {
+    if (!text) return false;
+    const char* p = text;
+    if (p[0] == 'D' && p[1] == ':') p += 2;
+    while (*p == ' ') p++;
+
+    unsigned year, month, day, hour, minute, second;
+    if (!readDigits(p, 2, year) || !expectChar(p, '/') ||
+        !readDigits(p, 2, month) || !expectChar(p, '/') ||
+        !readDigits(p, 2, day) || !expectChar(p, ' ') ||
+        !readClock(p, hour, minute, second)) {
+        return false;
+    }
+    while (*p == ' ' || *p == '\r' || *p == '\n') p++;
+    if (*p != '\0') return false;
+
+    return buildCivil(2000 + year, month, day, hour, minute, second, out);
+}
+
+bool parseIsoDateTime(const char* date, const char* time, CivilTime& out) {
+    if (!date || !time) return false;
+    const char* p = date;
+    unsigned year, month, day, hour, minute, second;
+    if (!readDigits(p, 4, year) || !expectChar(p, '-') ||
+        !readDigits(p, 2, month) || !expectChar(p, '-') ||
+        !readDigits(p, 2, day) || *p != '\0') {
+        return false;
+    }
+    p = time;
+    if (!readClock(p, hour, minute, second) || *p != '\0') return false;
+
+    return buildCivil(year, month, day, hour, minute, second, out);
+}
+
+// Tampona sabit genişlikte sayı yaz
+static char* putDigits(char* p, unsigned value, int width) {
+    for (int i = width - 1; i >= 0; i--) {
+        p[i] = '0' + value % 10;
+        value /= 10;
+    }
+    return p + width;
+}
+
+static CivilFields fieldsOf(const CivilTime& value) {
+    return value.isValid() ? civilFields(value.epoch) : CivilFields{0, 0, 0, 0, 0, 0};
+}
+
+static size_t finish(char* start, char* end, char* out, size_t size) {
+    size_t length = end - start;
+    if (length + 1 > size) return 0;
+    memcpy(out, start, length);
+    out[length] = '\0';
+    return length;
+}
+
+size_t formatIsoDate(const CivilTime& value, char* out, size_t size) {
+    CivilFields f = fieldsOf(value);
+    char buffer[CIVIL_DATE_SIZE];
+    char* p = putDigits(buffer, f.year, 4);
+    *p++ = '-';
+    p = putDigits(p, f.month, 2);
+    *p++ = '-';
+    p = putDigits(p, f.day, 2);
+    return finish(buffer, p, out, size);
+}
+
+size_t formatIsoTime(const CivilTime& value, char* out, size_t size) {
+    CivilFields f = fieldsOf(value);
+    char buffer[CIVIL_TIME_SIZE];
+    char* p = putDigits(buffer, f.hour, 2);
+    *p++ = ':';
+    p = putDigits(p, f.minute, 2);
+    *p++ = ':';
+    p = putDigits(p, f.second, 2);
+    return finish(buffer, p, out, size);
+}
+
+size_t formatIsoDateTime(const CivilTime& value, char* out, size_t size) {
+    if (size < CIVIL_DATETIME_SIZE) return 0;
+    size_t length = formatIsoDate(value, out, size);
+    out[length++] = ' ';
+    return length + formatIsoTime(value, out + length, size - length);
+}
+
+size_t formatDisplayDate(const CivilTime& value, char* out, size_t size) {
+    CivilFields f = fieldsOf(value);
+    char buffer[CIVIL_DATE_SIZE];
+    char* p = putDigits(buffer, f.day, 2);
+    *p++ = '/';
+    p = putDigits(p, f.month, 2);
+    *p++ = '/';
+    p = putDigits(p, f.year, 4);
+    return finish(buffer, p, out, size);
+}
+
+size_t formatDsPICDateTime(const CivilTime& value, char* out, size_t size) {
+    CivilFields f = fieldsOf(value);
+    char buffer[CIVIL_WIRE_SIZE];
+    char* p = buffer;
+    *p++ = 'D';
+    *p++ = ':';
+    p = putDigits(p, f.year % 100, 2);
+    *p++ = '/';
+    p = putDigits(p, f.month, 2);
+    *p++ = '/';
+    p = putDigits(p, f.day, 2);
+    *p++ = ' ';
+    p = putDigits(p, f.hour, 2);
+    *p++ = ':';
+    p = putDigits(p, f.minute, 2);
+    *p++ = ':';
+    p = putDigits(p, f.second, 2);
+    return finish(buffer, p, out, size);
+}
+
+size_t formatDsPICTimeCommand(const CivilTime& value, char* out, size_t size) {
+    CivilFields f = fieldsOf(value);
+    char buffer[CIVIL_COMMAND_SIZE];
+    char* p = putDigits(buffer, f.hour, 2);
+    p = putDigits(p, f.minute, 2);
+    p = putDigits(p, f.second, 2);
+    *p++ = 'c';
+    return finish(buffer, p, out, size);
+}
+
+size_t formatDsPICDateCommand(const CivilTime& value, char* out, size_t size) {
+    CivilFields f = fieldsOf(value);
+    char buffer[CIVIL_COMMAND_SIZE];
+    char* p = putDigits(buffer, f.day, 2);
+    p = putDigits(p, f.month, 2);
+    p = putDigits(p, f.year % 100, 2);
+    *p++ = 'f';
+    return finish(buffer, p, out, size);
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+// client_limiter.cpp - İstemci başına istek hızı ve giriş kilidi
+#include "client_limiter.h"
+
+struct ClientBucket {
+    uint32_t ip;
+    bool used;
+    uint16_t requestTokens;
+    uint8_t loginTokens;
+    unsigned long requestRefillAt;   // Son istek hakkı dolum zamanı
+    unsigned long loginRefillAt;     // Son hatalı deneme hakkı dolum zamanı
+    unsigned long lockedUntil;       // 0: kilit yok
+    unsigned long lastSeen;
+};
+
+static ClientBucket clients[CLIENT_TABLE_SIZE];
+
+static bool isLocked(const ClientBucket& bucket, unsigned long now) {
+    return bucket.lockedUntil != 0 && (long)(bucket.lockedUntil - now) > 0;
+}
+
+// Geçen süre kadar kovaları doldur; artık süre bir sonraki dolum için saklanır
+static void refill(ClientBucket& bucket, unsigned long now) {
+    unsigned long earned = (now - bucket.requestRefillAt) / RATE_REFILL_MS;
+    if (earned > 0) {
+        bucket.requestTokens = min((unsigned long)RATE_BUCKET_CAPACITY, bucket.requestTokens + earned);
+        bucket.requestRefillAt = bucket.requestTokens == RATE_BUCKET_CAPACITY ? now : bucket.requestRefillAt + earned * RATE_REFILL_MS;
+    }
+
+    if (bucket.lockedUntil != 0) {
+        if (isLocked(bucket, now)) return;
+        // Kilit bitti: haklar yeniden tam
+        bucket.lockedUntil = 0;
+        bucket.loginTokens = LOGIN_FAILURE_CAPACITY;
+        bucket.loginRefillAt = now;
+    }
+    earned = (now - bucket.loginRefillAt) / LOGIN_FAILURE_REFILL_MS;
+    if (earned > 0) {
+        bucket.loginTokens = min((unsigned long)LOGIN_FAILURE_CAPACITY, bucket.loginTokens + earned);
+        bucket.loginRefillAt = bucket.loginTokens == LOGIN_FAILURE_CAPACITY ? now : bucket.loginRefillAt + earned * LOGIN_FAILURE_REFILL_MS;
+    }
+}
+
+// İstemcinin kovası; yoksa boş slot veya en uzun süredir görülmeyen istemci kullanılır.
+// Kilitli istemciler, kilitsiz aday varken çıkarılmaz.
+static ClientBucket& bucketFor(const IPAddress& ip) {
+    uint32_t key = (uint32_t)ip;
+    unsigned long now = millis();
+
+    int freeSlot = -1;
+    for (int i = 0; i < CLIENT_TABLE_SIZE; i++) {
+        ClientBucket& bucket = clients[i];
+        if (bucket.used && bucket.ip == key) {
+            refill(bucket, now);
+            bucket.lastSeen = now;
+            return bucket;
+        }
+        if (!bucket.used && freeSlot < 0) freeSlot = i;
+    }
+
+    int victim = freeSlot;
+    if (victim < 0) {
+        int oldestUnlocked = -1;
+        int oldest = 0;
+        for (int i = 0; i < CLIENT_TABLE_SIZE; i++) {
+            if ((long)(clients[i].lastSeen - clients[oldest].lastSeen) < 0) oldest = i;
+            if (!isLocked(clients[i], now) &&
+                (oldestUnlocked < 0 || (long)(clients[i].lastSeen - clients[oldestUnlocked].lastSeen) < 0)) {
+                oldestUnlocked = i;
+            }
+        }
+        victim = oldestUnlocked >= 0 ? oldestUnlocked : oldest;
+    }
+
+    ClientBucket& bucket = clients[victim];
+    bucket.ip = key;
+    bucket.used = true;
+    bucket.requestTokens = RATE_BUCKET_CAPACITY;
+    bucket.loginTokens = LOGIN_FAILURE_CAPACITY;
+    bucket.requestRefillAt = now;
+    bucket.loginRefillAt = now;
+    bucket.lockedUntil = 0;
+    bucket.lastSeen = now;
+    return bucket;
+}
+
+bool clientAllowRequest(const IPAddress& ip) {
+    ClientBucket& bucket = bucketFor(ip);
+    if (bucket.requestTokens == 0) return false;
+    if (bucket.requestTokens == RATE_BUCKET_CAPACITY) bucket.requestRefillAt = millis();
+    bucket.requestTokens--;
+    return true;
+}
+
+unsigned long clientLoginLockRemaining(const IPAddress& ip) {
+    ClientBucket& bucket = bucketFor(ip);
+    unsigned long now = millis();
+    return isLocked(bucket, now) ? bucket.lockedUntil - now : 0;
+}
+
+bool clientLoginFailed(const IPAddress& ip) {
+    ClientBucket& bucket = bucketFor(ip);
+    unsigned long now = millis();
+    if (bucket.loginTokens == LOGIN_FAILURE_CAPACITY) bucket.loginRefillAt = now;
+    if (bucket.loginTokens > 0) bucket.loginTokens--;
+    if (bucket.loginTokens > 0) return false;
+
+    bucket.lockedUntil = now + LOGIN_LOCKOUT_MS;
+    if (bucket.lockedUntil == 0) bucket.lockedUntil = 1;
+    return true;
+}
+
+void clientLoginSucceeded(const IPAddress& ip) {
+    ClientBucket& bucket = bucketFor(ip);
+    bucket.loginTokens = LOGIN_FAILURE_CAPACITY;
+    bucket.loginRefillAt = millis();
+}
+
+int clientLoginAttemptsLeft(const IPAddress& ip) {
+    return bucketFor(ip).loginTokens;
+}
\ No newline at end of file
@@ -0,0 +1,262 @@
+// clock_discipline.cpp - dsPIC referanslı saat disiplini (faz + sürüklenme)
+#include "clock_discipline.h"
+#include "log_system.h"
+#include <esp_timer.h>
+#include <sys/time.h>
+
+#define USEC_PER_SEC 1000000LL
+#define DRIFT_UNKNOWN_PPM 50     // Sürüklenme bilinmezken aralık bu hızda genişler
+#define DRIFT_KNOWN_PPM   5      // Regresyon sonrası kalan belirsizlik
+#define PREDICTION_LIMIT_US 50000   // Tahmin bu kadar tutarsa aralık uzatılır
+
+struct DriftSample {
+    int64_t atUs;            // esp_timer zamanı
+    int64_t uncorrectedUs;   // Hiç düzeltme yapılmasaydı ölçülecek fark
+};
+
+// Fark aralığı: dsPIC - ESP32 (µs), bekleyen adjtime kaydırması tamamlandıktan sonraki hali
+static bool modelValid = false;
+static int64_t offsetLo = 0;
+static int64_t offsetHi = 0;
+static int64_t modelAtUs = 0;
+
+static int64_t cumulativeCorrectionUs = 0;
+static double driftPpm = 0;
+static bool driftKnown = false;
+static DriftSample driftSamples[CLOCK_DRIFT_HISTORY];
+static int driftHead = 0;
+static int driftCount = 0;
+static int64_t lastDriftApplyUs = 0;
+
+static int64_t nextSampleUs = 0;
+static unsigned long intervalMs = CLOCK_SYNC_MIN_INTERVAL;
+static int burstSamples = 0;
+static int64_t halfRoundTripUs = 5000;
+static int32_t lastCorrectionUs = 0;
+static unsigned int sampleCount = 0;
+static bool lockReported = false;
+static volatile bool invalidatePending = false;   // Web görevinden istenir, UART görevinde uygulanır
+
+static int64_t systemTimeUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * USEC_PER_SEC + tv.tv_usec;
+}
+
+// adjtime ile henüz uygulanmamış kaydırma
+static int64_t pendingSlewUs() {
+    struct timeval remaining;
+    if (adjtime(NULL, &remaining) != 0) return 0;
+    return (int64_t)remaining.tv_sec * USEC_PER_SEC + remaining.tv_usec;
+}
+
+static void resetDrift() {
+    driftPpm = 0;
+    driftKnown = false;
+    driftHead = 0;
+    driftCount = 0;
+}
+
+// Aralığı şimdiki zamana taşı: tahmini sürüklenme kadar kaydır, belirsizlik kadar genişlet
+static void propagateModel(int64_t nowUs) {
+    double elapsedSec = (nowUs - modelAtUs) / (double)USEC_PER_SEC;
+    if (elapsedSec <= 0) return;
+
+    int64_t shift = driftKnown ? (int64_t)(driftPpm * elapsedSec) : 0;
+    int64_t spread = (int64_t)((driftKnown ? DRIFT_KNOWN_PPM : DRIFT_UNKNOWN_PPM) * elapsedSec);
+    offsetLo += shift - spread;
+    offsetHi += shift + spread;
+    modelAtUs = nowUs;
+}
+
+// ESP32 saatini correction kadar ileri al. Küçük farklar kaydırılır (adjtime),
+// büyük farklar adımlanır; adım bekleyen kaydırmayı iptal ettiği için o da eklenir.
+static void applyCorrection(int64_t correction) {
+    int64_t pending = pendingSlewUs();
+    int64_t total = correction + pending;
+
+    if (llabs(total) > CLOCK_STEP_THRESHOLD_US) {
+        int64_t target = systemTimeUs() + total;
+        struct timeval tv = { (time_t)(target / USEC_PER_SEC), (suseconds_t)(target % USEC_PER_SEC) };
+        settimeofday(&tv, NULL);
+        refreshClockCache();
+        addLog("⏰ ESP32 saati adımlandı: " + String((long)(total / 1000)) + " ms", WARN, "TIME");
+    } else {
+        struct timeval delta = { (time_t)(total / USEC_PER_SEC), (suseconds_t)(total % USEC_PER_SEC) };
+        adjtime(&delta, NULL);
+    }
+
+    cumulativeCorrectionUs += correction;
+    offsetLo -= correction;
+    offsetHi -= correction;
+}
+
+// Düzeltilmemiş farkın zamana göre eğimi = sürüklenme (µs/s = ppm)
+static void addDriftSample(int64_t atUs, int64_t uncorrectedUs) {
+    driftSamples[driftHead] = { atUs, uncorrectedUs };
+    driftHead = (driftHead + 1) % CLOCK_DRIFT_HISTORY;
+    if (driftCount < CLOCK_DRIFT_HISTORY) driftCount++;
+    if (driftCount < 3) return;
+
+    int oldest = (driftHead - driftCount + CLOCK_DRIFT_HISTORY) % CLOCK_DRIFT_HISTORY;
+    int64_t baseAt = driftSamples[oldest].atUs;
+    int64_t baseValue = driftSamples[oldest].uncorrectedUs;
+
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0, maxX = 0;
+    for (int i = 0; i < driftCount; i++) {
+        const DriftSample& sample = driftSamples[(oldest + i) % CLOCK_DRIFT_HISTORY];
+        double x = (sample.atUs - baseAt) / (double)USEC_PER_SEC;
+        double y = (double)(sample.uncorrectedUs - baseValue);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        if (x > maxX) maxX = x;
+    }
+    if (maxX < CLOCK_DRIFT_MIN_SPAN) return;
+
+    double denominator = driftCount * sumXX - sumX * sumX;
+    if (denominator <= 0) return;
+
+    driftPpm = (driftCount * sumXY - sumX * sumY) / denominator;
+    if (!driftKnown) {
+        driftKnown = true;
+        lastDriftApplyUs = atUs;
+        addLog("⏱️ Saat sürüklenmesi belirlendi: " + String(driftPpm, 1) + " ppm", INFO, "TIME");
+    }
+}
+
+void clockDisciplineSample(time_t reference, int64_t sentUs, int64_t receivedUs) {
+    int64_t monoNow = esp_timer_get_time();
+    int64_t sysNow = systemTimeUs();
+    int64_t pending = pendingSlewUs();
+
+    // dsPIC okuduğu saniyeyi gönderme ile alma arasında bir anda yakalamıştır
+    int64_t sentSys = sysNow - (monoNow - sentUs);
+    int64_t receivedSys = sysNow - (monoNow - receivedUs);
+    int64_t referenceUs = (int64_t)reference * USEC_PER_SEC;
+    int64_t lo = referenceUs - receivedSys - pending;
+    int64_t hi = referenceUs + USEC_PER_SEC - sentSys - pending;
+
+    halfRoundTripUs = (3 * halfRoundTripUs + (receivedUs - sentUs) / 2) / 4;
+    sampleCount++;
+
+    if (modelValid) {
+        propagateModel(receivedUs);
+        // Biriken sürüklenme bu örneğin düzeltmesine dahil
+        lastDriftApplyUs = receivedUs;
+        if (lo > offsetHi || hi < offsetLo) {
+            // dsPIC saati değişmiş veya model hatalı - baştan kilitlen
+            addLog("⚠️ Saat ölçümü modelle uyuşmuyor, yeniden kilitleniyor", WARN, "TIME");
+            modelValid = false;
+            lockReported = false;
+            resetDrift();
+            intervalMs = CLOCK_SYNC_MIN_INTERVAL;
+        }
+    }
+
+    if (!modelValid) {
+        offsetLo = lo;
+        offsetHi = hi;
+        modelAtUs = receivedUs;
+        modelValid = true;
+    } else {
+        if (lo > offsetLo) offsetLo = lo;
+        if (hi < offsetHi) offsetHi = hi;
+    }
+
+    int64_t center = (offsetLo + offsetHi) / 2;
+    int64_t width = offsetHi - offsetLo;
+
+    if (width <= CLOCK_TARGET_WIDTH_US) {
+        addDriftSample(receivedUs, center + cumulativeCorrectionUs);
+    }
+
+    int64_t correction = llabs(center) > CLOCK_SLEW_DEADBAND_US ? center : 0;
+    if (correction != 0) applyCorrection(correction);
+    lastCorrectionUs = (int32_t)constrain(correction, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+
+    // Hedef belirsizliğe inene kadar bir sonraki döngüde tekrar ölç
+    if (width > CLOCK_TARGET_WIDTH_US && burstSamples < CLOCK_BURST_MAX_SAMPLES) {
+        burstSamples++;
+        nextSampleUs = monoNow;
+        return;
+    }
+    burstSamples = 0;
+
+    if (width <= CLOCK_TARGET_WIDTH_US && !lockReported) {
+        lockReported = true;
+        addLog("✅ Saat dsPIC'e kilitlendi: ±" + String((long)(width / 2000)) + " ms (" + String(sampleCount) + " örnek)", SUCCESS, "TIME");
+    }
+
+    // Tahmin tuttuysa ve sürüklenme biliniyorsa aralığı uzat, tutmadıysa kısalt
+    if (llabs(correction) > PREDICTION_LIMIT_US) {
+        intervalMs = CLOCK_SYNC_MIN_INTERVAL;
+    } else if (driftKnown && width <= CLOCK_TARGET_WIDTH_US) {
+        intervalMs = min(intervalMs * 2, (unsigned long)CLOCK_SYNC_MAX_INTERVAL);
+    }
+    nextSampleUs = monoNow + (int64_t)intervalMs * 1000;
+}
+
+void clockDisciplineMiss() {
+    burstSamples = 0;
+    nextSampleUs = esp_timer_get_time() + (int64_t)CLOCK_SYNC_MIN_INTERVAL * 1000;
+}
+
+// Model sadece uartTask içinde değişir; web görevi yalnızca bayrağı kaldırır
+void clockDisciplineInvalidate() {
+    invalidatePending = true;
+}
+
+static void resetModel() {
+    invalidatePending = false;
+    modelValid = false;
+    lockReported = false;
+    resetDrift();
+    burstSamples = 0;
+    intervalMs = CLOCK_SYNC_MIN_INTERVAL;
+    nextSampleUs = 0;
+}
+
+bool clockDisciplineDue() {
+    if (invalidatePending) resetModel();
+    return esp_timer_get_time() >= nextSampleUs;
+}
+
+// Tahmini dsPIC saniye sınırı yanıt anına denk gelsin: ölçüm aralığı ortadan bölünür
+uint32_t clockDisciplineWaitMs() {
+    if (!modelValid) return 0;
+
+    int64_t center = (offsetLo + offsetHi) / 2;
+    int64_t predicted = systemTimeUs() + pendingSlewUs() + center + halfRoundTripUs;
+    int64_t phase = ((predicted % USEC_PER_SEC) + USEC_PER_SEC) % USEC_PER_SEC;
+    return (uint32_t)(((USEC_PER_SEC - phase) % USEC_PER_SEC) / 1000);
+}
+
+// Sürüklenme biliniyorsa saati sorgular arasında da düzenli kaydır
+void processClockDiscipline() {
+    if (!modelValid || !driftKnown) return;
+
+    int64_t now = esp_timer_get_time();
+    if (now - lastDriftApplyUs < (int64_t)CLOCK_DRIFT_APPLY_INTERVAL * 1000) return;
+
+    int64_t correction = (int64_t)(driftPpm * ((now - lastDriftApplyUs) / (double)USEC_PER_SEC));
+    if (llabs(correction) < 1000) return;   // Birikene kadar bekle
+
+    propagateModel(now);
+    applyCorrection(correction);
+    lastDriftApplyUs = now;
+}
+
+ClockDisciplineStatus getClockDisciplineStatus() {
+    ClockDisciplineStatus status;
+    int64_t width = modelValid ? offsetHi - offsetLo : 0;
+    status.locked = modelValid && width <= CLOCK_TARGET_WIDTH_US;
+    status.lastCorrectionUs = lastCorrectionUs;
+    status.uncertaintyUs = modelValid ? (uint32_t)(width / 2) : 0;
+    status.driftPpm = (float)driftPpm;
+    status.driftKnown = driftKnown;
+    status.intervalMs = intervalMs;
+    status.samples = sampleCount;
+    return status;
+}
\ No newline at end of file
@@ -1,28 +1,45 @@
 #include "crypto_utils.h"
+#include "log_system.h"
 #include "mbedtls/sha256.h"
+#include "mbedtls/md.h"
+#include "mbedtls/pkcs5.h"
+#include "settings_store.h"
 #include <Arduino.h>
 
+#define PBKDF2_PREFIX "$p2$"
+#define PBKDF2_KEY_BYTES 32
+#define CALIBRATION_ITERATIONS 1024
+
+static uint32_t hashIterations = PASSWORD_HASH_MIN_ITERATIONS;
+
+static const char hexDigits[] = "0123456789abcdef";
+
+static void toHex(const uint8_t* data, size_t length, char* out) {
+    for (size_t i = 0; i < length; i++) {
+        out[i * 2] = hexDigits[data[i] >> 4];
+        out[i * 2 + 1] = hexDigits[data[i] & 0x0F];
+    }
+    out[length * 2] = '\0';
+}
+
+// v0 özet: SHA-256(salt + data). Sadece eski kayıtları doğrulamak için.
 String sha256(const String& data, const String& salt) {
     if (data.length() == 0 || salt.length() == 0) {
         return "";
     }
-    
-    String toHash = salt + data;
+
     byte hashResult[32];
-    
+
     mbedtls_sha256_context ctx;
     mbedtls_sha256_init(&ctx);
     mbedtls_sha256_starts(&ctx, 0);
-    mbedtls_sha256_update(&ctx, (const unsigned char*) toHash.c_str(), toHash.length());
+    mbedtls_sha256_update(&ctx, (const unsigned char*) salt.c_str(), salt.length());
+    mbedtls_sha256_update(&ctx, (const unsigned char*) data.c_str(), data.length());
     mbedtls_sha256_finish(&ctx, hashResult);
     mbedtls_sha256_free(&ctx);
 
     char hexString[65];
-    for (int i = 0; i < 32; i++) {
-        sprintf(hexString + i * 2, "%02x", hashResult[i]);
-    }
-    hexString[64] = '\0';
-    
+    toHex(hashResult, sizeof(hashResult), hexString);
     return String(hexString);
 }
 
@@ -31,14 +48,213 @@ String generateRandomToken(int length) {
     if (length <= 0 || length > 64) {
         length = 32; // Jeton için daha uzun bir varsayılan
     }
-    
+
     String token = "";
     const char charset[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    
+
     for (int i = 0; i < length; i++) {
         uint32_t randomNum = esp_random();
         token += charset[randomNum % (sizeof(charset) - 1)];
     }
-    
+
     return token;
+}
+
+static bool pbkdf2(const String& password, const String& salt, uint32_t iterations, uint8_t* out) {
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    int rc = mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if (rc == 0) {
+        rc = mbedtls_pkcs5_pbkdf2_hmac(&ctx, (const unsigned char*)password.c_str(), password.length(),
+                                       (const unsigned char*)salt.c_str(), salt.length(),
+                                       iterations, PBKDF2_KEY_BYTES, out);
+    }
+    mbedtls_md_free(&ctx);
+    return rc == 0;
+}
+
+// Tur sayısı cihaz başına bir kez ölçülür; sonraki açılışlarda okunur
+void initPasswordHashing() {
+    uint32_t stored = getStoredHashIterations();
+
+    if (stored >= PASSWORD_HASH_MIN_ITERATIONS) {
+        hashIterations = stored;
+        return;
+    }
+
+    uint8_t key[PBKDF2_KEY_BYTES];
+    unsigned long start = micros();
+    pbkdf2("calibration", "calibration-salt", CALIBRATION_ITERATIONS, key);
+    unsigned long elapsed = max(micros() - start, 1UL);
+
+    uint64_t target = (uint64_t)CALIBRATION_ITERATIONS * PASSWORD_HASH_TARGET_MS * 1000 / elapsed;
+    hashIterations = (uint32_t)constrain(target, (uint64_t)PASSWORD_HASH_MIN_ITERATIONS, (uint64_t)PASSWORD_HASH_MAX_ITERATIONS);
+
+    setStoredHashIterations(hashIterations);
+
+    LOG_INFO("AUTH", "🔐 PBKDF2 tur sayısı ölçüldü: %lu (%lu µs / %d tur)",
+             (unsigned long)hashIterations, elapsed, CALIBRATION_ITERATIONS);
+}
+
+uint32_t getPasswordHashIterations() {
+    return hashIterations;
+}
+
+String hashPassword(const String& password, const String& salt) {
+    uint8_t key[PBKDF2_KEY_BYTES];
+    if (password.length() == 0 || salt.length() == 0 || !pbkdf2(password, salt, hashIterations, key)) {
+        return "";
+    }
+
+    char hex[PBKDF2_KEY_BYTES * 2 + 1];
+    toHex(key, sizeof(key), hex);
+    return String(PBKDF2_PREFIX) + String(hashIterations) + "$" + hex;
+}
+
+// "$p2$<tur>$<hex>" ayrıştır; v0 ise false
+static bool parsePbkdf2Hash(const String& stored, uint32_t& iterations, String& digest) {
+    if (!stored.startsWith(PBKDF2_PREFIX)) return false;
+    int split = stored.indexOf('$', strlen(PBKDF2_PREFIX));
+    if (split < 0) return false;
+    iterations = strtoul(stored.c_str() + strlen(PBKDF2_PREFIX), NULL, 10);
+    digest = stored.substring(split + 1);
+    return iterations > 0 && iterations <= PASSWORD_HASH_MAX_ITERATIONS && digest.length() == PBKDF2_KEY_BYTES * 2;
+}
+
+bool verifyPassword(const String& password, const String& salt, const String& storedHash) {
+    if (password.length() == 0 || storedHash.length() == 0) return false;
+
+    uint32_t iterations;
+    String digest;
+    if (!parsePbkdf2Hash(storedHash, iterations, digest)) {
+        return constantTimeEquals(sha256(password, salt), storedHash);
+    }
+
+    uint8_t key[PBKDF2_KEY_BYTES];
+    if (!pbkdf2(password, salt, iterations, key)) return false;
+    char hex[PBKDF2_KEY_BYTES * 2 + 1];
+    toHex(key, sizeof(key), hex);
+    return constantTimeEquals(String(hex), digest);
+}
+
+bool passwordHashNeedsUpgrade(const String& storedHash) {
+    uint32_t iterations;
+    String digest;
+    return !parsePbkdf2Hash(storedHash, iterations, digest) || iterations < hashIterations;
+}
+
+bool constantTimeEquals(const String& a, const String& b) {
+    if (a.length() != b.length()) return false;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < a.length(); i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+// --- Karşılaştırma için yazılım SHA-256 (FIPS 180-4) ---
+
+static const uint32_t sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+static void softwareSha256Block(uint32_t state[8], const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// chunk (64'ün katı uzunlukta) art arda tekrarlanarak oluşan length baytlık
+// girdinin özeti (dolgu sadece son blokta)
+static void softwareSha256(const uint8_t* chunk, size_t chunkLength, size_t length, uint8_t* out) {
+    uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    size_t full = length & ~(size_t)63;
+    for (size_t i = 0; i < full; i += 64) softwareSha256Block(state, chunk + i % chunkLength);
+
+    uint8_t tail[128] = {0};
+    size_t rest = length - full;
+    memcpy(tail, chunk + full % chunkLength, rest);
+    tail[rest] = 0x80;
+    size_t tailLength = rest < 56 ? 64 : 128;
+    uint64_t bits = (uint64_t)length * 8;
+    for (int i = 0; i < 8; i++) tail[tailLength - 1 - i] = bits >> (i * 8);
+    for (size_t i = 0; i < tailLength; i += 64) softwareSha256Block(state, tail + i);
+
+    for (int i = 0; i < 8; i++) {
+        out[i * 4] = state[i] >> 24;
+        out[i * 4 + 1] = state[i] >> 16;
+        out[i * 4 + 2] = state[i] >> 8;
+        out[i * 4 + 3] = state[i];
+    }
+}
+
+bool runHashBenchmark(uint32_t bytes, HashBenchmark& result) {
+    result = { bytes, 0, 0, hashIterations, 0 };
+    size_t chunkLength = bytes < HASH_BENCHMARK_CHUNK ? ((bytes + 63) & ~(uint32_t)63) : HASH_BENCHMARK_CHUNK;
+    if (chunkLength == 0) chunkLength = 64;
+    uint8_t* buffer = (uint8_t*)malloc(chunkLength);
+    if (!buffer) return false;
+    esp_fill_random(buffer, chunkLength);
+
+    uint8_t softwareDigest[32];
+    uint8_t hardwareDigest[32];
+
+    unsigned long start = micros();
+    softwareSha256(buffer, chunkLength, bytes, softwareDigest);
+    unsigned long softwareUs = max(micros() - start, 1UL);
+
+    start = micros();
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    for (uint32_t offset = 0; offset < bytes; offset += chunkLength) {
+        uint32_t length = bytes - offset < chunkLength ? bytes - offset : chunkLength;
+        mbedtls_sha256_update(&ctx, buffer, length);
+    }
+    mbedtls_sha256_finish(&ctx, hardwareDigest);
+    mbedtls_sha256_free(&ctx);
+    unsigned long hardwareUs = max(micros() - start, 1UL);
+    free(buffer);
+
+    if (memcmp(softwareDigest, hardwareDigest, sizeof(softwareDigest)) != 0) {
+        addLog("❌ SHA-256 karşılaştırması tutmadı (yazılım/donanım)", ERROR, "AUTH");
+    }
+
+    result.softwareKBps = bytes * 1000.0f / 1024.0f / softwareUs * 1000.0f;
+    result.hardwareKBps = bytes * 1000.0f / 1024.0f / hardwareUs * 1000.0f;
+
+    uint8_t key[PBKDF2_KEY_BYTES];
+    start = millis();
+    pbkdf2("benchmark", "benchmark-salt", hashIterations, key);
+    result.pbkdf2Ms = millis() - start;
+
+    return true;
 }
\ No newline at end of file
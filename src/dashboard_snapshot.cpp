@@ -0,0 +1,318 @@
+// dashboard_snapshot.cpp - Gösterge paneli anlık görüntüsü
+// Panel açılışında yapılan ayrı istekler (durum, LED, bildirim, sistem, zaman)
+// tek bir /api/dashboard yanıtında birleştirilir. İstek sırasında ne logStorage
+// taranır ne de dsPIC sorgulanır; bölümler arka plan işinde güncel tutulur.
+#include "dashboard_snapshot.h"
+#include "event_stream.h"
+#include "log_system.h"
+#include "auth_system.h"
+#include "settings.h"
+#include "web_routes.h"
+#include "uart_handler.h"
+#include "time_sync.h"
+#include "clock_discipline.h"
+#include "sntp_server.h"
+#include "data_version.h"
+#include "notification_feed.h"
+#include <ETH.h>
+#include <WebServer.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+
+extern MeteredWebServer server;
+
+#define STATUS_REFRESH_MS    60000   // Değişiklik olmasa da durum tazeleme (heap, uptime)
+#define SYSTEM_REFRESH_MS    10000   // Bellek / UART / dosya sistemi bölümü
+#define LED_POLL_MS          2000    // İzleyen varken LN sorgu aralığı
+#define FAULT_POLL_MS        15000   // İzleyen varken AN sorgu aralığı
+#define DASHBOARD_WATCH_MS   30000   // Son /api/dashboard isteğinden sonra izleniyor sayılır
+#define MAX_NOTIFICATIONS    10      // Panelde gösterilen son uyarı/hata sayısı
+
+enum SnapshotSection {
+    SEC_STATUS = 0,
+    SEC_LED,
+    SEC_NOTIFICATIONS,
+    SEC_SYSTEM,
+    SEC_TIME,
+    SEC_FAULTS,
+    SEC_COUNT
+};
+
+static const char* sectionNames[SEC_COUNT] = {
+    "status", "led", "notifications", "system", "time", "faults"
+};
+
+static String sectionJson[SEC_COUNT];
+static unsigned long snapshotVersion = 0;
+static SemaphoreHandle_t snapshotMutex = NULL;
+
+static uint32_t notificationsVersion = UINT32_MAX;   // Bölümün üretildiği bildirim sürümü
+
+static volatile unsigned long lastDashboardRequest = 0;
+static String lastLedRaw = "";
+static int lastFaultCount = -1;
+static unsigned long lastFaultCountAt = 0;
+
+// Bölümü güncelle; içerik gerçekten değiştiyse sürümü artır
+static bool setSection(SnapshotSection section, const String& json) {
+    if (snapshotMutex == NULL) return false;
+    if (xSemaphoreTake(snapshotMutex, pdMS_TO_TICKS(50)) != pdTRUE) return false;
+
+    bool changed = (sectionJson[section] != json);
+    if (changed) {
+        sectionJson[section] = json;
+        snapshotVersion++;
+    }
+
+    xSemaphoreGive(snapshotMutex);
+    return changed;
+}
+
+void initDashboardSnapshot() {
+    if (snapshotMutex == NULL) {
+        snapshotMutex = xSemaphoreCreateMutex();
+    }
+}
+
+unsigned long getDashboardVersion() {
+    return snapshotVersion;
+}
+
+String getDashboardLedJSON() {
+    String json;
+    if (snapshotMutex != NULL && xSemaphoreTake(snapshotMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        json = sectionJson[SEC_LED];
+        xSemaphoreGive(snapshotMutex);
+    }
+    return json;
+}
+
+// Arıza sayısı her okunduğunda çağrılır; değiştiyse bölümü günceller ve olay üretir
+void notifyFaultCount(int count) {
+    if (count < 0) return;
+
+    int previous = lastFaultCount;
+    lastFaultCount = count;
+    lastFaultCountAt = millis();
+    if (previous != count) {
+        bumpDataVersion(DATA_FAULTS);
+    }
+
+    JsonDocument doc;
+    doc["count"] = count;
+    String output;
+    serializeJson(doc, output);
+    setSection(SEC_FAULTS, output);
+
+    if (previous < 0 || previous == count) return;
+
+    JsonDocument eventDoc;
+    eventDoc["count"] = count;
+    eventDoc["previous"] = previous;
+    eventDoc["newFaults"] = count > previous ? count - previous : 0;
+
+    String eventJson;
+    serializeJson(eventDoc, eventJson);
+    publishEvent(EVT_FAULT, eventJson);
+}
+
+int getLastFaultCount() {
+    return lastFaultCount;
+}
+
+// Arıza sayısı hiç okunmadıysa çok büyük bir değer döner
+unsigned long getFaultCountAge() {
+    if (lastFaultCount < 0) return 0xFFFFFFFF;
+    return millis() - lastFaultCountAt;
+}
+
+// Durum alanlarından biri değiştiyse (veya tazeleme zamanı geldiyse) yeniden üret.
+// Değişiklik metin kurmadan anlaşılır: ayarlar sürüm sayacından, ağ ve
+// senkron durumu sayısal değerlerden karşılaştırılır.
+static void refreshStatusSection(unsigned long now) {
+    static unsigned long lastRefresh = 0;
+    static uint32_t lastSettingsVersion = 0;
+    static uint32_t lastIP = 0;
+    static bool lastLinkUp = false;
+    static bool lastSynced = false;
+
+    uint32_t settingsVersion = getDataVersion(DATA_SETTINGS);
+    uint32_t ip = (uint32_t)ETH.localIP();
+    bool linkUp = ETH.linkUp();
+    bool synced = isTimeSynced();
+
+    bool changed = settingsVersion != lastSettingsVersion || ip != lastIP ||
+                   linkUp != lastLinkUp || synced != lastSynced;
+    if (!changed && lastRefresh != 0 && now - lastRefresh < STATUS_REFRESH_MS) {
+        return;
+    }
+    lastSettingsVersion = settingsVersion;
+    lastIP = ip;
+    lastLinkUp = linkUp;
+    lastSynced = synced;
+    lastRefresh = now;
+
+    String json = buildStatusJSON();
+    setSection(SEC_STATUS, json);
+    publishEvent(EVT_STATUS, json);
+}
+
+static void refreshSystemSection(unsigned long now) {
+    static unsigned long lastRefresh = 0;
+    if (lastRefresh != 0 && now - lastRefresh < SYSTEM_REFRESH_MS) return;
+    lastRefresh = now;
+
+    JsonDocument doc;
+    doc["freeHeap"] = ESP.getFreeHeap();
+    doc["totalHeap"] = ESP.getHeapSize();
+    doc["minFreeHeap"] = ESP.getMinFreeHeap();
+    doc["maxAllocHeap"] = ESP.getMaxAllocHeap();
+    doc["uptime"] = now / 1000;
+    doc["uartTx"] = uartStats.totalFramesSent;
+    doc["uartRx"] = uartStats.totalFramesReceived;
+    doc["uartErrors"] = uartStats.frameErrors + uartStats.checksumErrors + uartStats.timeoutErrors;
+    doc["uartSuccessRate"] = uartStats.successRate;
+    doc["fsTotal"] = LittleFS.totalBytes();
+    doc["fsUsed"] = LittleFS.usedBytes();
+
+    String output;
+    serializeJson(doc, output);
+    setSection(SEC_SYSTEM, output);
+
+    // /api/system-info bu örnekleme aralığında 304 dönebilir
+    bumpDataVersion(DATA_SYSTEM);
+}
+
+// dsPIC zaman senkron bilgisi - sadece senkron sayaçları değişince
+static void refreshTimeSection() {
+    static unsigned long lastSyncSeen = 0xFFFFFFFF;
+    static unsigned int lastFailSeen = 0xFFFFFFFF;
+
+    if (timeData.lastSync == lastSyncSeen && timeData.failCount == lastFailSeen) return;
+    lastSyncSeen = timeData.lastSync;
+    lastFailSeen = timeData.failCount;
+
+    JsonDocument doc;
+    doc["synced"] = isTimeSynced();
+    char buffer[CIVIL_DATE_SIZE] = "";
+    if (timeData.lastReading.isValid()) formatIsoDate(timeData.lastReading, buffer, sizeof(buffer));
+    doc["date"] = buffer;
+    if (timeData.lastReading.isValid()) formatIsoTime(timeData.lastReading, buffer, sizeof(buffer));
+    doc["time"] = buffer;
+    doc["syncCount"] = timeData.syncCount;
+    doc["failCount"] = timeData.failCount;
+    doc["lastSync"] = timeData.lastSync;
+
+    ClockDisciplineStatus clock = getClockDisciplineStatus();
+    doc["locked"] = clock.locked;
+    doc["uncertaintyMs"] = clock.uncertaintyUs / 1000.0f;
+    if (clock.driftKnown) doc["driftPpm"] = clock.driftPpm;
+    doc["intervalSec"] = clock.intervalMs / 1000;
+
+    SNTPStats sntp = getSNTPStats();
+    doc["sntpStratum"] = sntp.stratum;
+    doc["sntpRequests"] = sntp.requests;
+
+    String output;
+    serializeJson(doc, output);
+    setSection(SEC_TIME, output);
+}
+
+static void refreshNotificationsSection() {
+    // Bildirim halkası değişmediyse bölüm aynıdır
+    uint32_t version = getNotificationVersion();
+    if (version == notificationsVersion) return;
+    notificationsVersion = version;
+
+    JsonDocument doc;
+    writeNotificationsJSON(doc, 0, MAX_NOTIFICATIONS);
+
+    String output;
+    serializeJson(doc, output);
+    setSection(SEC_NOTIFICATIONS, output);
+}
+
+// Panel izleniyorsa (akış abonesi veya yakın zamanda /api/dashboard isteği)
+// dsPIC'i arka planda sorgula - UART meşgulse bu turu atla
+static void pollDeviceSections(unsigned long now) {
+    static unsigned long lastLedPoll = 0;
+    static unsigned long lastFaultPoll = 0;
+
+    bool watched = hasEventSubscribers() ||
+                   (lastDashboardRequest != 0 && now - lastDashboardRequest < DASHBOARD_WATCH_MS);
+    if (!watched) return;
+
+    if (now - lastLedPoll >= LED_POLL_MS && lockUART(0)) {
+        lastLedPoll = now;
+        String ledResponse;
+        bool success = sendCustomCommand("LN", ledResponse, 300);
+        unlockUART();
+
+        if (success && ledResponse != lastLedRaw) {
+            JsonDocument doc;
+            if (buildLedStatusJSON(doc, success, ledResponse)) {
+                lastLedRaw = ledResponse;
+                String output;
+                serializeJson(doc, output);
+                setSection(SEC_LED, output);
+                publishEvent(EVT_LED, output);
+            }
+        }
+    }
+
+    if (now - lastFaultPoll >= FAULT_POLL_MS && lockUART(0)) {
+        lastFaultPoll = now;
+        String response;
+        bool success = sendCustomCommand("AN", response, 1000);
+        unlockUART();
+
+        // Format: "A<n>" -> n - 1 arıza (getTotalFaultCount ile aynı)
+        if (success && response.length() >= 2 && response.charAt(0) == 'A') {
+            notifyFaultCount(response.substring(1).toInt() - 1);
+        }
+    }
+}
+
+void updateDashboardSnapshot() {
+    unsigned long now = millis();
+
+    refreshStatusSection(now);
+    refreshSystemSection(now);
+    refreshTimeSection();
+    refreshNotificationsSection();
+    pollDeviceSections(now);
+}
+
+// GET /api/dashboard - tüm bölümler tek yanıtta, sürüm numarasıyla
+void handleDashboardAPI() {
+    lastDashboardRequest = millis();
+
+    // Arka plan işi henüz çalışmadıysa durum bölümünü burada üret (UART gerektirmez)
+    if (sectionJson[SEC_STATUS].length() == 0) {
+        setSection(SEC_STATUS, buildStatusJSON());
+    }
+
+    String output;
+    if (xSemaphoreTake(snapshotMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        server.send(503, "application/json", "{\"error\":\"Snapshot busy\"}");
+        return;
+    }
+
+    size_t total = 32;
+    for (int i = 0; i < SEC_COUNT; i++) total += sectionJson[i].length() + 20;
+    output.reserve(total);
+
+    output = "{\"version\":";
+    output += snapshotVersion;
+    for (int i = 0; i < SEC_COUNT; i++) {
+        output += ",\"";
+        output += sectionNames[i];
+        output += "\":";
+        output += sectionJson[i].length() > 0 ? sectionJson[i] : String("null");
+    }
+    output += "}";
+    xSemaphoreGive(snapshotMutex);
+
+    addSecurityHeaders();
+    server.send(200, "application/json", output);
+}
\ No newline at end of file
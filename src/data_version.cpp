@@ -0,0 +1,39 @@
+// data_version.cpp - Alan bazlı sürüm sayaçları (koşullu GET için)
+#include "data_version.h"
+
+static uint32_t dataVersions[DATA_DOMAIN_COUNT] = {0};
+static uint32_t bootId = 0;
+static portMUX_TYPE versionMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* domainTags[DATA_DOMAIN_COUNT] = {
+    "logs", "notif", "sys", "faults", "settings"
+};
+
+// Yeniden başlatmadan sonra sayaçlar sıfırlanır; eski ETag'ler
+// yanlışlıkla eşleşmesin diye her açılışta rastgele bir önek kullanılır
+void initDataVersions() {
+    bootId = esp_random();
+}
+
+void bumpDataVersion(DataDomain domain) {
+    if (domain >= DATA_DOMAIN_COUNT) return;
+    portENTER_CRITICAL(&versionMux);
+    dataVersions[domain]++;
+    portEXIT_CRITICAL(&versionMux);
+}
+
+uint32_t getDataVersion(DataDomain domain) {
+    if (domain >= DATA_DOMAIN_COUNT) return 0;
+    return dataVersions[domain];
+}
+
+String getDataETag(DataDomain domain) {
+    char etag[40];
+    snprintf(etag, sizeof(etag), "W/\"%08lx-%s-%lu\"",
+             (unsigned long)bootId, domainTags[domain], (unsigned long)getDataVersion(domain));
+    return String(etag);
+}
+
+uint32_t getBootId() {
+    return bootId;
+}
\ No newline at end of file
@@ -1,13 +1,12 @@
 #include "datetime_handler.h"
 #include "uart_handler.h"
 #include "log_system.h"
+#include "clock_discipline.h"
 #include <time.h>
 
 // Global datetime verisi
 DateTimeData datetimeData = {
-    .rawData = "",
-    .date = "",
-    .time = "",
+    .value = {0, 0},
     .lastUpdate = 0,
     .isValid = false
 };
@@ -28,7 +27,7 @@ bool requestDateTimeFromDsPIC() {
         return false;
     }
     
-    addLog("dsPIC'ten yanıt alındı: " + response, DEBUG, "DATETIME");
+    LOG_DEBUG("DATETIME", "dsPIC'ten yanıt alındı: %s", response.c_str());
     
     // Yanıtı parse et
     if (parseeDateTimeResponse(response)) {
@@ -45,53 +44,24 @@ bool requestDateTimeFromDsPIC() {
 }
 
 // dsPIC'ten gelen yanıtı parse et
-// Beklenen format: "D:22/02/25 11:22:33"
+// Beklenen format: "D:25/02/27 11:22:33" (YY/MM/DD)
 bool parseeDateTimeResponse(const String& response) {
-    if (response.length() < 10) {
-        return false;
-    }
-    
-    // Raw datayı sakla
-    datetimeData.rawData = response;
-    
-    // "D:" prefix'ini kontrol et
-    if (response.startsWith("D:")) {
-        String dateTimeStr = response.substring(2); // "D:" kısmını at
-        dateTimeStr.trim();
-        
-        // Format: "22/02/25 11:22:33"
-        int spaceIndex = dateTimeStr.indexOf(' ');
-        if (spaceIndex > 0 && spaceIndex < dateTimeStr.length() - 1) {
-            String dateStr = dateTimeStr.substring(0, spaceIndex);    // "22/02/25"
-            String timeStr = dateTimeStr.substring(spaceIndex + 1);   // "11:22:33"
-            
-            // Tarih formatını kontrol et (DD/MM/YY)
-            if (dateStr.length() == 8 && dateStr.charAt(2) == '/' && dateStr.charAt(5) == '/') {
-                // Saat formatını kontrol et (HH:MM:SS)
-                if (timeStr.length() == 8 && timeStr.charAt(2) == ':' && timeStr.charAt(5) == ':') {
-                    datetimeData.date = formatDateForDisplay(dateStr);
-                    datetimeData.time = formatTimeForDisplay(timeStr);
-                    return true;
-                }
-            }
-        }
-    }
-    
-    return false;
+    return parseDsPICDateTime(response.c_str(), datetimeData.value);
 }
 
 // dsPIC'e tarih ve saat ayarı gönder
-bool setDateTimeToDsPIC(const String& date, const String& time) {
-    if (!validateDateTime(date, time)) {
+bool setDateTimeToDsPIC(const CivilTime& value) {
+    if (!value.isValid()) {
         addLog("❌ Geçersiz tarih veya saat formatı", ERROR, "DATETIME");
         return false;
     }
     
     // Önce saat komutunu hazırla ve gönder
-    String timeCommand = formatTimeCommand(time);
+    char timeCommand[CIVIL_COMMAND_SIZE];
+    formatDsPICTimeCommand(value, timeCommand, sizeof(timeCommand));
     String timeResponse;
     
-    addLog("Saat ayarlama komutu gönderiliyor: " + timeCommand, INFO, "DATETIME");
+    LOG_INFO("DATETIME", "Saat ayarlama komutu gönderiliyor: %s", timeCommand);
     
     if (!sendCustomCommand(timeCommand, timeResponse, 2000)) {
         addLog("❌ Saat ayarlama komutu gönderilirken hata", ERROR, "DATETIME");
@@ -100,16 +70,17 @@ bool setDateTimeToDsPIC(const String& date, const String& time) {
     }
     
     addCommandToHistory(timeCommand, true, timeResponse);
-    addLog("Saat komutu yanıtı: " + timeResponse, DEBUG, "DATETIME");
+    LOG_DEBUG("DATETIME", "Saat komutu yanıtı: %s", timeResponse.c_str());
     
     // Kısa bir bekleme
     delay(500);
     
     // Sonra tarih komutunu hazırla ve gönder
-    String dateCommand = formatDateCommand(date);
+    char dateCommand[CIVIL_COMMAND_SIZE];
+    formatDsPICDateCommand(value, dateCommand, sizeof(dateCommand));
     String dateResponse;
     
-    addLog("Tarih ayarlama komutu gönderiliyor: " + dateCommand, INFO, "DATETIME");
+    LOG_INFO("DATETIME", "Tarih ayarlama komutu gönderiliyor: %s", dateCommand);
     
     if (!sendCustomCommand(dateCommand, dateResponse, 2000)) {
         addLog("❌ Tarih ayarlama komutu gönderilirken hata", ERROR, "DATETIME");
@@ -118,9 +89,12 @@ bool setDateTimeToDsPIC(const String& date, const String& time) {
     }
     
     addCommandToHistory(dateCommand, true, dateResponse);
-    addLog("Tarih komutu yanıtı: " + dateResponse, DEBUG, "DATETIME");
+    LOG_DEBUG("DATETIME", "Tarih komutu yanıtı: %s", dateResponse.c_str());
     
     addLog("✅ Tarih-saat ayarlama tamamlandı", SUCCESS, "DATETIME");
+
+    // Referans saat değişti: ESP32 saat modeli yeniden kurulsun
+    clockDisciplineInvalidate();
     
     // Ayarlama sonrası kontrol et
     delay(1000);
@@ -129,99 +103,31 @@ bool setDateTimeToDsPIC(const String& date, const String& time) {
     return true;
 }
 
-// Saat komutunu formatla: "11:22:33" -> "112233c"
-String formatTimeCommand(const String& time) {
-    if (time.length() != 8) return "";
-    
-    String hours = time.substring(0, 2);
-    String minutes = time.substring(3, 5);
-    String seconds = time.substring(6, 8);
-    
-    return hours + minutes + seconds + "c";
-}
-
-// Tarih komutunu formatla: "2025-02-27" -> "270225f"
-String formatDateCommand(const String& date) {
-    if (date.length() != 10) return "";
-    
-    String year = date.substring(2, 4);   // "25" (son iki hanesi)
-    String month = date.substring(5, 7);  // "02"
-    String day = date.substring(8, 10);   // "27"
-    
-    return day + month + year + "f";
-}
-
-// Tarih-saat validasyonu
-bool validateDateTime(const String& date, const String& time) {
-    // Tarih formatı: YYYY-MM-DD (2025-02-27)
-    if (date.length() != 10 || date.charAt(4) != '-' || date.charAt(7) != '-') {
-        return false;
-    }
-    
-    // Saat formatı: HH:MM:SS (11:22:33)
-    if (time.length() != 8 || time.charAt(2) != ':' || time.charAt(5) != ':') {
-        return false;
-    }
-    
-    // Sayısal kontrol
-    int year = date.substring(0, 4).toInt();
-    int month = date.substring(5, 7).toInt();
-    int day = date.substring(8, 10).toInt();
-    
-    int hour = time.substring(0, 2).toInt();
-    int minute = time.substring(3, 5).toInt();
-    int second = time.substring(6, 8).toInt();
-    
-    // Temel aralık kontrolleri
-    if (year < 2020 || year > 2099) return false;
-    if (month < 1 || month > 12) return false;
-    if (day < 1 || day > 31) return false;
-    if (hour < 0 || hour > 23) return false;
-    if (minute < 0 || minute > 59) return false;
-    if (second < 0 || second > 59) return false;
-    
-    return true;
-}
-
 // ESP32'nin mevcut tarih-saatini al
-String getCurrentESP32DateTime() {
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo, 10)) {
-        char buffer[32];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
-        return String(buffer);
+void getCurrentESP32DateTime(char* out, size_t size) {
+    CivilTime now = civilNow();
+    if (now.isValid()) {
+        formatIsoDateTime(now, out, size);
     } else {
-        // NTP yoksa millis bazlı zaman
+        // Saat yoksa millis bazlı zaman
         unsigned long sec = millis() / 1000;
-        unsigned long min = sec / 60;
-        unsigned long hour = min / 60;
-        
-        char buffer[32];
-        sprintf(buffer, "Uptime: %02lu:%02lu:%02lu", hour % 24, min % 60, sec % 60);
-        return String(buffer);
+        snprintf(out, size, "Uptime: %02lu:%02lu:%02lu", (sec / 3600) % 24, (sec / 60) % 60, sec % 60);
     }
 }
 
 // ESP32 saati ile senkronize et
 bool syncWithESP32Time() {
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo, 10)) {
+    CivilTime now = civilNow();
+    if (!now.isValid()) {
         addLog("❌ ESP32 sistem saati alınamadı", ERROR, "DATETIME");
         return false;
     }
     
-    // ESP32 saatini al
-    char dateBuffer[16];
-    char timeBuffer[16];
-    strftime(dateBuffer, sizeof(dateBuffer), "%Y-%m-%d", &timeinfo);
-    strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", &timeinfo);
-    
-    String espDate = String(dateBuffer);
-    String espTime = String(timeBuffer);
+    char buffer[CIVIL_DATETIME_SIZE];
+    formatIsoDateTime(now, buffer, sizeof(buffer));
+    LOG_INFO("DATETIME", "ESP32 saati ile senkronizasyon: %s", buffer);
     
-    addLog("ESP32 saati ile senkronizasyon: " + espDate + " " + espTime, INFO, "DATETIME");
-    
-    return setDateTimeToDsPIC(espDate, espTime);
+    return setDateTimeToDsPIC(now);
 }
 
 // Komut geçmişine ekle
@@ -230,15 +136,10 @@ void addCommandToHistory(const String& command, bool success, const String& resp
     commandHistory[historyIndex].success = success;
     commandHistory[historyIndex].response = response;
     
-    // Timestamp ekle
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo, 10)) {
-        char buffer[32];
-        strftime(buffer, sizeof(buffer), "%H:%M:%S", &timeinfo);
-        commandHistory[historyIndex].timestamp = String(buffer);
-    } else {
-        commandHistory[historyIndex].timestamp = String(millis() / 1000) + "s";
-    }
+    // Zaman damgası - saat yoksa açılıştan bu yana saniye
+    CivilTime now = civilNow();
+    if (!now.isValid()) now = CivilTime{(uint32_t)(millis() / 1000), 0};
+    commandHistory[historyIndex].at = now;
     
     historyIndex = (historyIndex + 1) % 10;
     if (historyCount < 10) {
@@ -255,9 +156,16 @@ String getCommandHistoryJSON() {
         
         if (i > 0) json += ",";
         
+        char timestamp[CIVIL_TIME_SIZE + 8];
+        if (commandHistory[idx].at.isValid()) {
+            formatIsoTime(commandHistory[idx].at, timestamp, sizeof(timestamp));
+        } else {
+            snprintf(timestamp, sizeof(timestamp), "%lus", (unsigned long)commandHistory[idx].at.epoch);
+        }
+        
         json += "{";
         json += "\"command\":\"" + commandHistory[idx].command + "\",";
-        json += "\"timestamp\":\"" + commandHistory[idx].timestamp + "\",";
+        json += "\"timestamp\":\"" + String(timestamp) + "\",";
         json += "\"success\":" + String(commandHistory[idx].success ? "true" : "false") + ",";
         json += "\"response\":\"" + commandHistory[idx].response + "\"";
         json += "}";
@@ -267,42 +175,14 @@ String getCommandHistoryJSON() {
     return json;
 }
 
-// Görüntüleme için tarih formatla: "25/09/17" (YY/MM/DD) -> "17/09/2025" (DD/MM/YYYY)
-String formatDateForDisplay(const String& rawDate) {
-    if (rawDate.length() != 8) return rawDate;
-    
-    String year = rawDate.substring(0, 2);   // "25"
-    String month = rawDate.substring(3, 5);  // "09" 
-    String day = rawDate.substring(6, 8);    // "17"
-    
-    // YY -> YYYY dönüşümü (20XX varsayımı)
-    int yearInt = year.toInt();
-    if (yearInt >= 0 && yearInt <= 99) {
-        yearInt += 2000;
-        year = String(yearInt);
-    }
-    
-    // DD/MM/YYYY formatında döndür
-    return day + "/" + month + "/" + year;
-}
-
-// Görüntüleme için saat formatla: zaten HH:MM:SS formatında
-String formatTimeForDisplay(const String& rawTime) {
-    return rawTime; // Zaten doğru formatta
-}
-
 // DateTime verisi geçerli mi?
 bool isDateTimeDataValid() {
-    return datetimeData.isValid && 
-           datetimeData.date.length() > 0 && 
-           datetimeData.time.length() > 0;
+    return datetimeData.isValid && datetimeData.value.isValid();
 }
 
 // DateTime verilerini temizle
 void clearDateTimeData() {
-    datetimeData.rawData = "";
-    datetimeData.date = "";
-    datetimeData.time = "";
+    datetimeData.value = CivilTime{0, 0};
     datetimeData.lastUpdate = 0;
     datetimeData.isValid = false;
     
@@ -0,0 +1,269 @@
+// event_stream.cpp - Server-Sent Events push kanalı
+// Tarayıcılar /api/events'e bir kez bağlanır; durum, LED, log, arıza ve link
+// olayları sadece değiştiklerinde gönderilir (polling yerine).
+#include "event_stream.h"
+#include "auth_system.h"
+#include "settings.h"
+#include "log_system.h"
+#include "web_routes.h"
+#include "dashboard_snapshot.h"
+#include <WebServer.h>
+#include <ArduinoJson.h>
+
+extern MeteredWebServer server;
+
+#define MAX_STREAM_CLIENTS   4       // Aynı anda açık akış sayısı
+#define EVENT_QUEUE_SIZE     32      // Gönderilmeyi bekleyen olay kuyruğu
+#define EVENT_BATCH_SIZE     8       // processEventStream başına gönderilen olay
+#define STREAM_HEARTBEAT_MS  15000   // Bağlantıyı canlı tutma + oturum kontrolü
+
+struct StreamClient {
+    WiFiClient client;
+    String token;
+    bool active;
+};
+
+struct PendingEvent {
+    StreamEventType type;
+    String data;
+};
+
+static StreamClient streamClients[MAX_STREAM_CLIENTS];
+static PendingEvent eventQueue[EVENT_QUEUE_SIZE];
+static int queueHead = 0;
+static int queueCount = 0;
+static volatile int subscriberCount = 0;
+static unsigned long eventSequence = 0;
+static SemaphoreHandle_t eventMutex = NULL;
+
+static const char* eventTypeName(StreamEventType type) {
+    switch (type) {
+        case EVT_STATUS: return "status";
+        case EVT_LED:    return "led";
+        case EVT_LOG:    return "log";
+        case EVT_FAULT:  return "fault";
+        case EVT_LINK:   return "link";
+        default:         return "message";
+    }
+}
+
+void initEventStream() {
+    if (eventMutex == NULL) {
+        eventMutex = xSemaphoreCreateMutex();
+    }
+    for (int i = 0; i < MAX_STREAM_CLIENTS; i++) {
+        streamClients[i].active = false;
+    }
+}
+
+bool hasEventSubscribers() {
+    return subscriberCount > 0;
+}
+
+int getEventSubscriberCount() {
+    return subscriberCount;
+}
+
+// Kuyruğa olay ekle - soket yazımı sadece web task'ında yapılır
+void publishEvent(StreamEventType type, const String& jsonData) {
+    if (subscriberCount == 0 || eventMutex == NULL) return;
+    if (xSemaphoreTake(eventMutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+
+    // Kuyruk doluysa en eski olayın üzerine yaz
+    if (queueCount == EVENT_QUEUE_SIZE) {
+        queueHead = (queueHead + 1) % EVENT_QUEUE_SIZE;
+        queueCount--;
+    }
+    int slot = (queueHead + queueCount) % EVENT_QUEUE_SIZE;
+    eventQueue[slot].type = type;
+    eventQueue[slot].data = jsonData;
+    queueCount++;
+
+    xSemaphoreGive(eventMutex);
+}
+
+void publishLogEvent(const LogEntry& entry) {
+    if (subscriberCount == 0) return;
+
+    JsonDocument doc;
+    doc["t"] = formatLogTimestamp(entry.epoch);
+    doc["m"] = entry.message;
+    doc["l"] = logLevelToString(entry.level);
+    doc["s"] = getLogSourceName(entry.source);
+    doc["id"] = entry.seq;
+
+    String output;
+    serializeJson(doc, output);
+    publishEvent(EVT_LOG, output);
+}
+
+void publishLinkEvent(bool linkUp) {
+    if (subscriberCount == 0) return;
+
+    JsonDocument doc;
+    doc["linkUp"] = linkUp;
+    doc["ip"] = ETH.localIP().toString();
+    if (linkUp) {
+        doc["speed"] = ETH.linkSpeed();
+    }
+
+    String output;
+    serializeJson(doc, output);
+    publishEvent(EVT_LINK, output);
+}
+
+// Tek bir SSE çerçevesini istemciye yaz. Çerçevenin tamamını alamayan
+// (takılmış) istemci false ile düşürülür.
+static bool writeFrame(StreamClient& sc, const String& frame) {
+    return writeClientNonBlocking(sc.client, frame.c_str(), frame.length());
+}
+
+static String buildFrame(StreamEventType type, unsigned long id, const String& data) {
+    String frame;
+    frame.reserve(data.length() + 40);
+    frame = "id: ";
+    frame += id;
+    frame += "\nevent: ";
+    frame += eventTypeName(type);
+    frame += "\ndata: ";
+    frame += data;
+    frame += "\n\n";
+    return frame;
+}
+
+static void dropClient(int index, const char* reason) {
+    StreamClient& sc = streamClients[index];
+    if (!sc.active) return;
+
+    IPAddress ip = sc.client.remoteIP();
+    sc.client.stop();
+    sc.client = WiFiClient();
+    sc.token = "";
+    sc.active = false;
+    subscriberCount--;
+
+    LOG_DEBUG("STREAM", "📴 Olay akışı kapandı (%s): %u.%u.%u.%u", reason, ip[0], ip[1], ip[2], ip[3]);
+}
+
+static void broadcastFrame(const String& frame) {
+    for (int i = 0; i < MAX_STREAM_CLIENTS; i++) {
+        if (streamClients[i].active && !writeFrame(streamClients[i], frame)) {
+            dropClient(i, "bağlantı koptu veya yazılamadı");
+        }
+    }
+}
+
+// Heartbeat: bağlantıyı canlı tut, oturumu geçersizleşen akışları kapat
+static void sendHeartbeats() {
+    static unsigned long lastHeartbeat = 0;
+    if (millis() - lastHeartbeat < STREAM_HEARTBEAT_MS) return;
+    lastHeartbeat = millis();
+
+    for (int i = 0; i < MAX_STREAM_CLIENTS; i++) {
+        StreamClient& sc = streamClients[i];
+        if (!sc.active) continue;
+
+        if (!isTokenValid(sc.token)) {
+            writeFrame(sc, "event: auth\ndata: {\"reason\":\"session\"}\n\n");
+            dropClient(i, "oturum geçersiz");
+            continue;
+        }
+        if (!writeFrame(sc, ": ping\n\n")) {
+            dropClient(i, "bağlantı koptu");
+        }
+    }
+}
+
+void processEventStream() {
+    if (subscriberCount == 0) return;
+
+    // Kuyruktan bir parti olay al (kilidi soket yazımı sırasında tutma)
+    PendingEvent batch[EVENT_BATCH_SIZE];
+    unsigned long ids[EVENT_BATCH_SIZE];
+    int batchCount = 0;
+
+    if (xSemaphoreTake(eventMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        while (queueCount > 0 && batchCount < EVENT_BATCH_SIZE) {
+            batch[batchCount].type = eventQueue[queueHead].type;
+            batch[batchCount].data = eventQueue[queueHead].data;
+            eventQueue[queueHead].data = "";
+            ids[batchCount] = ++eventSequence;
+            queueHead = (queueHead + 1) % EVENT_QUEUE_SIZE;
+            queueCount--;
+            batchCount++;
+        }
+        xSemaphoreGive(eventMutex);
+    }
+
+    for (int i = 0; i < batchCount; i++) {
+        broadcastFrame(buildFrame(batch[i].type, ids[i], batch[i].data));
+    }
+
+    sendHeartbeats();
+}
+
+// GET /api/events - EventSource başlık ekleyemediği için jeton query'de gelir
+void handleEventStreamAPI() {
+    String token = server.arg("token");
+    if (token.length() == 0) {
+        token = getRequestToken();
+    }
+
+    if (!isTokenValid(token)) {
+        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+        return;
+    }
+
+    // Boş veya kopmuş bir slot bul
+    int slot = -1;
+    for (int i = 0; i < MAX_STREAM_CLIENTS; i++) {
+        if (streamClients[i].active && !streamClients[i].client.connected()) {
+            dropClient(i, "bağlantı koptu");
+        }
+        if (!streamClients[i].active && slot < 0) {
+            slot = i;
+        }
+    }
+
+    if (slot < 0) {
+        server.send(503, "application/json", "{\"error\":\"Too many event streams\"}");
+        return;
+    }
+
+    // Yanıt başlığını doğrudan yaz; soket kopyası WebServer isteği bitirdikten sonra da açık kalır
+    StreamClient& sc = streamClients[slot];
+    sc.client = server.client();
+    sc.token = token;
+    sc.active = true;
+    subscriberCount++;
+
+    // Başlık ve ilk durum çerçeveleri de engellemeden yazılır; biri bile
+    // yazılamazsa istemci hemen düşürülür (EventSource kendisi yeniden bağlanır)
+    static const char header[] = "HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: text/event-stream\r\n"
+                                 "Cache-Control: no-cache\r\n"
+                                 "Connection: keep-alive\r\n"
+                                 "X-Content-Type-Options: nosniff\r\n"
+                                 "\r\n"
+                                 "retry: 5000\n\n";
+    if (!writeClientNonBlocking(sc.client, header, sizeof(header) - 1)) {
+        dropClient(slot, "başlık yazılamadı");
+        return;
+    }
+
+    // Yeni aboneye mevcut durumu hemen gönder
+    if (!writeFrame(sc, buildFrame(EVT_STATUS, eventSequence, buildStatusJSON()))) {
+        dropClient(slot, "ilk durum yazılamadı");
+        return;
+    }
+
+    String ledJson = getDashboardLedJSON();
+    if (ledJson.length() > 0 && !writeFrame(sc, buildFrame(EVT_LED, eventSequence, ledJson))) {
+        dropClient(slot, "ilk LED durumu yazılamadı");
+        return;
+    }
+
+    WiFiClient& client = sc.client;
+    addLog("📡 Olay akışı açıldı: " + client.remoteIP().toString() +
+           " (" + String(subscriberCount) + " abone)", INFO, "STREAM");
+}
\ No newline at end of file
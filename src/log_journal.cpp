@@ -0,0 +1,504 @@
+// log_journal.cpp - LittleFS üzerinde segmentli, CRC korumalı log günlüğü
+#include "log_journal.h"
+#include <LittleFS.h>
+#include <algorithm>
+#include <stddef.h>
+
+// Disk üzerindeki kayıt başlığı; ardından kaynak adı, mesaj ve (katlanan
+// kayıtlarda) son tekrarın metni gelir.
+// CRC başlığın crc alanı hariç kısmı + kaynak + mesaj + son metin üzerinden hesaplanır.
+struct __attribute__((packed)) JournalRecordHeader {
+    uint16_t magic;
+    uint16_t boot;         // Açılış numarası (günlükteki en büyük + 1)
+    uint32_t seq;
+    uint32_t epoch;
+    uint16_t ms;
+    uint16_t msgLength;
+    uint8_t level;
+    uint8_t sourceLength;
+    uint16_t repeat;       // Kayda katlanan ek tekrar sayısı
+    uint16_t repeatSpan;   // İlk ile son tekrar arası (saniye)
+    uint8_t lastLength;    // Son tekrar metni (mesajın hemen ardında)
+    uint32_t crc;
+};
+
+#define JOURNAL_MAGIC 0x4C49      // Son tekrar metniyle; eski biçim okunmaz
+#define JOURNAL_CHUNK_SIZE 1024
+#define JOURNAL_MESSAGE_BUFFER (LOG_MAX_MESSAGE_LENGTH + LOG_REPEAT_LAST_SIZE)
+
+struct JournalSegment {
+    uint32_t number;
+    size_t size;
+    size_t records;
+    uint16_t levelCounts[LOG_LEVEL_COUNT];     // Filtre indeksi: eşleşmeyen segment okunmaz
+    uint16_t sourceCounts[LOG_MAX_SOURCES];
+    std::vector<uint16_t> offsets;             // Kayıt konumları (eskiden yeniye); açılışta ve yazarken dolar
+    uint16_t lastBoot;                         // En yeni kaydın açılış numarası ve seq'i:
+    uint32_t lastSeq;                          // RAM'deki kayıtlarla çakışma kontrolü
+};
+
+// Segment boyutu 64 KB'ın altında kalmalı: konumlar uint16_t tutulur
+static_assert(JOURNAL_SEGMENT_SIZE + 1024 <= 0xFFFF, "Segment konumu uint16_t'ye sığmıyor");
+
+static void resetSegment(JournalSegment& segment, uint32_t number) {
+    segment.number = number;
+    segment.size = 0;
+    segment.records = 0;
+    memset(segment.levelCounts, 0, sizeof(segment.levelCounts));
+    memset(segment.sourceCounts, 0, sizeof(segment.sourceCounts));
+    segment.offsets.clear();
+    segment.lastBoot = 0;
+    segment.lastSeq = 0;
+}
+
+static std::vector<JournalSegment> segments;   // Eskiden yeniye
+static SemaphoreHandle_t journalMutex = NULL;
+static bool journalReady = false;
+static uint16_t currentBoot = 0;
+static uint32_t lastPersistedSeq = 0;          // Bu açılışta yazılan son kayıt
+static size_t totalRecords = 0;
+static unsigned long lastFlush = 0;
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static String segmentPath(uint32_t number) {
+    char path[32];
+    snprintf(path, sizeof(path), JOURNAL_DIR "/seg_%05lu.log", (unsigned long)number);
+    return String(path);
+}
+
+// Dosyadaki bir sonraki kaydı okur ve doğrular. Yarım yazılmış veya bozuk
+// kayıtta false döner; okuma o segment için orada durur.
+// message en az JOURNAL_MESSAGE_BUFFER bayt; son tekrar metni message + msgLength'te durur
+static bool readRecord(File& file, JournalRecordHeader& header, char* source, char* message) {
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) return false;
+    if (header.magic != JOURNAL_MAGIC || header.msgLength > LOG_MAX_MESSAGE_LENGTH) return false;
+    if (header.lastLength > LOG_REPEAT_LAST_SIZE) return false;
+
+    size_t textLength = header.msgLength + header.lastLength;
+    if (file.read((uint8_t*)source, header.sourceLength) != header.sourceLength) return false;
+    if (file.read((uint8_t*)message, textLength) != textLength) return false;
+
+    uint32_t crc = crc32Update(0, (const uint8_t*)&header, offsetof(JournalRecordHeader, crc));
+    crc = crc32Update(crc, (const uint8_t*)source, header.sourceLength);
+    crc = crc32Update(crc, (const uint8_t*)message, textLength);
+    return crc == header.crc;
+}
+
+// Segmenti baştan tarar (yalnızca açılışta); geçerli kayıt sayısını, açılış
+// numarasını ve segmentin konum indeksi ile seviye/kaynak sayaçlarını döndürür
+static size_t scanSegment(uint32_t number, size_t& validBytes, uint16_t* maxBoot, JournalSegment* counts) {
+    validBytes = 0;
+    File file = LittleFS.open(segmentPath(number), "r");
+    if (!file) return 0;
+
+    JournalRecordHeader header;
+    char source[256];
+    char message[JOURNAL_MESSAGE_BUFFER];
+    size_t records = 0;
+
+    while (true) {
+        size_t position = file.position();
+        if (!readRecord(file, header, source, message)) break;
+        if (maxBoot && header.boot > *maxBoot) *maxBoot = header.boot;
+        if (counts) {
+            counts->offsets.push_back((uint16_t)position);
+            counts->lastBoot = header.boot;
+            counts->lastSeq = header.seq;
+            source[header.sourceLength] = '\0';
+            if (header.level < LOG_LEVEL_COUNT) counts->levelCounts[header.level]++;
+            counts->sourceCounts[internLogSource(String(source))]++;
+        }
+        validBytes = file.position();
+        records++;
+    }
+    file.close();
+    return records;
+}
+
+void initLogJournal() {
+    if (journalMutex == NULL) {
+        journalMutex = xSemaphoreCreateMutex();
+    }
+
+    if (!LittleFS.exists(JOURNAL_DIR)) {
+        LittleFS.mkdir(JOURNAL_DIR);
+    }
+
+    // Mevcut segmentleri bul
+    std::vector<uint32_t> numbers;
+    File root = LittleFS.open(JOURNAL_DIR);
+    File entry = root.openNextFile();
+    while (entry) {
+        String name = entry.name();
+        int slash = name.lastIndexOf('/');
+        if (slash >= 0) name = name.substring(slash + 1);
+        if (name.startsWith("seg_") && name.endsWith(".log")) {
+            numbers.push_back(name.substring(4, name.length() - 4).toInt());
+        }
+        entry = root.openNextFile();
+    }
+    root.close();
+    std::sort(numbers.begin(), numbers.end());
+
+    // Fazla segment varsa eskileri sil
+    while (numbers.size() > JOURNAL_MAX_SEGMENTS) {
+        LittleFS.remove(segmentPath(numbers.front()));
+        numbers.erase(numbers.begin());
+    }
+
+    // Kayıtları doğrula ve say
+    uint16_t maxBoot = 0;
+    bool tornTail = false;
+    segments.clear();
+    totalRecords = 0;
+    for (size_t i = 0; i < numbers.size(); i++) {
+        JournalSegment segment;
+        resetSegment(segment, numbers[i]);
+        segment.records = scanSegment(segment.number, segment.size, &maxBoot, &segment);
+
+        File file = LittleFS.open(segmentPath(segment.number), "r");
+        size_t fileSize = file ? file.size() : 0;
+        if (file) file.close();
+        if (i == numbers.size() - 1 && fileSize > segment.size) {
+            tornTail = true;   // Son yazma yarım kalmış
+        }
+
+        segments.push_back(segment);
+        totalRecords += segment.records;
+    }
+
+    // Yarım kayıttan sonra eklenenler okunamaz; yeni segmente başla
+    if (tornTail || segments.empty()) {
+        JournalSegment segment;
+        resetSegment(segment, segments.empty() ? 1 : segments.back().number + 1);
+        segments.push_back(segment);
+    }
+
+    currentBoot = maxBoot + 1;
+    lastPersistedSeq = 0;
+    lastFlush = millis();
+    journalReady = true;
+
+    addLog("📒 Log günlüğü: " + String(totalRecords) + " kayıt, " + String(segments.size()) +
+           " segment" + (tornTail ? " (yarım kayıt atlandı)" : ""), INFO, "SYSTEM");
+}
+
+// Yeni segment aç, sınırı aşan en eski segmenti sil (journalMutex altında)
+static void rotateSegment() {
+    JournalSegment segment;
+    resetSegment(segment, segments.back().number + 1);
+    segments.push_back(segment);
+
+    while (segments.size() > JOURNAL_MAX_SEGMENTS) {
+        LittleFS.remove(segmentPath(segments.front().number));
+        totalRecords -= segments.front().records;
+        segments.erase(segments.begin());
+    }
+}
+
+static bool writeChunk(const uint8_t* data, size_t length, const JournalSegment& chunkCounts) {
+    if (segments.back().size > 0 && segments.back().size + length > JOURNAL_SEGMENT_SIZE) {
+        rotateSegment();
+    }
+
+    JournalSegment& segment = segments.back();
+    File file = LittleFS.open(segmentPath(segment.number), "a");
+    if (!file) return false;
+    size_t written = file.write(data, length);
+    file.close();
+
+    if (written != length) return false;
+    // Parça içi konumlar segment konumuna çevrilir; sorgular dosyayı taramaz
+    for (uint16_t offset : chunkCounts.offsets) segment.offsets.push_back((uint16_t)(segment.size + offset));
+    segment.lastBoot = chunkCounts.lastBoot;
+    segment.lastSeq = chunkCounts.lastSeq;
+    segment.size += length;
+    segment.records += chunkCounts.records;
+    for (int i = 0; i < LOG_LEVEL_COUNT; i++) segment.levelCounts[i] += chunkCounts.levelCounts[i];
+    for (int i = 0; i < LOG_MAX_SOURCES; i++) segment.sourceCounts[i] += chunkCounts.sourceCounts[i];
+    totalRecords += chunkCounts.records;
+    return true;
+}
+
+// RAM tamponundan uptoSeq'e kadar henüz yazılmamış kayıtları parça parça serileştirir.
+// Tampon kilidi sadece kopyalama sırasında tutulur, dosya yazımı kilitsiz yapılır.
+static void writeJournal(uint32_t uptoSeq) {
+    // addLog kuyruğunda bekleyenler önce tampona geçsin
+    waitForLogSink(200);
+    if (xSemaphoreTake(journalMutex, pdMS_TO_TICKS(2000)) != pdTRUE) return;
+
+    uint8_t* chunk = (uint8_t*)malloc(JOURNAL_CHUNK_SIZE);
+    if (chunk == NULL) {
+        xSemaphoreGive(journalMutex);
+        return;
+    }
+
+    uint32_t fromSeq = lastPersistedSeq + 1;
+    while (true) {
+        size_t used = 0;
+        JournalSegment chunkCounts;
+        resetSegment(chunkCounts, 0);
+        chunkCounts.offsets.reserve(JOURNAL_CHUNK_SIZE / 64);   // Kilit altında büyümesin
+        uint32_t nextSeq = fromSeq;
+
+        logStorage.lock();
+        if (!logStorage.empty()) {
+            uint32_t oldestSeq = logStorage.at(0).seq;
+            // Tampon taşıp yazılamadan düşen kayıtlar atlanır
+            size_t index = (fromSeq > oldestSeq) ? (fromSeq - oldestSeq) : 0;
+
+            for (; index < logStorage.size(); index++) {
+                const LogRecord& record = logStorage.at(index);
+                if (record.seq > uptoSeq) break;
+                const char* source = getLogSourceName(record.source);
+                size_t sourceLength = strlen(source);
+                if (sourceLength > 255) sourceLength = 255;
+
+                size_t lastLength;
+                const char* last = logStorage.lastMessageData(record, lastLength);
+                size_t recordSize = sizeof(JournalRecordHeader) + sourceLength + record.msgLength + lastLength;
+                if (used + recordSize > JOURNAL_CHUNK_SIZE) break;
+
+                JournalRecordHeader header;
+                header.magic = JOURNAL_MAGIC;
+                header.boot = currentBoot;
+                header.seq = record.seq;
+                header.epoch = record.epoch;
+                header.ms = record.ms;
+                header.msgLength = record.msgLength;
+                header.level = record.level;
+                header.sourceLength = (uint8_t)sourceLength;
+                header.repeat = record.repeat;
+                header.repeatSpan = record.repeatSpan;
+                header.lastLength = (uint8_t)lastLength;
+
+                uint32_t crc = crc32Update(0, (const uint8_t*)&header, offsetof(JournalRecordHeader, crc));
+                crc = crc32Update(crc, (const uint8_t*)source, sourceLength);
+                crc = crc32Update(crc, (const uint8_t*)logStorage.messageData(record), record.msgLength);
+                crc = crc32Update(crc, (const uint8_t*)last, lastLength);
+                header.crc = crc;
+
+                chunkCounts.offsets.push_back((uint16_t)used);
+                chunkCounts.lastBoot = currentBoot;
+                chunkCounts.lastSeq = record.seq;
+                memcpy(chunk + used, &header, sizeof(header));
+                memcpy(chunk + used + sizeof(header), source, sourceLength);
+                memcpy(chunk + used + sizeof(header) + sourceLength, logStorage.messageData(record), record.msgLength);
+                if (lastLength > 0) memcpy(chunk + used + sizeof(header) + sourceLength + record.msgLength, last, lastLength);
+                used += recordSize;
+                chunkCounts.records++;
+                chunkCounts.levelCounts[record.level]++;
+                chunkCounts.sourceCounts[record.source]++;
+                nextSeq = record.seq + 1;
+            }
+        }
+        logStorage.unlock();
+
+        if (chunkCounts.records == 0) break;
+        if (!writeChunk(chunk, used, chunkCounts)) break;   // Disk dolu / hata: sonraki turda tekrar dene
+        fromSeq = nextSeq;
+        logStorage.markPersisted(fromSeq - 1);
+    }
+
+    lastPersistedSeq = fromSeq - 1;
+    lastFlush = millis();
+    free(chunk);
+    xSemaphoreGive(journalMutex);
+}
+
+// Zorunlu yazma (yeniden başlatma öncesi): açık tekrar pencereleri beklenmez
+void flushLogJournal() {
+    if (!journalReady) return;
+    writeJournal(UINT32_MAX);
+}
+
+void processLogJournal() {
+    if (!journalReady) return;
+
+    // Tekrar sayacı hâlâ artabilecek kayıtlar pencere kapanana kadar RAM'de bekler
+    uint32_t uptoSeq = logStorage.lastSeq();
+    uint32_t barrier = getLogRepeatBarrier();
+    if (barrier != 0 && barrier - 1 < uptoSeq) uptoSeq = barrier - 1;
+    if (uptoSeq <= lastPersistedSeq) return;
+
+    uint32_t pending = uptoSeq - lastPersistedSeq;
+    if (pending >= JOURNAL_FLUSH_THRESHOLD || millis() - lastFlush >= JOURNAL_FLUSH_INTERVAL) {
+        writeJournal(uptoSeq);
+    }
+}
+
+void clearLogJournal() {
+    if (!journalReady) return;
+    if (xSemaphoreTake(journalMutex, pdMS_TO_TICKS(2000)) != pdTRUE) return;
+
+    for (const auto& segment : segments) {
+        LittleFS.remove(segmentPath(segment.number));
+    }
+
+    uint32_t nextNumber = segments.empty() ? 1 : segments.back().number + 1;
+    segments.clear();
+    JournalSegment segment;
+    resetSegment(segment, nextNumber);
+    segments.push_back(segment);
+    totalRecords = 0;
+
+    // Temizlenen kayıtlar bir sonraki flush'ta tekrar yazılmasın
+    lastPersistedSeq = logStorage.lastSeq();
+    logStorage.markPersisted(lastPersistedSeq);
+
+    xSemaphoreGive(journalMutex);
+}
+
+size_t snapshotJournalSegments(JournalSegmentRef* out, size_t maxCount) {
+    if (!journalReady) return 0;
+    if (xSemaphoreTake(journalMutex, pdMS_TO_TICKS(1000)) != pdTRUE) return 0;
+
+    size_t count = 0;
+    for (const auto& segment : segments) {
+        if (count == maxCount) break;
+        if (segment.size == 0) continue;
+        out[count].number = segment.number;
+        out[count].size = segment.size;
+        count++;
+    }
+
+    xSemaphoreGive(journalMutex);
+    return count;
+}
+
+String getJournalSegmentPath(uint32_t number) {
+    return segmentPath(number);
+}
+
+// RAM'de olmayan günlük kayıtlarının sayısı; segment sayaçlarından toplanır,
+// RAM'de de duran (bu açılışta yazılmış) kayıtlar tampon sayaçlarıyla düşülür.
+// Tek boyutlu filtre: level >= 0 ise sadece seviye, değilse kaynak, ikisi de -1 ise hepsi.
+size_t countJournalHistory(int level, int source) {
+    if (!journalReady) return 0;
+    if (xSemaphoreTake(journalMutex, pdMS_TO_TICKS(1000)) != pdTRUE) return 0;
+
+    size_t total = 0;
+    for (const auto& segment : segments) {
+        if (level >= 0) total += segment.levelCounts[level];
+        else if (source >= 0) total += segment.sourceCounts[source];
+        else total += segment.records;
+    }
+
+    size_t inRam;
+    logStorage.lock();
+    if (level >= 0) inRam = logStorage.persistedLevelCount(level);
+    else if (source >= 0) inRam = logStorage.persistedSourceCount(source);
+    else inRam = logStorage.persistedCount();
+    logStorage.unlock();
+
+    xSemaphoreGive(journalMutex);
+    return total > inRam ? total - inRam : 0;
+}
+
+// Segmentin seçili tek boyutlu filtreye uyan kayıt sayısı; sayaçlar yetmiyorsa -1
+static long segmentMatchCount(const JournalSegment& segment, const LogQuery& query) {
+    if (query.search.length() > 0 || (query.level >= 0 && query.source >= 0)) return -1;
+    if (query.level >= 0) return segment.levelCounts[query.level];
+    if (query.source >= 0) return segment.sourceCounts[query.source];
+    return (long)segment.records;
+}
+
+size_t queryJournalHistory(const LogQuery& query, size_t skip, size_t maxCount, std::vector<LogEntry>& out, bool countAll, bool* partial) {
+    if (partial) *partial = false;
+    if (!journalReady || (maxCount == 0 && !countAll)) return 0;
+    if (xSemaphoreTake(journalMutex, pdMS_TO_TICKS(1000)) != pdTRUE) return 0;
+
+    // Bu açılışın RAM'de hâlâ duran kayıtları zaten RAM tarafında listelendi
+    logStorage.lock();
+    bool ramEmpty = logStorage.empty();
+    uint32_t ramOldestSeq = ramEmpty ? 0 : logStorage.at(0).seq;
+    logStorage.unlock();
+
+    size_t matches = 0;
+    size_t added = 0;
+    size_t scanned = 0;
+    JournalRecordHeader header;
+    char source[256];
+    char* message = (char*)malloc(JOURNAL_MESSAGE_BUFFER + 1);
+
+    for (int s = (int)segments.size() - 1; s >= 0 && message != NULL; s--) {
+        if (!countAll && added >= maxCount) break;
+
+        // Segment sayaçları eşleşme olmadığını söylüyorsa dosyayı hiç açma
+        const JournalSegment& segment = segments[s];
+        if (segment.records == 0) continue;
+        if (query.level >= 0 && segment.levelCounts[query.level] == 0) continue;
+        if (query.source >= 0 && segment.sourceCounts[query.source] == 0) continue;
+
+        // RAM'de de duran kayıt içermeyen segmentte sayaçlar kesindir: atlanacak
+        // eşleşmeler segmenti tamamen kapsıyorsa dosya açılmaz
+        bool overlapsRam = segment.lastBoot == currentBoot && !ramEmpty && segment.lastSeq >= ramOldestSeq;
+        long segmentMatches = overlapsRam ? -1 : segmentMatchCount(segment, query);
+        if (segmentMatches >= 0 && matches + segmentMatches <= skip) {
+            matches += segmentMatches;
+            continue;
+        }
+
+        // Konum indeksi RAM'de: en yeniden geriye doğrudan okunur. Filtresiz
+        // sorguda segment içindeki atlama da konumla yapılır.
+        const std::vector<uint16_t>& offsets = segment.offsets;
+        int i = (int)offsets.size() - 1;
+        if (segmentMatches >= 0 && query.level < 0 && query.source < 0 && matches < skip) {
+            i -= (int)(skip - matches);
+            matches = skip;
+        }
+
+        File file = LittleFS.open(segmentPath(segment.number), "r");
+        if (!file) continue;
+
+        for (; i >= 0; i--) {
+            // İstek başına okuma sınırı: arama tüm günlüğü taramaz
+            if (scanned >= JOURNAL_QUERY_SCAN_LIMIT) {
+                if (partial) *partial = true;
+                break;
+            }
+            scanned++;
+            file.seek(offsets[i]);
+            if (!readRecord(file, header, source, message)) continue;
+            if (header.boot == currentBoot && !ramEmpty && header.seq >= ramOldestSeq) continue;
+
+            source[header.sourceLength] = '\0';
+            uint8_t sourceId = internLogSource(String(source));
+            if (!logMatchesQuery(query, header.level, sourceId, message, header.msgLength)) continue;
+
+            if (matches >= skip && added < maxCount) {
+                LogEntry entry;
+                entry.seq = header.seq;
+                entry.epoch = header.epoch;
+                entry.ms = header.ms;
+                entry.level = (LogLevel)header.level;
+                entry.source = sourceId;
+                entry.repeat = header.repeat;
+                entry.lastEpoch = header.epoch + header.repeatSpan;
+                entry.message.reserve(header.msgLength);
+                entry.message.concat(message, header.msgLength);
+                entry.lastMessage.concat(message + header.msgLength, header.lastLength);
+                out.push_back(entry);
+                added++;
+            }
+            matches++;
+            if (!countAll && added >= maxCount) break;
+        }
+        file.close();
+        if (scanned >= JOURNAL_QUERY_SCAN_LIMIT) break;
+    }
+
+    free(message);
+    xSemaphoreGive(journalMutex);
+    return matches;
+}
\ No newline at end of file
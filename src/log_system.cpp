@@ -1,10 +1,442 @@
 #include "log_system.h"
+#include "event_stream.h"
+#include "data_version.h"
+#include "log_journal.h"
+#include "notification_feed.h"
 #include <time.h>
+#include <sys/time.h>
+#include <atomic>
+#include <stdarg.h>
 
 // Global değişkenlerin tanımlamaları
-std::vector<LogEntry> logStorage;
-const int MAX_LOG_SIZE = 500;  // Maksimum 500 log kaydı tutulacak
-const int PAGE_SIZE = 50;      // Sayfa başına 50 kayıt
+// Kayıt başına 24 bayt + ortalama mesaj uzunluğu; eski 500 String kaydın
+// kapladığı bellekle yaklaşık 2000 kayıt tutulur.
+const int MAX_LOG_SIZE = 2000;       // Maksimum kayıt sayısı
+const int LOG_ARENA_SIZE = 40960;    // Mesaj arenası (uint16 ofset sınırı altında)
+const int PAGE_SIZE = 50;            // Sayfa başına 50 kayıt
+LogRingBuffer logStorage(MAX_LOG_SIZE, LOG_ARENA_SIZE);
+
+// Kaynak adı tablosu - son slot taşma durumunda ortak kullanılır
+static String sourceNames[LOG_MAX_SOURCES];
+static uint8_t sourceCount = 0;
+
+// --- LogRingBuffer ---
+
+LogRingBuffer::LogRingBuffer(size_t capacity, size_t arenaBytes)
+    : records(NULL), arena(NULL), recordCapacity(capacity), arenaSize(arenaBytes),
+      head(0), count(0), arenaHead(0), nextSeq(1), persistedSeq(0), mutex(NULL) {
+    resetIndex();
+    records = (LogRecord*)malloc(sizeof(LogRecord) * capacity);
+    arena = (char*)malloc(arenaBytes);
+    if (records == NULL || arena == NULL) {
+        // Bellek yoksa tampon devre dışı kalır; addLog sessizce düşer
+        free(records);
+        free(arena);
+        records = NULL;
+        arena = NULL;
+        recordCapacity = 1;
+        arenaSize = 0;
+    }
+}
+
+void LogRingBuffer::lock() const {
+    // Kilit ilk kullanımda oluşturulur (global nesne FreeRTOS'tan önce kurulur)
+    if (mutex == NULL) {
+        mutex = xSemaphoreCreateRecursiveMutex();
+    }
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+}
+
+void LogRingBuffer::unlock() const {
+    if (mutex != NULL) {
+        xSemaphoreGiveRecursive(mutex);
+    }
+}
+
+void LogRingBuffer::dropOldest() {
+    if (count == 0) return;
+
+    const LogRecord& oldest = at(0);
+    levelCounts[oldest.level]--;
+    sourceCounts[oldest.source]--;
+    if (oldest.seq <= persistedSeq) {
+        persistedTotal--;
+        persistedLevelCounts[oldest.level]--;
+        persistedSourceCounts[oldest.source]--;
+    }
+
+    count--;
+    if (count == 0) arenaHead = 0;
+}
+
+// Bağlantı hedefi hâlâ canlı mı? Üzerine yazılan slot daha yeni bir seq taşır,
+// düşürülen slot ise en eski kaydın seq'inden küçük kalır.
+bool LogRingBuffer::liveLink(uint16_t slot, uint32_t newerThan) const {
+    if (slot == LOG_NO_SLOT || count == 0) return false;
+    uint32_t seq = records[slot].seq;
+    return seq < newerThan && seq >= at(0).seq;
+}
+
+uint16_t LogRingBuffer::newestSlotForLevel(uint8_t level) const {
+    if (level >= LOG_LEVEL_COUNT) return LOG_NO_SLOT;
+    uint16_t slot = levelHead[level];
+    if (!liveLink(slot, nextSeq) || records[slot].level != level) return LOG_NO_SLOT;
+    return slot;
+}
+
+uint16_t LogRingBuffer::newestSlotForSource(uint8_t source) const {
+    if (source >= LOG_MAX_SOURCES) return LOG_NO_SLOT;
+    uint16_t slot = sourceHead[source];
+    if (!liveLink(slot, nextSeq) || records[slot].source != source) return LOG_NO_SLOT;
+    return slot;
+}
+
+uint16_t LogRingBuffer::previousSlot(uint16_t slot, bool byLevel) const {
+    const LogRecord& record = records[slot];
+    uint16_t prev = byLevel ? record.prevSameLevel : record.prevSameSource;
+    return liveLink(prev, record.seq) ? prev : LOG_NO_SLOT;
+}
+
+// Günlüğe yazılan aralığı işaretle: bu kayıtlar RAM'den düşene kadar
+// günlük tarafında çift sayılmamaları için ayrı sayaçlarda tutulur.
+void LogRingBuffer::markPersisted(uint32_t uptoSeq) {
+    lock();
+    for (size_t i = 0; i < count; i++) {
+        const LogRecord& record = at(i);
+        if (record.seq <= persistedSeq) continue;
+        if (record.seq > uptoSeq) break;
+        persistedTotal++;
+        persistedLevelCounts[record.level]++;
+        persistedSourceCounts[record.source]++;
+    }
+    if (uptoSeq > persistedSeq) persistedSeq = uptoSeq;
+    unlock();
+}
+
+// Mesaj baytları arenaya kayıtlarla aynı FIFO sırasında ve bölünmeden yazılır.
+// Sona sığmayan mesaj başa sarar; yer açılana kadar en eski kayıtlar düşürülür.
+bool LogRingBuffer::reserveArena(size_t length, size_t& offset) {
+    if (length > arenaSize) return false;
+
+    while (true) {
+        size_t tail = (count > 0) ? at(0).msgOffset : 0;
+
+        if (count == 0 || arenaHead >= tail) {
+            // Veri [tail, arenaHead) aralığında: önce sona, olmazsa başa yaz
+            if (arenaHead + length <= arenaSize) {
+                offset = arenaHead;
+                arenaHead += length;
+                return true;
+            }
+            if (length < tail) {
+                offset = 0;
+                arenaHead = length;
+                return true;
+            }
+        } else if (arenaHead + length < tail) {
+            // Sarılmış durum: boşluk [arenaHead, tail) arasında
+            offset = arenaHead;
+            arenaHead += length;
+            return true;
+        }
+
+        if (count == 0) return false;
+        dropOldest();
+    }
+}
+
+uint32_t LogRingBuffer::push(uint32_t epoch, uint16_t ms, LogLevel level, uint8_t source, const char* msg, size_t length) {
+    if (length > LOG_MAX_MESSAGE_LENGTH) {
+        length = LOG_MAX_MESSAGE_LENGTH;
+        // UTF-8 karakterini ortasından bölme
+        while (length > 0 && (msg[length] & 0xC0) == 0x80) length--;
+    }
+
+    lock();
+    if (records == NULL) {
+        unlock();
+        return 0;
+    }
+
+    if (count == recordCapacity) dropOldest();
+
+    size_t offset = 0;
+    if (!reserveArena(length, offset)) {
+        offset = arenaHead;
+        length = 0;
+    }
+    if (length > 0) memcpy(arena + offset, msg, length);
+
+    if (source >= LOG_MAX_SOURCES) source = LOG_MAX_SOURCES - 1;
+    if ((uint8_t)level >= LOG_LEVEL_COUNT) level = INFO;
+
+    // Zincir bağlantıları slot üzerine yazılmadan önce alınır
+    uint16_t slot = (uint16_t)head;
+    uint16_t prevLevel = levelHead[level];
+    uint16_t prevSource = sourceHead[source];
+
+    LogRecord& record = records[slot];
+    record.epoch = epoch;
+    record.seq = nextSeq++;
+    record.ms = ms;
+    record.msgOffset = (uint16_t)offset;
+    record.msgLength = (uint16_t)length;
+    record.level = (uint8_t)level;
+    record.source = source;
+    record.prevSameLevel = prevLevel;
+    record.prevSameSource = prevSource;
+    record.repeat = 0;
+    record.repeatSpan = 0;
+
+    levelHead[level] = slot;
+    sourceHead[source] = slot;
+    levelCounts[level]++;
+    sourceCounts[source]++;
+
+    head = (head + 1) % recordCapacity;
+    count++;
+    uint32_t seq = record.seq;
+    unlock();
+    return seq;
+}
+
+// Tekrar penceresinde bastırılan olayları ilk kayda işler
+bool LogRingBuffer::addRepeats(uint32_t seq, uint16_t repeats, uint32_t lastEpoch, const char* last, size_t lastLength) {
+    lock();
+    if (count == 0 || seq < at(0).seq || seq > lastSeq()) {
+        unlock();
+        return false;
+    }
+
+    LogRecord& record = records[(head + recordCapacity - count + (seq - at(0).seq)) % recordCapacity];
+    uint32_t total = (uint32_t)record.repeat + repeats;
+    record.repeat = total > 0xFFFF ? 0xFFFF : total;
+    if (lastEpoch >= record.epoch) {
+        uint32_t span = lastEpoch - record.epoch;
+        record.repeatSpan = span > 0xFFFF ? 0xFFFF : span;
+    }
+
+    if (last != NULL && lastLength > 0) {
+        RepeatText* text = NULL;
+        for (int i = 0; i < LOG_REPEAT_SLOTS; i++) {
+            if (repeatTexts[i].seq == seq) {
+                text = &repeatTexts[i];
+                break;
+            }
+        }
+        if (text == NULL) {
+            text = &repeatTexts[repeatTextNext];
+            repeatTextNext = (repeatTextNext + 1) % LOG_REPEAT_SLOTS;
+        }
+        if (lastLength > LOG_REPEAT_LAST_SIZE) lastLength = LOG_REPEAT_LAST_SIZE;
+        text->seq = seq;
+        text->length = (uint8_t)lastLength;
+        memcpy(text->text, last, lastLength);
+    }
+    unlock();
+    return true;
+}
+
+const char* LogRingBuffer::lastMessageData(const LogRecord& record, size_t& length) const {
+    length = 0;
+    if (record.repeat == 0) return NULL;
+    for (int i = 0; i < LOG_REPEAT_SLOTS; i++) {
+        if (repeatTexts[i].seq == record.seq) {
+            length = repeatTexts[i].length;
+            return repeatTexts[i].text;
+        }
+    }
+    return NULL;
+}
+
+void LogRingBuffer::clear() {
+    // Sıra numarası sıfırlanmaz; istemci imleçleri geçerli kalır
+    lock();
+    resetIndex();
+    unlock();
+}
+
+void LogRingBuffer::resetIndex() {
+    head = 0;
+    count = 0;
+    arenaHead = 0;
+    persistedTotal = 0;
+    memset(repeatTexts, 0, sizeof(repeatTexts));
+    repeatTextNext = 0;
+    for (int i = 0; i < LOG_LEVEL_COUNT; i++) {
+        levelHead[i] = LOG_NO_SLOT;
+        levelCounts[i] = 0;
+        persistedLevelCounts[i] = 0;
+    }
+    for (int i = 0; i < LOG_MAX_SOURCES; i++) {
+        sourceHead[i] = LOG_NO_SLOT;
+        sourceCounts[i] = 0;
+        persistedSourceCounts[i] = 0;
+    }
+}
+
+String LogRingBuffer::messageOf(const LogRecord& record) const {
+    String message;
+    message.reserve(record.msgLength);
+    message.concat(arena + record.msgOffset, record.msgLength);
+    return message;
+}
+
+LogEntry LogRingBuffer::entryOf(const LogRecord& record) const {
+    LogEntry entry;
+    entry.seq = record.seq;
+    entry.epoch = record.epoch;
+    entry.ms = record.ms;
+    entry.level = (LogLevel)record.level;
+    entry.source = record.source;
+    entry.repeat = record.repeat;
+    entry.lastEpoch = record.epoch + record.repeatSpan;
+    entry.message = messageOf(record);
+    size_t lastLength;
+    const char* last = lastMessageData(record, lastLength);
+    if (last != NULL) entry.lastMessage.concat(last, lastLength);
+    return entry;
+}
+
+// --- Kaynak tablosu ---
+
+uint8_t internLogSource(const String& name) {
+    LogReadLock guard(logStorage);
+
+    for (uint8_t i = 0; i < sourceCount; i++) {
+        if (sourceNames[i] == name) return i;
+    }
+
+    // Tablo dolduysa son slot ortak "OTHER" kaynağıdır
+    if (sourceCount >= LOG_MAX_SOURCES - 1) {
+        sourceNames[LOG_MAX_SOURCES - 1] = "OTHER";
+        return LOG_MAX_SOURCES - 1;
+    }
+
+    sourceNames[sourceCount] = name;
+    return sourceCount++;
+}
+
+int findLogSource(const String& name) {
+    LogReadLock guard(logStorage);
+    for (uint8_t i = 0; i < sourceCount; i++) {
+        if (sourceNames[i] == name) return i;
+    }
+    return -1;
+}
+
+int getLogSourceCount() {
+    return sourceCount;
+}
+
+const char* getLogSourceName(uint8_t id) {
+    if (id < LOG_MAX_SOURCES && sourceNames[id].length() > 0) {
+        return sourceNames[id].c_str();
+    }
+    return "OTHER";
+}
+
+// --- Zaman damgası metni ---
+// localtime_r + strftime her kayıt için pahalıdır. Saat başı öneki
+// ("dd.mm.yyyy HH:") bir kez üretilir, dakika/saniye aritmetikle eklenir
+// (sistem saati yerel saat olarak tutulur, ofset tam saattir).
+// Geçerli saniyenin metni ayrıca çift tamponda saklanır; okuyucu beklemez.
+
+#define TIMESTAMP_TEXT_SIZE 24
+
+struct HourPrefix {
+    uint32_t hourStart;
+    char text[16];
+};
+
+struct ClockText {
+    uint32_t second;
+    char text[TIMESTAMP_TEXT_SIZE];
+};
+
+static HourPrefix hourPrefix = { UINT32_MAX, "" };
+static ClockText clockTexts[2] = { { UINT32_MAX, "" }, { UINT32_MAX, "" } };
+static std::atomic<uint8_t> clockActive(0);
+static portMUX_TYPE clockMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void captureLogTime(uint32_t& epoch, uint16_t& ms);
+
+static void formatTimestampInto(uint32_t epoch, char* out, size_t size) {
+    if (epoch < LOG_EPOCH_VALID_MIN) {
+        // Senkron öncesi kayıtlar: açılıştan beri geçen süre
+        unsigned long seconds = epoch;
+        unsigned long minutes = seconds / 60;
+        unsigned long hours = minutes / 60;
+        snprintf(out, size, "%02lu:%02lu:%02lu", hours % 24, minutes % 60, seconds % 60);
+        return;
+    }
+
+    uint32_t hourStart = epoch - epoch % 3600;
+    char prefix[sizeof(hourPrefix.text)];
+
+    portENTER_CRITICAL(&clockMux);
+    bool cached = (hourPrefix.hourStart == hourStart);
+    if (cached) memcpy(prefix, hourPrefix.text, sizeof(prefix));
+    portEXIT_CRITICAL(&clockMux);
+
+    if (!cached) {
+        time_t t = (time_t)hourStart;
+        struct tm timeinfo;
+        localtime_r(&t, &timeinfo);
+        strftime(prefix, sizeof(prefix), "%d.%m.%Y %H:", &timeinfo);
+
+        portENTER_CRITICAL(&clockMux);
+        hourPrefix.hourStart = hourStart;
+        memcpy(hourPrefix.text, prefix, sizeof(prefix));
+        portEXIT_CRITICAL(&clockMux);
+    }
+
+    snprintf(out, size, "%s%02lu:%02lu", prefix, (unsigned long)(epoch / 60 % 60), (unsigned long)(epoch % 60));
+}
+
+// Kayıttaki sayısal zamanı gösterim formatına çevirir
+String formatLogTimestamp(uint32_t epoch) {
+    char buffer[TIMESTAMP_TEXT_SIZE];
+    formatTimestampInto(epoch, buffer, sizeof(buffer));
+    return String(buffer);
+}
+
+// Geçerli saniyenin metni. Saniye değiştiyse boştaki tampona yazılıp
+// etkin tampon çevrilir; dönen işaretçi en az bir sonraki saniyeye kadar geçerlidir.
+const char* getCurrentTimestamp() {
+    uint32_t epoch;
+    uint16_t ms;
+    captureLogTime(epoch, ms);
+
+    uint8_t active = clockActive.load(std::memory_order_acquire);
+    if (clockTexts[active].second == epoch) {
+        return clockTexts[active].text;
+    }
+
+    char text[TIMESTAMP_TEXT_SIZE];
+    formatTimestampInto(epoch, text, sizeof(text));
+
+    portENTER_CRITICAL(&clockMux);
+    active = clockActive.load(std::memory_order_relaxed);
+    if (clockTexts[active].second != epoch) {
+        active ^= 1;
+        clockTexts[active].second = epoch;
+        memcpy(clockTexts[active].text, text, sizeof(text));
+        clockActive.store(active, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&clockMux);
+    return clockTexts[active].text;
+}
+
+// Sistem saati ayarlandığında önbellekleri yeni saate göre hemen tazele
+void refreshClockCache() {
+    portENTER_CRITICAL(&clockMux);
+    hourPrefix.hourStart = UINT32_MAX;
+    clockTexts[0].second = UINT32_MAX;
+    clockTexts[1].second = UINT32_MAX;
+    portEXIT_CRITICAL(&clockMux);
+    getCurrentTimestamp();
+}
 
 // NTP'den geçerli zaman alınamazsa kullanılacak zaman formatı
 String getFormattedTimestampFallback() {
@@ -20,56 +452,505 @@ String getFormattedTimestampFallback() {
     return String(buffer);
 }
 
-// NTP'den veya sistemden zamanı alıp formatlayan ana fonksiyon
+// Sistem saatinin metni - saat senkron değilse açılıştan beri geçen süre.
+// Önbellekten gelir; getLocalTime beklemesi ve kayıt başına strftime yoktur.
 String getFormattedTimestamp() {
-    struct tm timeinfo;
-    // getLocalTime'a bir timeout parametresi ekleyerek takılmayı önle
-    if (getLocalTime(&timeinfo, 10)) { // 10 milisaniye bekle
-        char buffer[32];
-        strftime(buffer, sizeof(buffer), "%d.%m.%Y %H:%M:%S", &timeinfo);
-        return String(buffer);
+    return String(getCurrentTimestamp());
+}
+
+// --- Log kuyruğu (çok üretici / tek tüketici, kilitsiz) ---
+// addLog sadece zamanı yakalar, kaynak+mesajı önceden ayrılmış hücre belleğine
+// kopyalar ve kuyruğa ekler; üretici heap'e hiç dokunmaz. Depolama, push kanalı
+// ve seri konsol sink task'ında yapılır.
+// Sınırlı halka kuyruk: her hücrenin sıra sayacı, hücrenin yazılabilir mi
+// okunabilir mi olduğunu belirtir; üreticiler konumu CAS ile ayırır.
+// Kısa mesajlar hücrenin kendi tamponuna sığar. Uzunlar için küçük bir büyük
+// blok havuzu vardır (atomik doluluk maskesi); havuz da doluysa mesaj hücre
+// tamponunda UTF-8 sınırından kırpılır.
+
+#define LOG_QUEUE_CELL_BYTES   96                                      // Hücre içi "kaynak"+"mesaj"
+#define LOG_QUEUE_LARGE_BLOCKS 8                                       // Büyük blok havuzu (<= 32)
+#define LOG_QUEUE_LARGE_BYTES  (255 + LOG_MAX_MESSAGE_LENGTH + 2)      // En uzun kaynak + mesaj + kırpma baytı + '\0'
+#define LOG_QUEUE_INLINE       0xFF                                    // largeBlock: hücre içi
+
+struct LogQueueCell {
+    std::atomic<uint32_t> sequence;
+    uint32_t epoch;
+    uint16_t ms;
+    uint8_t level;
+    uint8_t sourceLength;
+    uint16_t msgLength;
+    uint8_t largeBlock;    // Büyük blok numarası veya LOG_QUEUE_INLINE
+    uint32_t fingerprint;  // Tekrar tablosu anahtarı (0: izlenmiyor)
+    char data[LOG_QUEUE_CELL_BYTES];   // "kaynak" + "mesaj" (sonlandırıcısız)
+};
+
+static char logLargeBlocks[LOG_QUEUE_LARGE_BLOCKS][LOG_QUEUE_LARGE_BYTES];
+static std::atomic<uint32_t> logLargeUsed(0);   // Bit i: blok i dolu
+
+static_assert(LOG_QUEUE_LARGE_BLOCKS <= 32, "Büyük blok maskesi 32 bit");
+
+// Boş büyük blok ayır; yoksa LOG_QUEUE_INLINE
+static uint8_t claimLargeBlock() {
+    uint32_t used = logLargeUsed.load(std::memory_order_relaxed);
+    while (true) {
+        uint32_t freeBits = ~used & ((LOG_QUEUE_LARGE_BLOCKS == 32) ? 0xFFFFFFFFUL : ((1UL << LOG_QUEUE_LARGE_BLOCKS) - 1));
+        if (freeBits == 0) return LOG_QUEUE_INLINE;
+        uint8_t block = __builtin_ctz(freeBits);
+        if (logLargeUsed.compare_exchange_weak(used, used | (1UL << block), std::memory_order_acquire)) return block;
+    }
+}
+
+static void releaseLargeBlock(uint8_t block) {
+    if (block == LOG_QUEUE_INLINE) return;
+    logLargeUsed.fetch_and(~(1UL << block), std::memory_order_release);
+}
+
+class LogQueue {
+public:
+    LogQueue() : enqueuePos(0), dequeuePos(0) {
+        for (uint32_t i = 0; i < LOG_QUEUE_SIZE; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Kaynak ve mesaj, konum ayrıldıktan sonra hücreye (veya büyük bloğa) kopyalanır.
+    // filledBlock: çağıranın önceden doldurduğu büyük blok (kopya yapılmaz);
+    // push başarısızsa blok çağırana aittir.
+    bool push(uint32_t epoch, uint16_t ms, uint8_t level, const char* source, uint8_t sourceLength,
+              const char* msg, uint16_t msgLength, uint32_t fingerprint, uint8_t filledBlock = LOG_QUEUE_INLINE) {
+        LogQueueCell* cell;
+        uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & (LOG_QUEUE_SIZE - 1)];
+            uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;   // Kuyruk dolu
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->largeBlock = filledBlock;
+        if (filledBlock == LOG_QUEUE_INLINE) {
+            char* data = cell->data;
+            if ((size_t)sourceLength + msgLength > LOG_QUEUE_CELL_BYTES) {
+                cell->largeBlock = claimLargeBlock();
+                if (cell->largeBlock != LOG_QUEUE_INLINE) {
+                    data = logLargeBlocks[cell->largeBlock];
+                } else {
+                    // Havuz dolu: hücreye sığan kadarı, UTF-8 karakteri bölünmeden
+                    if (sourceLength > LOG_QUEUE_CELL_BYTES / 2) sourceLength = LOG_QUEUE_CELL_BYTES / 2;
+                    if (msgLength > LOG_QUEUE_CELL_BYTES - sourceLength) {
+                        msgLength = LOG_QUEUE_CELL_BYTES - sourceLength;
+                        while (msgLength > 0 && (msg[msgLength] & 0xC0) == 0x80) msgLength--;
+                    }
+                }
+            }
+            if (sourceLength > 0) memcpy(data, source, sourceLength);
+            if (msgLength > 0) memcpy(data + sourceLength, msg, msgLength);
+        }
+        cell->epoch = epoch;
+        cell->ms = ms;
+        cell->level = level;
+        cell->sourceLength = sourceLength;
+        cell->msgLength = msgLength;
+        cell->fingerprint = fingerprint;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Sadece sink task'ı çağırır. Hücre, release() çağrılana kadar sink'e aittir;
+    // veri kopyalanmadan yerinde okunur.
+    LogQueueCell* front() {
+        LogQueueCell& cell = cells[dequeuePos & (LOG_QUEUE_SIZE - 1)];
+        uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+        if ((int32_t)(seq - (dequeuePos + 1)) < 0) return NULL;
+        return &cell;
+    }
+
+    const char* dataOf(const LogQueueCell& cell) const {
+        return cell.largeBlock != LOG_QUEUE_INLINE ? logLargeBlocks[cell.largeBlock] : cell.data;
+    }
+
+    void release(LogQueueCell& cell) {
+        releaseLargeBlock(cell.largeBlock);
+        cell.largeBlock = LOG_QUEUE_INLINE;
+        cell.sequence.store(dequeuePos + LOG_QUEUE_SIZE, std::memory_order_release);
+        dequeuePos++;
+    }
+
+    bool empty() const {
+        return enqueuePos.load(std::memory_order_acquire) == dequeuePos;
+    }
+
+private:
+    LogQueueCell cells[LOG_QUEUE_SIZE];
+    std::atomic<uint32_t> enqueuePos;
+    uint32_t dequeuePos;
+};
+
+#define LOG_CLEAR_MARKER 0xFF    // Kuyruktaki sırasıyla uygulanan temizleme komutu
+
+static LogQueue logQueue;
+static std::atomic<uint32_t> droppedLogs(0);
+static std::atomic<uint32_t> appliedClears(0);   // Sink'in uyguladığı temizleme sayısı
+static uint32_t requestedClears = 0;              // Kuyruğa giren temizleme sayısı (sadece clearLogs)
+static TaskHandle_t logSinkHandle = NULL;
+
+// Zamanı sayı olarak yakala; metne çevirme gösterim anına bırakılır
+static void captureLogTime(uint32_t& epoch, uint16_t& ms) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if ((unsigned long)tv.tv_sec >= LOG_EPOCH_VALID_MIN) {
+        epoch = (uint32_t)tv.tv_sec;
+        ms = (uint16_t)(tv.tv_usec / 1000);
     } else {
-        // NTP senkronize değilse, millis() kullan
-        return getFormattedTimestampFallback();
+        unsigned long now = millis();
+        epoch = now / 1000;
+        ms = now % 1000;
+    }
+}
+
+// --- Tekrar birleştirme ---
+// Aynı (kaynak, seviye, mesaj şablonu) pencere içinde tekrar gelirse üretici
+// kuyruğa hiçbir şey eklemez, sadece slot sayacını ve son metni günceller. Sink
+// ilk kaydın seq'ini slota bağlar ve biriken tekrarları periyodik olarak o kayda
+// işler: kayıt ilk olayın metnini, yan tablo son tekrarın metnini taşır.
+// Slotları sadece sink boşaltır; dolu slota çakışan mesaj birleştirilmeden geçer.
+
+struct LogRepeatSlot {
+    uint32_t fingerprint;      // 0: boş
+    uint32_t seq;              // Tampondaki ilk kayıt (sink bağlayana kadar 0)
+    unsigned long windowStart;
+    uint32_t lastEpoch;
+    uint16_t pending;          // Henüz kayda işlenmemiş tekrarlar
+    uint8_t lastLength;
+    char last[LOG_REPEAT_LAST_SIZE];   // Son tekrarın metni (kırpılmış)
+};
+
+static LogRepeatSlot repeatSlots[LOG_REPEAT_SLOTS];
+static portMUX_TYPE repeatMux = portMUX_INITIALIZER_UNLOCKED;
+
+// FNV-1a: kaynak + seviye + mesaj şablonu. addLogf'te şablon biçim dizesinin
+// kendisidir; addLog'da hazır metindeki rakam dizileri tek '#' sayılır.
+// Değerleri farklı olaylar katlanır, ilk ve son değer kayıtta görünür kalır.
+static uint32_t fingerprintUpdate(uint32_t hash, const char* data, size_t length, bool maskDigits) {
+    bool inNumber = false;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = (uint8_t)data[i];
+        if (maskDigits && c >= '0' && c <= '9') {
+            if (inNumber) continue;
+            inNumber = true;
+            c = '#';
+        } else {
+            inNumber = false;
+        }
+        hash ^= c;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t logFingerprint(LogLevel level, const char* source, size_t sourceLength, const char* text, size_t textLength, bool maskDigits) {
+    char separator[2] = { (char)('0' + level), '\x1f' };
+    uint32_t hash = fingerprintUpdate(2166136261UL, source, sourceLength, false);
+    hash = fingerprintUpdate(hash, separator, sizeof(separator), false);
+    hash = fingerprintUpdate(hash, text, textLength, maskDigits);
+    return hash != 0 ? hash : 1;
+}
+
+// Son tekrar metninden saklanacak uzunluk (UTF-8 karakteri bölünmez)
+static size_t repeatTextLength(const char* text, size_t length) {
+    if (length <= LOG_REPEAT_LAST_SIZE) return length;
+    length = LOG_REPEAT_LAST_SIZE;
+    while (length > 0 && (text[length] & 0xC0) == 0x80) length--;
+    return length;
+}
+
+// Üretici tarafı: açık pencerede tekrar ise true (kayıt bastırılır, metni slota yazılır)
+static bool suppressRepeat(uint32_t fingerprint, uint32_t epoch, const char* text, size_t textLength) {
+    size_t lastLength = repeatTextLength(text, textLength);
+    LogRepeatSlot& slot = repeatSlots[fingerprint % LOG_REPEAT_SLOTS];
+    bool suppressed = false;
+
+    portENTER_CRITICAL(&repeatMux);
+    if (slot.fingerprint == 0) {
+        slot.fingerprint = fingerprint;
+        slot.seq = 0;
+        slot.windowStart = millis();
+        slot.lastEpoch = epoch;
+        slot.pending = 0;
+        slot.lastLength = 0;
+    } else if (slot.fingerprint == fingerprint && millis() - slot.windowStart < LOG_REPEAT_WINDOW) {
+        if (slot.pending < 0xFFFF) slot.pending++;
+        slot.lastEpoch = epoch;
+        slot.lastLength = (uint8_t)lastLength;
+        memcpy(slot.last, text, lastLength);
+        suppressed = true;
+    }
+    portEXIT_CRITICAL(&repeatMux);
+    return suppressed;
+}
+
+// Sink tarafı: pencereyi açan kaydın seq'ini slota bağla
+static void bindRepeatSlot(uint32_t fingerprint, uint32_t seq) {
+    LogRepeatSlot& slot = repeatSlots[fingerprint % LOG_REPEAT_SLOTS];
+    portENTER_CRITICAL(&repeatMux);
+    if (slot.fingerprint == fingerprint && slot.seq == 0) {
+        slot.seq = seq;
+    }
+    portEXIT_CRITICAL(&repeatMux);
+}
+
+// Sink tarafı: biriken tekrarları kayıtlara işle, süresi dolan slotları boşalt
+static void applyLogRepeats() {
+    bool changed = false;
+    unsigned long now = millis();
+    char last[LOG_REPEAT_LAST_SIZE];
+
+    for (int i = 0; i < LOG_REPEAT_SLOTS; i++) {
+        LogRepeatSlot& slot = repeatSlots[i];
+
+        portENTER_CRITICAL(&repeatMux);
+        if (slot.fingerprint == 0) {
+            portEXIT_CRITICAL(&repeatMux);
+            continue;
+        }
+        uint32_t seq = slot.seq;
+        uint16_t pending = seq != 0 ? slot.pending : 0;
+        uint32_t lastEpoch = slot.lastEpoch;
+        size_t lastLength = pending > 0 ? slot.lastLength : 0;
+        memcpy(last, slot.last, lastLength);
+        if (seq != 0) slot.pending = 0;
+        // seq hâlâ 0 ise ilk kayıt kuyruk dolduğu için düşmüştür
+        if (now - slot.windowStart >= LOG_REPEAT_WINDOW) slot.fingerprint = 0;
+        portEXIT_CRITICAL(&repeatMux);
+
+        if (pending > 0 && logStorage.addRepeats(seq, pending, lastEpoch, last, lastLength)) {
+            changed = true;
+        }
+    }
+
+    if (changed) bumpDataVersion(DATA_LOGS);
+}
+
+uint32_t getLogRepeatBarrier() {
+    uint32_t barrier = 0;
+    portENTER_CRITICAL(&repeatMux);
+    for (int i = 0; i < LOG_REPEAT_SLOTS; i++) {
+        const LogRepeatSlot& slot = repeatSlots[i];
+        if (slot.fingerprint != 0 && slot.seq != 0 && (barrier == 0 || slot.seq < barrier)) {
+            barrier = slot.seq;
+        }
+    }
+    portEXIT_CRITICAL(&repeatMux);
+    return barrier;
+}
+
+// Temizleme sink içinde, kuyruktaki önceki kayıtlardan sonra uygulanır
+static void applyClearLogs() {
+    portENTER_CRITICAL(&repeatMux);
+    memset(repeatSlots, 0, sizeof(repeatSlots));
+    portEXIT_CRITICAL(&repeatMux);
+
+    logStorage.clear();
+    clearLogJournal();
+    resetNotifications();
+    bumpDataVersion(DATA_LOGS);
+}
+
+// Kuyruktan gelen kaydı tampona yaz ve aboneleri besle (sadece sink task'ında)
+static void storeLogRecord(uint32_t epoch, uint16_t ms, LogLevel level, const String& source, const char* msg, size_t length, uint32_t fingerprint) {
+    uint8_t sourceId = internLogSource(source);
+    // Slot kayıttan önce bağlanır; günlük yazıcısı kaydı pencere açıkken görmez
+    // (tampona yazan tek task sink olduğu için sıradaki seq bellidir)
+    if (fingerprint != 0) bindRepeatSlot(fingerprint, logStorage.lastSeq() + 1);
+    uint32_t seq = logStorage.push(epoch, ms, level, sourceId, msg, length);
+
+    // Koşullu GET sürüm sayacı (bildirim sayacını bildirim halkası artırır)
+    bumpDataVersion(DATA_LOGS);
+
+    // Push kanalı ve panel bildirimleri - tampon kilidi dışında
+    LogEntry newEntry;
+    newEntry.seq = seq;
+    newEntry.epoch = epoch;
+    newEntry.ms = ms;
+    newEntry.level = level;
+    newEntry.source = sourceId;
+    newEntry.repeat = 0;
+    newEntry.lastEpoch = epoch;
+    if (hasEventSubscribers() || level == ERROR || level == WARN) {
+        newEntry.message.reserve(length);
+        newEntry.message.concat(msg, length);
+    }
+    publishLogEvent(newEntry);
+    notificationOnLog(newEntry);
+
+    #ifdef DEBUG_MODE
+    // Seri konsol maliyeti çağıranlara değil sink task'ına yansır
+    Serial.print("[" + formatLogTimestamp(epoch) + "] [" + logLevelToString(level) + "] [" + source + "] ");
+    Serial.write((const uint8_t*)msg, length);
+    Serial.println();
+    #endif
+}
+
+static void drainLogQueue() {
+    LogQueueCell* cell;
+    while ((cell = logQueue.front()) != NULL) {
+        if (cell->level == LOG_CLEAR_MARKER) {
+            logQueue.release(*cell);
+            applyClearLogs();
+            appliedClears.fetch_add(1);
+            continue;
+        }
+
+        const char* data = logQueue.dataOf(*cell);
+        String source;
+        source.concat(data, cell->sourceLength);
+        storeLogRecord(cell->epoch, cell->ms, (LogLevel)cell->level, source,
+                       data + cell->sourceLength, cell->msgLength, cell->fingerprint);
+        logQueue.release(*cell);
+    }
+
+    uint32_t dropped = droppedLogs.exchange(0);
+    if (dropped > 0) {
+        String msg = "⚠️ Log kuyruğu doldu, " + String(dropped) + " kayıt düşürüldü";
+        uint32_t epoch;
+        uint16_t ms;
+        captureLogTime(epoch, ms);
+        storeLogRecord(epoch, ms, WARN, "SYSTEM", msg.c_str(), msg.length(), 0);
+    }
+}
+
+static void logSinkTask(void* parameter) {
+    while (true) {
+        // Üretici bildirim gönderir; kaçan bildirime karşı periyodik kontrol
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        drainLogQueue();
+        applyLogRepeats();
+    }
+}
+
+bool waitForLogSink(uint32_t timeoutMs) {
+    unsigned long start = millis();
+    while (!logQueue.empty()) {
+        if (millis() - start >= timeoutMs) return false;
+        vTaskDelay(pdMS_TO_TICKS(5));
     }
+    return true;
 }
 
 // Log sistemini başlatan fonksiyon
 void initLogSystem() {
     logStorage.clear();
-    logStorage.reserve(MAX_LOG_SIZE); // Bellek rezervasyonu yap
+    initNotificationFeed();
+
+    // Düşük öncelikli sink - web task'ı (öncelik 2) ile aynı çekirdekte, UART çekirdeğinden uzakta
+    if (logSinkHandle == NULL) {
+        xTaskCreatePinnedToCore(logSinkTask, "LogSink", 4096, NULL, 1, &logSinkHandle, 0);
+    }
     
     // Sistem başlatıldığında ilk logu ekle
     addLog("Log sistemi başlatıldı. Max " + String(MAX_LOG_SIZE) + " kayıt tutulacak.", INFO, "SYSTEM");
 }
 
-// Eski logları temizle (FIFO mantığı)
-void trimOldLogs() {
-    // Eğer MAX_LOG_SIZE aşılmışsa, en eski logları sil
-    while (logStorage.size() > MAX_LOG_SIZE) {
-        logStorage.erase(logStorage.begin()); // İlk (en eski) elemanı sil
+// Kuyruğa ekleme çekirdeği - addLog ve addLogf ortak kullanır.
+// Kilit almaz, beklemez ve bellek ayırmaz: kayıt önceden ayrılmış hücreye
+// kopyalanır, iş sink task'ında yapılır.
+static void enqueueLog(LogLevel level, const char* source, size_t sourceLength, const char* msg, size_t msgLength,
+                       uint32_t epoch, uint16_t ms, uint32_t fingerprint) {
+    if (sourceLength > 255) sourceLength = 255;
+    if (msgLength > LOG_MAX_MESSAGE_LENGTH) {
+        msgLength = LOG_MAX_MESSAGE_LENGTH;
+        // UTF-8 karakterini ortasından bölme
+        while (msgLength > 0 && (msg[msgLength] & 0xC0) == 0x80) msgLength--;
+    }
+
+    if (!logQueue.push(epoch, ms, (uint8_t)level, source, (uint8_t)sourceLength, msg, (uint16_t)msgLength, fingerprint)) {
+        droppedLogs.fetch_add(1);
+        return;
+    }
+
+    if (logSinkHandle != NULL) {
+        xTaskNotifyGive(logSinkHandle);
     }
 }
 
-// Yeni bir log ekleyen ana fonksiyon
+// Yeni bir log ekleyen ana fonksiyon - herhangi bir task'tan çağrılabilir
 void addLog(const String& msg, LogLevel level, const String& source) {
-    LogEntry newEntry;
-    newEntry.timestamp = getFormattedTimestamp();
-    newEntry.message = msg;
-    newEntry.level = level;
-    newEntry.source = source;
-    newEntry.millis_time = millis();
+    uint32_t epoch;
+    uint16_t ms;
+    captureLogTime(epoch, ms);
 
-    // Yeni logu vektörün sonuna ekle (en yeni)
-    logStorage.push_back(newEntry);
-    
-    // Boyut kontrolü yap
-    trimOldLogs();
+    // Patlama sırasında tekrarlar burada biter: kopya ve kuyruk yok
+    uint32_t fingerprint = logFingerprint(level, source.c_str(), source.length(), msg.c_str(), msg.length(), true);
+    if (suppressRepeat(fingerprint, epoch, msg.c_str(), msg.length())) return;
 
-    // Sadece DEBUG_MODE tanımlıysa seri porta yazdır
-    #ifdef DEBUG_MODE
-    Serial.println("[" + newEntry.timestamp + "] [" + logLevelToString(level) + "] [" + source + "] " + msg);
-    #endif
+    enqueueLog(level, source.c_str(), source.length(), msg.c_str(), msg.length(), epoch, ms, fingerprint);
+}
+
+// printf biçimli log - String birleştirmesi yok, mesaj yığındaki tamponda
+// oluşturulur. Sığmazsa kuyruğun büyük bloğunda bir kez daha biçimlenir.
+void addLogf(LogLevel level, const char* source, const char* format, ...) {
+    uint32_t epoch;
+    uint16_t ms;
+    captureLogTime(epoch, ms);
+
+    // Parmak izi biçimlemeden önce, biçim dizesinden: aynı çağrı noktası
+    // farklı argümanlarla da tek kayda katlanır
+    size_t sourceLength = strlen(source);
+    uint32_t fingerprint = logFingerprint(level, source, sourceLength, format, strlen(format), false);
+
+    char buffer[LOG_FORMAT_BUFFER_SIZE];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) return;
+
+    // Tekrar ise yığındaki metin son değer olarak saklanır; heap'e hiç inilmez
+    size_t stackLength = (size_t)length < sizeof(buffer) ? (size_t)length : sizeof(buffer) - 1;
+    if (suppressRepeat(fingerprint, epoch, buffer, stackLength)) return;
+
+    if ((size_t)length < sizeof(buffer)) {
+        enqueueLog(level, source, sourceLength, buffer, length, epoch, ms, fingerprint);
+        return;
+    }
+
+    // Yığın tamponuna sığmadı: doğrudan kuyruğun büyük bloğuna biçimlenir (heap yok)
+    if (sourceLength > 255) sourceLength = 255;
+    uint8_t block = claimLargeBlock();
+    if (block != LOG_QUEUE_INLINE) {
+        char* data = logLargeBlocks[block];
+        memcpy(data, source, sourceLength);
+        // Kırpma gerekirse bir bayt fazlası biçimlenir ve UTF-8 sınırında kesilir
+        size_t room = LOG_QUEUE_LARGE_BYTES - sourceLength;
+        if (room > LOG_MAX_MESSAGE_LENGTH + 2) room = LOG_MAX_MESSAGE_LENGTH + 2;
+        va_start(args, format);
+        vsnprintf(data + sourceLength, room, format, args);
+        va_end(args);
+        size_t textLength = (size_t)length < room ? (size_t)length : room - 1;
+        if (textLength > LOG_MAX_MESSAGE_LENGTH) {
+            textLength = LOG_MAX_MESSAGE_LENGTH;
+            while (textLength > 0 && (data[sourceLength + textLength] & 0xC0) == 0x80) textLength--;
+        }
+        if (logQueue.push(epoch, ms, (uint8_t)level, NULL, (uint8_t)sourceLength, NULL, (uint16_t)textLength, fingerprint, block)) {
+            if (logSinkHandle != NULL) xTaskNotifyGive(logSinkHandle);
+        } else {
+            releaseLargeBlock(block);
+            droppedLogs.fetch_add(1);
+        }
+        return;
+    }
+
+    // Havuz da dolu: yığındaki kırpılmış metin
+    size_t textLength = sizeof(buffer) - 1;
+    while (textLength > 0 && (buffer[textLength] & 0xC0) == 0x80) textLength--;
+    enqueueLog(level, source, sourceLength, buffer, textLength, epoch, ms, fingerprint);
 }
 
 // Log seviyesini string'e çeviren yardımcı fonksiyon
@@ -84,52 +965,157 @@ String logLevelToString(LogLevel level) {
     }
 }
 
+int logLevelFromString(const String& name) {
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        if (name == logLevelToString((LogLevel)level)) return level;
+    }
+    return -1;
+}
+
 // Tüm logları temizleyen fonksiyon - GERÇEKTEN HER ŞEYİ TEMİZLER
-void clearLogs() {
-    // Belleği tamamen temizle
-    logStorage.clear();
-    logStorage.shrink_to_fit(); // Ayrılan belleği de serbest bırak
-    
-    // Yeniden başlat
-    logStorage.reserve(MAX_LOG_SIZE);
+// Kuyruktaki eski kayıtlar temizlikten sonra tampona düşmesin diye temizleme de
+// kuyruktan geçer ve yalnızca sink task'ında uygulanır. Çağıran (web task'ı)
+// sink işareti uygulayıp sayacı artırana kadar bekler.
+bool clearLogs() {
+    if (logSinkHandle == NULL) {
+        // Sink henüz yok: tampona yazan başka task da yok
+        applyClearLogs();
+        return true;
+    }
+
+    // Kuyruk doluysa sink boşalttıkça yeniden dene
+    unsigned long start = millis();
+    while (!logQueue.push(0, 0, LOG_CLEAR_MARKER, NULL, 0, NULL, 0, 0)) {
+        if (millis() - start >= LOG_CLEAR_TIMEOUT) return false;
+        xTaskNotifyGive(logSinkHandle);
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    uint32_t target = ++requestedClears;
+    xTaskNotifyGive(logSinkHandle);
+
+    while ((int32_t)(appliedClears.load() - target) < 0) {
+        if (millis() - start >= LOG_CLEAR_TIMEOUT) return false;
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
     
     // Temizleme logu ekle
     addLog("Log kayıtları temizlendi.", WARN, "SYSTEM");
+    return true;
 }
 
-// Toplam log sayısını döndür
+// Toplam log sayısını döndür (RAM + kalıcı günlükteki eski kayıtlar)
 int getTotalLogCount() {
-    return logStorage.size();
+    return logStorage.size() + countJournalHistory(-1, -1);
 }
 
 // Toplam sayfa sayısını döndür
 int getTotalPageCount() {
-    if (logStorage.size() == 0) return 1;
-    return (logStorage.size() + PAGE_SIZE - 1) / PAGE_SIZE; // Yukarı yuvarlama
+    int totalLogs = getTotalLogCount();
+    if (totalLogs == 0) return 1;
+    return (totalLogs + PAGE_SIZE - 1) / PAGE_SIZE; // Yukarı yuvarlama
 }
 
-// Belirli bir sayfanın loglarını döndür
-std::vector<LogEntry> getLogsPage(int pageNumber) {
-    std::vector<LogEntry> pageLogs;
-    
+// ASCII büyük/küçük harf duyarsız alt dizi araması (bellek ayırmadan)
+static bool containsIgnoreCase(const char* text, size_t length, const String& needleLower) {
+    size_t needleLength = needleLower.length();
+    if (needleLength == 0) return true;
+    if (needleLength > length) return false;
+
+    const char* needle = needleLower.c_str();
+    for (size_t i = 0; i + needleLength <= length; i++) {
+        size_t j = 0;
+        while (j < needleLength && tolower((unsigned char)text[i + j]) == needle[j]) j++;
+        if (j == needleLength) return true;
+    }
+    return false;
+}
+
+bool logMatchesQuery(const LogQuery& query, uint8_t level, uint8_t source, const char* message, size_t length) {
+    if (query.level >= 0 && level != query.level) return false;
+    if (query.source >= 0 && source != query.source) return false;
+    if (query.search.length() > 0) {
+        const char* sourceName = getLogSourceName(source);
+        if (!containsIgnoreCase(message, length, query.search) &&
+            !containsIgnoreCase(sourceName, strlen(sourceName), query.search)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Filtreye uyan kayıtları en yeniden eskiye sayfalar; toplam eşleşme sayısını döndürür.
+// Seviye veya kaynak filtresinde ilgili zincir izlenir, diğer kayıtlara hiç bakılmaz.
+// Toplam, arama yoksa indeks sayaçlarından gelir; aksi halde tüm eşleşmeler sayılır.
+size_t queryLogs(const LogQuery& query, int pageNumber, std::vector<LogEntry>& out, bool* partial) {
+    if (partial) *partial = false;
+    if (query.source == LOG_SOURCE_NONE) return 0;
     if (pageNumber < 1) pageNumber = 1;
-    
-    int totalPages = getTotalPageCount();
-    if (pageNumber > totalPages) pageNumber = totalPages;
-    
-    // Başlangıç ve bitiş indekslerini hesapla
-    // En yeni loglar ilk sayfada olacak şekilde tersine sıralama
-    int totalLogs = logStorage.size();
-    int startIdx = totalLogs - (pageNumber * PAGE_SIZE);
-    int endIdx = totalLogs - ((pageNumber - 1) * PAGE_SIZE) - 1;
-    
-    if (startIdx < 0) startIdx = 0;
-    if (endIdx >= totalLogs) endIdx = totalLogs - 1;
-    
-    // Tersine sıralı olarak logları ekle (en yeni en üstte)
-    for (int i = endIdx; i >= startIdx; i--) {
-        pageLogs.push_back(logStorage[i]);
+
+    size_t skip = (size_t)(pageNumber - 1) * PAGE_SIZE;
+    bool countFromIndex = query.countFromIndex();
+    size_t ramMatches = 0;
+    out.reserve(PAGE_SIZE);
+
+    {
+        LogReadLock readLock(logStorage);
+
+        // Zincir seçimi: seviye > kaynak > tümü
+        bool byLevel = query.level >= 0;
+        bool bySource = !byLevel && query.source >= 0;
+        uint16_t slot;
+        if (byLevel) slot = logStorage.newestSlotForLevel(query.level);
+        else if (bySource) slot = logStorage.newestSlotForSource(query.source);
+        else slot = logStorage.empty() ? LOG_NO_SLOT : logStorage.newestSlot();
+        size_t walked = 0;
+
+        while (slot != LOG_NO_SLOT) {
+            const LogRecord& record = logStorage.slotRecord(slot);
+            if (logMatchesQuery(query, record.level, record.source, logStorage.messageData(record), record.msgLength)) {
+                if (ramMatches >= skip && out.size() < (size_t)PAGE_SIZE) {
+                    out.push_back(logStorage.entryOf(record));
+                }
+                ramMatches++;
+                if (countFromIndex && out.size() >= (size_t)PAGE_SIZE) break;
+            }
+
+            if (byLevel || bySource) {
+                slot = logStorage.previousSlot(slot, byLevel);
+            } else {
+                // Filtresiz: fiziksel olarak bir önceki slot
+                slot = (++walked < logStorage.size())
+                     ? (uint16_t)((slot + logStorage.capacity() - 1) % logStorage.capacity())
+                     : LOG_NO_SLOT;
+            }
+        }
+
+        if (countFromIndex) {
+            if (query.level >= 0) ramMatches = logStorage.levelCount(query.level);
+            else if (query.source >= 0) ramMatches = logStorage.sourceCount(query.source);
+            else ramMatches = logStorage.size();
+        }
+    }
+
+    // Kalıcı günlük (tampon kilidi dışında; kilit sırası: günlük -> tampon)
+    size_t journalSkip = (skip > ramMatches) ? skip - ramMatches : 0;
+    size_t journalWanted = PAGE_SIZE - out.size();
+    size_t journalMatches;
+    if (countFromIndex) {
+        if (journalWanted > 0) queryJournalHistory(query, journalSkip, journalWanted, out, false, partial);
+        journalMatches = countJournalHistory(query.level, query.source);
+    } else {
+        journalMatches = queryJournalHistory(query, journalSkip, journalWanted, out, true, partial);
+    }
+
+    return ramMatches + journalMatches;
+}
+
+// Seviye sayaçları: RAM indeksi + günlükteki (RAM'de olmayan) kayıtlar
+void getLogLevelCounts(size_t counts[LOG_LEVEL_COUNT]) {
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        counts[level] = countJournalHistory(level, -1);
+    }
+    LogReadLock readLock(logStorage);
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++) {
+        counts[level] += logStorage.levelCount(level);
     }
-    
-    return pageLogs;
 }
\ No newline at end of file
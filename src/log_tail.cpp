@@ -0,0 +1,182 @@
+// log_tail.cpp - since imlecine göre artımlı log API'si (uzun bekleme destekli)
+// Yanıt boyutu ve JSON işi sayfa boyutuna değil yeni kayıt sayısına bağlıdır.
+#include "log_tail.h"
+#include "log_system.h"
+#include "settings.h"
+#include "web_routes.h"
+#include "data_version.h"
+#include <WebServer.h>
+#include <ArduinoJson.h>
+
+extern MeteredWebServer server;
+
+struct TailWaiter {
+    WiFiClient client;
+    LogQuery query;
+    uint32_t since;
+    bool bootMatches;      // İmleç bu açılıştan mı (boot parametresi yoksa kabul edilir)
+    unsigned long started;
+    unsigned long timeout;
+    bool active;
+};
+
+static TailWaiter tailWaiters[LOG_TAIL_MAX_WAITERS];
+static int waiterCount = 0;
+
+static bool parseBootMatches() {
+    if (!server.hasArg("boot")) return true;
+    return strtoul(server.arg("boot").c_str(), NULL, 10) == getBootId();
+}
+
+// since'den sonraki kayıtları en yeniden eskiye toplar.
+// İmleç tamponun gerisinde kaldıysa (kayıp var) veya başka bir açılıştan
+// geliyorsa (boot kimliği farklı) reset=true döner; istemci tam sayfayı yeniden çeker.
+static String buildTailJSON(const LogQuery& query, uint32_t since, bool bootMatches) {
+    std::vector<LogEntry> entries;
+    uint32_t lastSeq;
+    bool reset = false;
+
+    {
+        LogReadLock readLock(logStorage);
+        lastSeq = logStorage.lastSeq();
+        uint32_t oldestSeq = logStorage.empty() ? lastSeq + 1 : logStorage.at(0).seq;
+
+        if (!bootMatches || since > lastSeq || (since < lastSeq && since + 1 < oldestSeq)) {
+            reset = true;
+        } else if (query.source != LOG_SOURCE_NONE) {
+            for (size_t i = 0; i < logStorage.size(); i++) {
+                const LogRecord& record = logStorage.newest(i);
+                if (record.seq <= since) break;
+                if (!logMatchesQuery(query, record.level, record.source, logStorage.messageData(record), record.msgLength)) continue;
+                if (entries.size() >= LOG_TAIL_MAX_ENTRIES) {
+                    reset = true;
+                    entries.clear();
+                    break;
+                }
+                entries.push_back(logStorage.entryAt(logStorage.size() - 1 - i));
+            }
+        }
+    }
+
+    JsonDocument doc;
+    doc["lastSeq"] = lastSeq;
+    doc["bootId"] = getBootId();
+    doc["reset"] = reset;
+
+    JsonArray logs = doc["logs"].to<JsonArray>();
+    for (const auto& entry : entries) {
+        addLogEntryJSON(logs, entry);
+    }
+    addLogStatsJSON(doc);
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+// Park edilmiş istemciye yanıtı engellemeden yaz ve bağlantıyı kapat.
+// Yanıtın tamamını alamayan istemci yarım gövdeyle düşer; imleç ilerlemediği
+// için tarayıcı aynı since ile yeniden sorar, web task'ı beklemez.
+static void completeWaiter(int index) {
+    TailWaiter& waiter = tailWaiters[index];
+
+    if (waiter.client.connected()) {
+        String body = buildTailJSON(waiter.query, waiter.since, waiter.bootMatches);
+        String response = "HTTP/1.1 200 OK\r\n"
+                          "Content-Type: application/json\r\n"
+                          "Cache-Control: no-cache\r\n"
+                          "X-Content-Type-Options: nosniff\r\n"
+                          "Connection: close\r\n"
+                          "Content-Length: " + String(body.length()) + "\r\n\r\n";
+        response += body;
+        if (!writeClientNonBlocking(waiter.client, response.c_str(), response.length())) {
+            addLogf(DEBUG, "LOG", "Log takip yanıtı yazılamadı, istemci düşürüldü");
+        }
+    }
+
+    waiter.client.stop();
+    waiter.client = WiFiClient();
+    waiter.query = LogQuery();
+    waiter.active = false;
+    waiterCount--;
+}
+
+// Bekleyen için yanıtlanacak bir şey var mı? Filtreye uyan yeni kayıt yoksa
+// imleç son kayda ilerletilir ve istemci park edilmiş kalır.
+static bool waiterHasNews(TailWaiter& waiter) {
+    LogReadLock readLock(logStorage);
+    uint32_t lastSeq = logStorage.lastSeq();
+    if (lastSeq == waiter.since) return false;
+
+    uint32_t oldestSeq = logStorage.empty() ? lastSeq + 1 : logStorage.at(0).seq;
+    if (waiter.since > lastSeq || waiter.since + 1 < oldestSeq) return true;   // reset yanıtı
+
+    for (size_t i = 0; i < logStorage.size(); i++) {
+        const LogRecord& record = logStorage.newest(i);
+        if (record.seq <= waiter.since) break;
+        if (logMatchesQuery(waiter.query, record.level, record.source, logStorage.messageData(record), record.msgLength)) {
+            return true;
+        }
+    }
+
+    waiter.since = lastSeq;
+    return false;
+}
+
+void processLogTail() {
+    if (waiterCount == 0) return;
+
+    for (int i = 0; i < LOG_TAIL_MAX_WAITERS; i++) {
+        TailWaiter& waiter = tailWaiters[i];
+        if (!waiter.active) continue;
+
+        if (millis() - waiter.started >= waiter.timeout ||
+            !waiter.client.connected() ||
+            waiterHasNews(waiter)) {
+            completeWaiter(i);
+        }
+    }
+}
+
+// GET /api/logs/tail?since=<seq>&timeout=<ms>&level=&source=&search=
+void handleLogTailAPI() {
+    uint32_t since = strtoul(server.arg("since").c_str(), NULL, 10);
+    unsigned long timeout = server.hasArg("timeout") ? server.arg("timeout").toInt() : 0;
+    if (timeout > LOG_TAIL_MAX_TIMEOUT) timeout = LOG_TAIL_MAX_TIMEOUT;
+
+    LogQuery query = parseLogQueryArgs();
+    bool bootMatches = parseBootMatches();
+
+    // Yeni kayıt varsa, imleç başka açılıştansa veya beklenmeyecekse hemen yanıtla
+    if (timeout == 0 || !bootMatches || logStorage.lastSeq() != since) {
+        addSecurityHeaders();
+        server.send(200, "application/json", buildTailJSON(query, since, bootMatches));
+        return;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < LOG_TAIL_MAX_WAITERS; i++) {
+        if (!tailWaiters[i].active) {
+            slot = i;
+            break;
+        }
+    }
+
+    // Bekleme yeri yoksa boş yanıt; istemci normal aralıkla tekrar dener
+    if (slot < 0) {
+        addSecurityHeaders();
+        server.send(200, "application/json", buildTailJSON(query, since, bootMatches));
+        return;
+    }
+
+    // Soket kopyası WebServer isteği bitirdikten sonra da açık kalır
+    TailWaiter& waiter = tailWaiters[slot];
+    waiter.client = server.client();
+    waiter.query = query;
+    waiter.since = since;
+    waiter.bootMatches = bootMatches;
+    waiter.started = millis();
+    waiter.timeout = timeout;
+    waiter.active = true;
+    waiterCount++;
+}
\ No newline at end of file
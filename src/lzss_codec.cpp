@@ -0,0 +1,166 @@
+// lzss_codec.cpp - Yedek arşivleri için akış sıkıştırma
+#include "lzss_codec.h"
+
+#define LZSS_BUFFER_SIZE (2 * LZSS_WINDOW_SIZE)
+
+LzssEncoder::LzssEncoder(Print& out)
+    : out(out), filled(0), position(0), groupLength(1), groupItems(0), written(0) {
+    memset(head, 0xFF, sizeof(head));
+    memset(prev, 0xFF, sizeof(prev));
+    group[0] = 0;
+}
+
+static inline uint16_t hashAt(const uint8_t* p) {
+    uint32_t key = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (uint32_t)(key * 2654435761UL) >> (32 - LZSS_HASH_BITS);
+}
+
+// Üç baytlık önek için zincire ekle (önek tamponda tam olmalı)
+void LzssEncoder::insertHash(size_t at) {
+    if (at + 2 >= filled) return;
+    uint16_t h = hashAt(buffer + at);
+    prev[at] = head[h];
+    head[h] = (int16_t)at;
+}
+
+void LzssEncoder::emitLiteral(uint8_t value) {
+    group[groupLength++] = value;
+    if (++groupItems == 8) flushGroup();
+}
+
+void LzssEncoder::emitMatch(uint16_t offset, uint8_t length) {
+    uint16_t distance = offset - 1;
+    group[0] |= 1 << groupItems;
+    group[groupLength++] = distance & 0xFF;
+    group[groupLength++] = ((distance >> 8) << 6) | (length - LZSS_MIN_MATCH);
+    if (++groupItems == 8) flushGroup();
+}
+
+void LzssEncoder::flushGroup() {
+    if (groupItems == 0) return;
+    out.write(group, groupLength);
+    written += groupLength;
+    group[0] = 0;
+    groupLength = 1;
+    groupItems = 0;
+}
+
+// limit'ten önceki konumları kodla; eşleşmeler limit'i aşabilir (filled'ı aşmaz)
+void LzssEncoder::compress(size_t limit) {
+    while (position < limit) {
+        size_t available = filled - position;
+        if (available > LZSS_MAX_MATCH) available = LZSS_MAX_MATCH;
+
+        size_t bestLength = 0;
+        size_t bestOffset = 0;
+        if (available >= LZSS_MIN_MATCH) {
+            int candidate = head[hashAt(buffer + position)];
+            for (int chain = 0; candidate >= 0 && chain < LZSS_MAX_CHAIN; chain++) {
+                size_t offset = position - candidate;
+                if (offset > LZSS_WINDOW_SIZE) break;
+
+                size_t length = 0;
+                while (length < available && buffer[candidate + length] == buffer[position + length]) length++;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestOffset = offset;
+                    if (length == available) break;
+                }
+                candidate = prev[candidate];
+            }
+        }
+
+        if (bestLength >= LZSS_MIN_MATCH) {
+            emitMatch(bestOffset, bestLength);
+            for (size_t i = 0; i < bestLength; i++) insertHash(position + i);
+            position += bestLength;
+        } else {
+            emitLiteral(buffer[position]);
+            insertHash(position);
+            position++;
+        }
+    }
+}
+
+// Tamponun ilk yarısını at; konumlar pencere kadar geri kayar
+void LzssEncoder::slide() {
+    memmove(buffer, buffer + LZSS_WINDOW_SIZE, filled - LZSS_WINDOW_SIZE);
+    filled -= LZSS_WINDOW_SIZE;
+    position -= LZSS_WINDOW_SIZE;
+
+    for (int i = 0; i < (1 << LZSS_HASH_BITS); i++) {
+        head[i] = head[i] >= LZSS_WINDOW_SIZE ? head[i] - LZSS_WINDOW_SIZE : -1;
+    }
+    for (int i = 0; i < LZSS_WINDOW_SIZE; i++) {
+        int16_t link = prev[i + LZSS_WINDOW_SIZE];
+        prev[i] = link >= LZSS_WINDOW_SIZE ? link - LZSS_WINDOW_SIZE : -1;
+    }
+    memset(prev + LZSS_WINDOW_SIZE, 0xFF, LZSS_WINDOW_SIZE * sizeof(int16_t));
+}
+
+size_t LzssEncoder::write(const uint8_t* data, size_t length) {
+    size_t consumed = 0;
+    while (consumed < length) {
+        size_t room = LZSS_BUFFER_SIZE - filled;
+        size_t count = length - consumed < room ? length - consumed : room;
+        memcpy(buffer + filled, data + consumed, count);
+        filled += count;
+        consumed += count;
+
+        if (filled == LZSS_BUFFER_SIZE) {
+            // En uzun eşleşme için ileri bakış payı bırakılır
+            compress(filled - LZSS_MAX_MATCH);
+            slide();
+        }
+    }
+    return length;
+}
+
+void LzssEncoder::finish() {
+    compress(filled);
+    flushGroup();
+}
+
+LzssDecoder::LzssDecoder(Stream& in, size_t compressedLength)
+    : in(in), remaining(compressedLength), windowPos(0), flags(0), flagCount(0), copyFrom(0), copyLeft(0) {
+}
+
+int LzssDecoder::nextInput() {
+    if (remaining == 0) return -1;
+    remaining--;
+    return in.read();
+}
+
+uint8_t LzssDecoder::put(uint8_t value) {
+    window[windowPos & (LZSS_WINDOW_SIZE - 1)] = value;
+    windowPos++;
+    return value;
+}
+
+int LzssDecoder::read() {
+    if (copyLeft > 0) {
+        copyLeft--;
+        return put(window[copyFrom++ & (LZSS_WINDOW_SIZE - 1)]);
+    }
+
+    if (flagCount == 0) {
+        int value = nextInput();
+        if (value < 0) return -1;
+        flags = value;
+        flagCount = 8;
+    }
+    bool match = flags & 1;
+    flags >>= 1;
+    flagCount--;
+
+    int first = nextInput();
+    if (first < 0) return -1;
+    if (!match) return put(first);
+
+    int second = nextInput();
+    if (second < 0) return -1;
+    uint16_t offset = (((second >> 6) << 8) | first) + 1;
+    copyFrom = windowPos - offset;
+    copyLeft = (second & 0x3F) + LZSS_MIN_MATCH - 1;
+    return put(window[copyFrom++ & (LZSS_WINDOW_SIZE - 1)]);
+}
\ No newline at end of file
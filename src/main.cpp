@@ -13,19 +13,45 @@
 #include "datetime_handler.h"
 #include "fault_parser.h"
 #include "time_sync.h"  // BU SATIRI EKLE
+#include "event_stream.h"
+#include "dashboard_snapshot.h"
+#include "data_version.h"
+#include "log_journal.h"
+#include "log_tail.h"
+#include "sntp_server.h"
+#include "crypto_utils.h"
+#include "settings_store.h"
+#include "network_config.h"
 
 // External fonksiyonlar
 extern String getTimeSyncStats();
-extern void loadNetworkConfig();
-extern void initEthernetAdvanced();
+
+// uartTask; UART'ın yanında panel JSON'u, günlük yazımı (segment taramasında
+// ~770 baytlık yığın tamponu) ve NVS ayar kaydını da çalıştırır
+#define WEB_TASK_STACK   8192
+#define UART_TASK_STACK  8192
+#define TASK_STACK_WARN  1024    // Kalan yığın bunun altına inerse uyar (bayt)
 
 TaskHandle_t webTaskHandle = NULL;
 TaskHandle_t uartTaskHandle = NULL;
 
+// En düşük kalan yığın (high-water mark) eşiğin altına inerse bir kez uyar
+static void checkTaskStack(TaskHandle_t handle, const char* name, bool& warned) {
+    if (handle == NULL || warned) return;
+    UBaseType_t freeBytes = uxTaskGetStackHighWaterMark(handle);
+    if (freeBytes < TASK_STACK_WARN) {
+        addLog("⚠️ " + String(name) + " task yığını azaldı: " + String((unsigned long)freeBytes) + " bayt kaldı", WARN, "SYSTEM");
+        warned = true;
+    }
+}
+
 // Web server task - Core 0'da çalışacak
 void webServerTask(void *parameter) {
     while(true) {
         server.handleClient();
+        processEventStream();
+        processLogTail();
+        processNetworkChange();
         vTaskDelay(1);
     }
 }
@@ -35,24 +61,13 @@ void uartTask(void *parameter) {
     while(true) {
         checkTimeSync();
         checkUARTHealth();
+        updateDashboardSnapshot();
+        processLogJournal();
+        processSettingsStore();
         vTaskDelay(1000); // 1 saniye
     }
 }
 
-void initMDNS() {
-    uint8_t mac[6];
-    ETH.macAddress(mac);
-    char hostname[32];
-    sprintf(hostname, "teias-%02x%02x", mac[4], mac[5]);
-    
-    if (MDNS.begin(hostname)) {
-        addLog("✅ mDNS başlatıldı: " + String(hostname) + ".local", SUCCESS, "mDNS");
-        MDNS.addService("http", "tcp", 80);
-    } else {
-        addLog("❌ mDNS başlatılamadı", ERROR, "mDNS");
-    }
-}
-
 void setup() {
     Serial.begin(115200);
     setCpuFrequencyMhz(240);
@@ -65,29 +80,36 @@ void setup() {
         ESP.restart();
     }
     
+    initDataVersions();
+    initEventStream();
+    initDashboardSnapshot();
     initLogSystem();
+    initLogJournal();
+    initSettingsStore();
+    initPasswordHashing();
     loadSettings();
     loadNetworkConfig();
+    setupNetworkEvents();
     initEthernetAdvanced();
     initUART();
     setupWebRoutes();
-    loadPasswordPolicy();
     initMDNS();
 
     // Sistem başlangıcında zaman senkronizasyonu yap
     delay(2000); // dsPIC'in hazır olmasını bekle
     initTimeSync(); // YENİ SATIR
+    initSNTPServer();
     
-    xTaskCreatePinnedToCore(webServerTask, "WebServer", 8192, NULL, 2, &webTaskHandle, 0);
-    xTaskCreatePinnedToCore(uartTask, "UART", 4096, NULL, 1, &uartTaskHandle, 1);
+    xTaskCreatePinnedToCore(webServerTask, "WebServer", WEB_TASK_STACK, NULL, 2, &webTaskHandle, 0);
+    xTaskCreatePinnedToCore(uartTask, "UART", UART_TASK_STACK, NULL, 1, &uartTaskHandle, 1);
     
     addLog("🚀 Sistem başlatıldı", SUCCESS, "SYSTEM");
 }
 
 void loop() {
-    // Otomatik backup - her 24 saatte bir
+    // Otomatik backup - ayarlar değiştiyse (saatte bir kontrol)
     static unsigned long lastBackupCheck = 0;
-    if (millis() - lastBackupCheck > 86400000) { // 24 saat
+    if (millis() - lastBackupCheck > AUTO_BACKUP_CHECK_INTERVAL) {
         createAutomaticBackup();
         lastBackupCheck = millis();
     }
@@ -103,6 +125,11 @@ void loop() {
             lastEthStatus = currentEthStatus;
         }
         lastEthCheck = millis();
+        
+        static bool webStackWarned = false;
+        static bool uartStackWarned = false;
+        checkTaskStack(webTaskHandle, "WebServer", webStackWarned);
+        checkTaskStack(uartTaskHandle, "UART", uartStackWarned);
     }
     
     vTaskDelay(1000); // Ana döngüyü yavaşlat
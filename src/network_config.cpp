@@ -1,8 +1,12 @@
 // network_config.cpp - Orijinal çalışan versiyona dönüş
 #include <ETH.h>
+#include <ESPmDNS.h>
 #include <Preferences.h>
+#include "network_config.h"
 #include "log_system.h"
 #include "settings.h"
+#include "settings_store.h"
+#include "event_stream.h"
 
 // Global settings değişkenini kullan
 extern Settings settings;
@@ -14,6 +18,25 @@ void loadNetworkConfig() {
     addLog("Network yapılandırması hazır", INFO, "NET");
 }
 
+// Ethernet link olaylarını dinle (ETH.begin'den önce çağrılmalı)
+void setupNetworkEvents() {
+    WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+        switch (event) {
+            case ARDUINO_EVENT_ETH_CONNECTED:
+                publishLinkEvent(true);
+                break;
+            case ARDUINO_EVENT_ETH_GOT_IP:
+                publishLinkEvent(true);
+                break;
+            case ARDUINO_EVENT_ETH_DISCONNECTED:
+                publishLinkEvent(false);
+                break;
+            default:
+                break;
+        }
+    });
+}
+
 // Ethernet başlatma - Gelişmiş versiyon
 void initEthernetAdvanced() {
     addLog("Ethernet başlatılıyor...", INFO, "ETH");
@@ -63,4 +86,113 @@ void initEthernetAdvanced() {
     } else {
         addLog("⚠️ Ethernet kablosu bağlı değil", WARN, "ETH");
     }
+}
+
+void initMDNS() {
+    uint8_t mac[6];
+    ETH.macAddress(mac);
+    char hostname[32];
+    sprintf(hostname, "teias-%02x%02x", mac[4], mac[5]);
+    
+    if (MDNS.begin(hostname)) {
+        addLog("✅ mDNS başlatıldı: " + String(hostname) + ".local", SUCCESS, "mDNS");
+        MDNS.addService("http", "tcp", 80);
+    } else {
+        addLog("❌ mDNS başlatılamadı", ERROR, "mDNS");
+    }
+}
+
+enum NetworkChangeState {
+    NET_CHANGE_IDLE,
+    NET_CHANGE_APPLY,      // Yanıt gönderildikten sonra uygulanacak
+    NET_CHANGE_CONFIRM     // Uygulandı, yeni adresten onay bekleniyor
+};
+
+static NetworkChangeState changeState = NET_CHANGE_IDLE;
+static StaticNetworkConfig pendingConfig;
+static StaticNetworkConfig previousConfig;
+static unsigned long changeDeadline = 0;
+
+static StaticNetworkConfig currentSettingsConfig() {
+    StaticNetworkConfig config;
+    config.ip = settings.local_IP;
+    config.gateway = settings.gateway;
+    config.subnet = settings.subnet;
+    config.dns1 = settings.primaryDNS;
+    config.dns2 = settings.secondaryDNS;
+    return config;
+}
+
+// Adresi değiştir; eski adrese bağlı soketler kapanır, dinleyiciler ve mDNS
+// yeni adresle yeniden açılır. SNTP soketi INADDR_ANY'e bağlı, dokunulmaz.
+static bool applyNetwork(const StaticNetworkConfig& config) {
+    unsigned long start = millis();
+    if (!ETH.config(config.ip, config.gateway, config.subnet, config.dns1, config.dns2)) {
+        addLog("❌ Ağ ayarı uygulanamadı: " + config.ip.toString(), ERROR, "NETWORK");
+        return false;
+    }
+    
+    server.stop();
+    server.begin();
+    MDNS.end();
+    initMDNS();
+    
+    addLog("🔁 Ağ ayarı uygulandı: " + config.ip.toString() + " (" + String(millis() - start) + " ms)", SUCCESS, "NETWORK");
+    publishLinkEvent(ETH.linkUp());
+    return true;
+}
+
+bool requestNetworkChange(const StaticNetworkConfig& next) {
+    if (changeState != NET_CHANGE_IDLE) return false;
+    
+    previousConfig = currentSettingsConfig();
+    pendingConfig = next;
+    changeDeadline = millis() + NETWORK_APPLY_DELAY_MS;
+    changeState = NET_CHANGE_APPLY;
+    return true;
+}
+
+bool confirmNetworkChange(const IPAddress& via) {
+    if (changeState != NET_CHANGE_CONFIRM || via != pendingConfig.ip) return false;
+    
+    settings.local_IP = pendingConfig.ip;
+    settings.gateway = pendingConfig.gateway;
+    settings.subnet = pendingConfig.subnet;
+    settings.primaryDNS = pendingConfig.dns1;
+    settings.secondaryDNS = pendingConfig.dns2;
+    saveSettingsStore();
+    
+    changeState = NET_CHANGE_IDLE;
+    addLog("✅ Ağ ayarı onaylandı ve kaydedildi: " + pendingConfig.ip.toString(), SUCCESS, "NETWORK");
+    return true;
+}
+
+void processNetworkChange() {
+    if (changeState == NET_CHANGE_IDLE || (long)(millis() - changeDeadline) < 0) return;
+    
+    if (changeState == NET_CHANGE_APPLY) {
+        if (applyNetwork(pendingConfig)) {
+            changeDeadline = millis() + NETWORK_CONFIRM_TIMEOUT_MS;
+            changeState = NET_CHANGE_CONFIRM;
+            addLog("⏳ Yeni adresten " + String(NETWORK_CONFIRM_TIMEOUT_MS / 1000) + " sn içinde onay bekleniyor", WARN, "NETWORK");
+            return;
+        }
+    } else {
+        addLog("⚠️ Ağ ayarı onaylanmadı, önceki ayara dönülüyor", WARN, "NETWORK");
+    }
+    
+    // Onay gelmedi veya uygulama başarısız: kayıtlı ayara dön
+    applyNetwork(previousConfig);
+    changeState = NET_CHANGE_IDLE;
+}
+
+bool getPendingNetworkChange(StaticNetworkConfig& pending, unsigned long& remainingMs) {
+    if (changeState == NET_CHANGE_IDLE) return false;
+    
+    pending = pendingConfig;
+    remainingMs = 0;
+    if (changeState == NET_CHANGE_CONFIRM && (long)(changeDeadline - millis()) > 0) {
+        remainingMs = changeDeadline - millis();
+    }
+    return true;
 }
\ No newline at end of file
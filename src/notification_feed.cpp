@@ -0,0 +1,160 @@
+// notification_feed.cpp - Uyarı/hata bildirim halkası ve API'si
+#include "notification_feed.h"
+#include "log_system.h"
+#include "data_version.h"
+#include "web_routes.h"
+#include "route_metrics.h"
+#include <WebServer.h>
+
+extern MeteredWebServer server;
+
+struct NotificationItem {
+    uint32_t id;
+    uint32_t logSeq;
+    uint32_t epoch;
+    bool isError;
+    String message;
+};
+
+// En yeni: notifHead - 1. Id'ler ardışıktır; halkadaki en eski id lastId - count + 1
+static NotificationItem notifRing[NOTIFICATION_CAPACITY];
+static int notifHead = 0;
+static int notifCount = 0;
+static uint32_t lastId = 0;
+static uint32_t readUpTo = 0;
+static uint32_t feedVersion = 0;
+static SemaphoreHandle_t feedMutex = NULL;
+
+void initNotificationFeed() {
+    if (feedMutex == NULL) {
+        feedMutex = xSemaphoreCreateMutex();
+    }
+}
+
+static bool lockFeed(uint32_t timeoutMs) {
+    if (feedMutex == NULL) return false;
+    return xSemaphoreTake(feedMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+static void unlockFeed() {
+    xSemaphoreGive(feedMutex);
+}
+
+void notificationOnLog(const LogEntry& entry) {
+    if (entry.level != ERROR && entry.level != WARN) return;
+    if (!lockFeed(10)) return;
+
+    NotificationItem& item = notifRing[notifHead];
+    item.id = ++lastId;
+    item.logSeq = entry.seq;
+    item.epoch = entry.epoch;
+    item.isError = (entry.level == ERROR);
+    item.message = entry.message;
+    notifHead = (notifHead + 1) % NOTIFICATION_CAPACITY;
+    if (notifCount < NOTIFICATION_CAPACITY) notifCount++;
+    feedVersion++;
+
+    unlockFeed();
+    bumpDataVersion(DATA_NOTIFICATIONS);
+}
+
+void resetNotifications() {
+    if (!lockFeed(50)) return;
+
+    for (int i = 0; i < NOTIFICATION_CAPACITY; i++) {
+        notifRing[i].message = "";
+    }
+    notifHead = 0;
+    notifCount = 0;
+    // Id'ler sıfırlanmaz; istemci imleçleri geçerli kalır
+    readUpTo = lastId;
+    feedVersion++;
+
+    unlockFeed();
+    bumpDataVersion(DATA_NOTIFICATIONS);
+}
+
+uint32_t getNotificationLastId() {
+    return lastId;
+}
+
+uint32_t getUnreadNotificationCount() {
+    uint32_t unread = lastId - readUpTo;
+    return unread > (uint32_t)notifCount ? notifCount : unread;
+}
+
+uint32_t getNotificationVersion() {
+    return feedVersion;
+}
+
+void markNotificationsRead(uint32_t upToId) {
+    if (!lockFeed(50)) return;
+
+    if (upToId > lastId) upToId = lastId;
+    bool changed = upToId > readUpTo;
+    if (changed) {
+        readUpTo = upToId;
+        feedVersion++;
+    }
+
+    unlockFeed();
+    if (changed) bumpDataVersion(DATA_NOTIFICATIONS);
+}
+
+void writeNotificationsJSON(JsonDocument& doc, uint32_t since, int maxItems) {
+    JsonArray items = doc["items"].to<JsonArray>();
+    uint32_t newestId = lastId;
+
+    // İmleç güncelse halkaya hiç dokunulmaz
+    if (since < newestId && lockFeed(50)) {
+        newestId = lastId;
+        int available = (int)min<uint32_t>(newestId - since, notifCount);
+        for (int i = 0; i < available && i < maxItems; i++) {
+            const NotificationItem& item = notifRing[(notifHead - 1 - i + NOTIFICATION_CAPACITY) % NOTIFICATION_CAPACITY];
+            JsonObject notif = items.add<JsonObject>();
+            notif["id"] = item.id;
+            notif["logId"] = item.logSeq;
+            notif["type"] = item.isError ? "error" : "warning";
+            notif["message"] = item.message;
+            notif["time"] = formatLogTimestamp(item.epoch);
+            notif["read"] = item.id <= readUpTo;
+        }
+        unlockFeed();
+    }
+
+    doc["lastId"] = newestId;
+    doc["count"] = getUnreadNotificationCount();   // Rozet: okunmamış sayısı
+}
+
+// GET /api/notifications?since=<id> - imleç güncelse boş liste döner
+void handleNotificationAPI() {
+    if (handleConditionalGet(DATA_NOTIFICATIONS)) return;
+
+    uint32_t since = strtoul(server.arg("since").c_str(), NULL, 10);
+
+    JsonDocument doc;
+    writeNotificationsJSON(doc, since, NOTIFICATION_CAPACITY);
+
+    String output;
+    serializeJson(doc, output);
+
+    addSecurityHeaders();
+    server.send(200, "application/json", output);
+}
+
+// POST /api/notifications/read - upTo verilmezse tümü okundu sayılır
+void handleNotificationReadAPI() {
+    uint32_t upTo = server.hasArg("upTo") ? strtoul(server.arg("upTo").c_str(), NULL, 10) : getNotificationLastId();
+    markNotificationsRead(upTo);
+
+    JsonDocument doc;
+    doc["success"] = true;
+    doc["lastId"] = getNotificationLastId();
+    doc["count"] = getUnreadNotificationCount();
+
+    String output;
+    serializeJson(doc, output);
+
+    addSecurityHeaders();
+    server.send(200, "application/json", output);
+}
\ No newline at end of file
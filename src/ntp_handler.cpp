@@ -2,7 +2,7 @@
 #include "ntp_handler.h"
 #include "log_system.h"
 #include "uart_handler.h"
-#include <Preferences.h>
+#include "settings_store.h"
 
 // Global değişkenler
 NTPConfig ntpConfig;
@@ -85,7 +85,7 @@ bool sendNetworkConfigToSlave() {
         for (int retry = 0; retry < 3 && !sent; retry++) {
             if (retry > 0) {
                 delay(100);
-                addLog("Subnet tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "NTP-NET");
+                LOG_DEBUG("NTP-NET", "Subnet tekrar deneniyor (%d/3)", retry + 1);
             }
             
             if (sendToSecondCard(subnetCmd)) {
@@ -115,7 +115,7 @@ bool sendNetworkConfigToSlave() {
         for (int retry = 0; retry < 3 && !sent; retry++) {
             if (retry > 0) {
                 delay(100);
-                addLog("Gateway tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "NTP-NET");
+                LOG_DEBUG("NTP-NET", "Gateway tekrar deneniyor (%d/3)", retry + 1);
             }
             
             if (sendToSecondCard(gatewayCmd)) {
@@ -145,7 +145,7 @@ bool sendNetworkConfigToSlave() {
         for (int retry = 0; retry < 3 && !sent; retry++) {
             if (retry > 0) {
                 delay(100);
-                addLog("DNS tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "NTP-NET");
+                LOG_DEBUG("NTP-NET", "DNS tekrar deneniyor (%d/3)", retry + 1);
             }
             
             if (sendToSecondCard(dnsCmd)) {
@@ -197,7 +197,7 @@ bool sendNTPServersToSlave() {
         for (int retry = 0; retry < 3 && !sent1; retry++) {
             if (retry > 0) {
                 delay(100);
-                addLog("NTP1 Part1 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "NTP");
+                LOG_DEBUG("NTP", "NTP1 Part1 tekrar deneniyor (%d/3)", retry + 1);
             }
             
             if (sendToSecondCard(cmd1)) {
@@ -220,7 +220,7 @@ bool sendNTPServersToSlave() {
         for (int retry = 0; retry < 3 && !sent2; retry++) {
             if (retry > 0) {
                 delay(100);
-                addLog("NTP1 Part2 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "NTP");
+                LOG_DEBUG("NTP", "NTP1 Part2 tekrar deneniyor (%d/3)", retry + 1);
             }
             
             if (sendToSecondCard(cmd2)) {
@@ -253,7 +253,7 @@ bool sendNTPServersToSlave() {
             for (int retry = 0; retry < 3 && !sent3; retry++) {
                 if (retry > 0) {
                     delay(100);
-                    addLog("NTP2 Part1 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "NTP");
+                    LOG_DEBUG("NTP", "NTP2 Part1 tekrar deneniyor (%d/3)", retry + 1);
                 }
                 
                 if (sendToSecondCard(cmd3)) {
@@ -276,7 +276,7 @@ bool sendNTPServersToSlave() {
             for (int retry = 0; retry < 3 && !sent4; retry++) {
                 if (retry > 0) {
                     delay(100);
-                    addLog("NTP2 Part2 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "NTP");
+                    LOG_DEBUG("NTP", "NTP2 Part2 tekrar deneniyor (%d/3)", retry + 1);
                 }
                 
                 if (sendToSecondCard(cmd4)) {
@@ -417,20 +417,6 @@ bool saveNTPSettings(const String& server1, const String& server2,
         return false;
     }
     
-    Preferences preferences;
-    preferences.begin("ntp-config", false);
-    
-    // Tüm ayarları kaydet
-    preferences.putString("ntp_server1", server1);
-    preferences.putString("ntp_server2", server2);
-    preferences.putString("subnet", subnet);
-    preferences.putString("gateway", gateway);
-    preferences.putString("dns", dns);
-    preferences.putInt("timezone", timezone);
-    preferences.putBool("enabled", true);
-    
-    preferences.end();
-    
     // Global config güncelle
     server1.toCharArray(ntpConfig.ntpServer1, sizeof(ntpConfig.ntpServer1));
     server2.toCharArray(ntpConfig.ntpServer2, sizeof(ntpConfig.ntpServer2));
@@ -440,6 +426,7 @@ bool saveNTPSettings(const String& server1, const String& server2,
     ntpConfig.timezone = timezone;
     ntpConfig.enabled = true;
     ntpConfigured = true;
+    saveSettingsStore();
     
     addLog("✅ NTP+Network ayarları kaydedildi", SUCCESS, "NTP");
     addLog("  NTP1   : " + server1, INFO, "NTP");
@@ -453,20 +440,10 @@ bool saveNTPSettings(const String& server1, const String& server2,
     return true;
 }
 
-// NTP ayarlarını yükle (güncellenmiş)
+// NTP ayarları initSettingsStore'da ntpConfig'e yüklenir; burada yalnızca
+// kayıtlı sunucu yoksa varsayılanlar uygulanır
 bool loadNTPSettings() {
-    Preferences preferences;
-    preferences.begin("ntp-config", true);
-    
-    String server1 = preferences.getString("ntp_server1", "");
-    String server2 = preferences.getString("ntp_server2", "");
-    String subnet = preferences.getString("subnet", "255.255.255.0");
-    String gateway = preferences.getString("gateway", "192.168.1.1");
-    String dns = preferences.getString("dns", "8.8.8.8");
-    
-    preferences.end();
-    
-    if (server1.length() == 0) {
+    if (ntpConfig.ntpServer1[0] == '\0') {
         // Varsayılan değerler
         strcpy(ntpConfig.ntpServer1, "192.168.3.2");
         strcpy(ntpConfig.ntpServer2, "8.8.8.8");
@@ -484,16 +461,6 @@ bool loadNTPSettings() {
         return false;
     }
     
-    // Global config'e yükle
-    server1.toCharArray(ntpConfig.ntpServer1, sizeof(ntpConfig.ntpServer1));
-    server2.toCharArray(ntpConfig.ntpServer2, sizeof(ntpConfig.ntpServer2));
-    subnet.toCharArray(ntpConfig.subnet, sizeof(ntpConfig.subnet));
-    gateway.toCharArray(ntpConfig.gateway, sizeof(ntpConfig.gateway));
-    dns.toCharArray(ntpConfig.dns, sizeof(ntpConfig.dns));
-    
-    ntpConfig.timezone = preferences.getInt("timezone", 3);
-    ntpConfig.enabled = preferences.getBool("enabled", true);
-    
     ntpConfigured = true;
     addLog("✅ NTP+Network ayarları yüklendi", SUCCESS, "NTP");
     return true;
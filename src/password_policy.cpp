@@ -3,9 +3,10 @@
 #include "settings.h"
 #include "log_system.h"
 #include "crypto_utils.h"
+#include "settings_store.h"
 #include <WebServer.h>
 
-extern WebServer server;
+extern MeteredWebServer server;
 extern Settings settings;
 
 // Global password policy değişkeni
@@ -20,40 +21,9 @@ PasswordPolicy passwordPolicy = {
     .passwordHistory = 3
 };
 
-// Parola politikasını yükle
-void loadPasswordPolicy() {
-    Preferences prefs;
-    prefs.begin("pwd-policy", true);
-    
-    passwordPolicy.firstLoginPasswordChange = prefs.getBool("first_change", true);
-    passwordPolicy.passwordExpiry = prefs.getBool("expiry", true);
-    passwordPolicy.passwordExpiryDays = prefs.getInt("expiry_days", 90);
-    passwordPolicy.minPasswordLength = prefs.getInt("min_length", 6);
-    passwordPolicy.requireComplexPassword = prefs.getBool("complex", true);
-    passwordPolicy.lastPasswordChange = prefs.getULong("last_change", 0);
-    passwordPolicy.isDefaultPassword = prefs.getBool("is_default", true);
-    passwordPolicy.passwordHistory = prefs.getInt("history", 3);
-    
-    prefs.end();
-    
-    addLog("Parola politikası yüklendi", INFO, "POLICY");
-}
-
-// Parola politikasını kaydet
+// Parola politikası initSettingsStore'da yüklenir; kayıt ortak ayar bloğuna yazılır
 void savePasswordPolicy() {
-    Preferences prefs;
-    prefs.begin("pwd-policy", false);
-    
-    prefs.putBool("first_change", passwordPolicy.firstLoginPasswordChange);
-    prefs.putBool("expiry", passwordPolicy.passwordExpiry);
-    prefs.putInt("expiry_days", passwordPolicy.passwordExpiryDays);
-    prefs.putInt("min_length", passwordPolicy.minPasswordLength);
-    prefs.putBool("complex", passwordPolicy.requireComplexPassword);
-    prefs.putULong("last_change", passwordPolicy.lastPasswordChange);
-    prefs.putBool("is_default", passwordPolicy.isDefaultPassword);
-    prefs.putInt("history", passwordPolicy.passwordHistory);
-    
-    prefs.end();
+    saveSettingsStore();
 }
 
 // Parola karmaşıklık kontrolü - BASİTLEŞTİRİLDİ
@@ -93,7 +63,7 @@ bool isPasswordInHistory(const String& password) {
             String saltKey = "salt_" + String(i);
             String oldSalt = prefs.getString(saltKey.c_str(), "");
             
-            if (sha256(password, oldSalt) == oldHash) {
+            if (verifyPassword(password, oldSalt, oldHash)) {
                 prefs.end();
                 return true;
             }
@@ -205,7 +175,7 @@ void handlePasswordChangeAPI() {
     
     // Yeni parolayı kaydet
     String newSalt = generateRandomToken(16);
-    String newHash = sha256(newPassword, newSalt);
+    String newHash = hashPassword(newPassword, newSalt);
     
     // Geçmişe ekle
     addPasswordToHistory(newHash, newSalt);
@@ -215,15 +185,7 @@ void handlePasswordChangeAPI() {
     settings.passwordSalt = newSalt;
     settings.passwordHash = newHash;
     
-    // Preferences'a kaydet
-    Preferences prefs;
-    prefs.begin("app-settings", false);
-    prefs.putString("username", username);
-    prefs.putString("p_salt", newSalt);
-    prefs.putString("p_hash", newHash);
-    prefs.end();
-    
-    // Politikayı güncelle
+    // Politikayı güncelle (hesap bilgileriyle tek kayıtta saklanır)
     passwordPolicy.isDefaultPassword = false;
     passwordPolicy.lastPasswordChange = millis();
     savePasswordPolicy();
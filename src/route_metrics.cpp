@@ -0,0 +1,313 @@
+// route_metrics.cpp - Route bazlı gecikme / boyut ölçümleri
+// Tüm sayaçlar sadece web server task'ında güncellenir (istekler sıralı işlenir),
+// bu yüzden kilit gerekmez; istek başına maliyet birkaç micros() çağrısıdır.
+#include "route_metrics.h"
+#include "settings.h"
+
+extern MeteredWebServer server;
+
+#define MAX_METERED_ROUTES   80
+#define MAX_STATUS_CODES     6       // Route başına ayrı tutulan durum kodu
+
+// Gecikme histogramı kova üst sınırları (mikrosaniye)
+static const unsigned long latencyBucketsUs[] = {
+    1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000
+};
+#define LATENCY_BUCKET_COUNT (sizeof(latencyBucketsUs) / sizeof(latencyBucketsUs[0]))
+
+struct StatusCounter {
+    uint16_t code;
+    uint32_t count;
+};
+
+struct RouteMetrics {
+    String path;
+    HTTPMethod method;
+    uint32_t count;
+    StatusCounter statuses[MAX_STATUS_CODES];
+    uint32_t otherStatuses;
+    uint32_t buckets[LATENCY_BUCKET_COUNT + 1];   // Son kova: +Inf
+    uint64_t latencySumUs;
+    uint64_t uartSumUs;
+    uint64_t bytesSum;
+};
+
+static RouteMetrics routeMetrics[MAX_METERED_ROUTES];
+static int routeMetricsCount = 0;
+
+// Devam eden isteğin durumu
+static int currentRoute = -1;
+static TaskHandle_t currentRequestTask = NULL;
+static unsigned long requestStartUs = 0;
+static unsigned long requestUartUs = 0;
+static size_t requestBytes = 0;
+static int requestStatus = 0;
+
+static const char* methodName(HTTPMethod method) {
+    switch (method) {
+        case HTTP_GET:     return "GET";
+        case HTTP_POST:    return "POST";
+        case HTTP_PUT:     return "PUT";
+        case HTTP_DELETE:  return "DELETE";
+        case HTTP_PATCH:   return "PATCH";
+        case HTTP_OPTIONS: return "OPTIONS";
+        case HTTP_HEAD:    return "HEAD";
+        default:           return "ANY";
+    }
+}
+
+int registerRouteMetrics(const String& path, HTTPMethod method) {
+    for (int i = 0; i < routeMetricsCount; i++) {
+        if (routeMetrics[i].method == method && routeMetrics[i].path == path) return i;
+    }
+    if (routeMetricsCount >= MAX_METERED_ROUTES) return -1;
+
+    RouteMetrics& m = routeMetrics[routeMetricsCount];
+    m.path = path;
+    m.method = method;
+    return routeMetricsCount++;
+}
+
+void beginRouteRequest(int routeId) {
+    currentRoute = routeId;
+    currentRequestTask = xTaskGetCurrentTaskHandle();
+    requestUartUs = 0;
+    requestBytes = 0;
+    requestStatus = 0;
+    requestStartUs = micros();
+}
+
+void endRouteRequest() {
+    unsigned long elapsed = micros() - requestStartUs;
+    int routeId = currentRoute;
+    currentRoute = -1;
+    currentRequestTask = NULL;
+    if (routeId < 0) return;
+
+    RouteMetrics& m = routeMetrics[routeId];
+    m.count++;
+    m.latencySumUs += elapsed;
+    m.uartSumUs += requestUartUs;
+    m.bytesSum += requestBytes;
+
+    size_t bucket = 0;
+    while (bucket < LATENCY_BUCKET_COUNT && elapsed > latencyBucketsUs[bucket]) bucket++;
+    m.buckets[bucket]++;
+
+    // Handler yanıt göndermediyse (ör. olay akışı) WebServer'ın varsayılanı 200'dür
+    uint16_t code = requestStatus > 0 ? requestStatus : 200;
+    for (int i = 0; i < MAX_STATUS_CODES; i++) {
+        if (m.statuses[i].code == code || m.statuses[i].code == 0) {
+            m.statuses[i].code = code;
+            m.statuses[i].count++;
+            return;
+        }
+    }
+    m.otherStatuses++;
+}
+
+void addRouteUartTime(unsigned long us) {
+    // Sadece istek işleyen task'ın UART süresi o isteğe yazılır (arka plan sorguları hariç)
+    if (currentRoute >= 0 && xTaskGetCurrentTaskHandle() == currentRequestTask) {
+        requestUartUs += us;
+    }
+}
+
+// --- MeteredWebServer ---
+
+void MeteredWebServer::recordResponse(int code, size_t bytes) {
+    if (currentRoute < 0) return;
+    if (code > 0 && requestStatus == 0) requestStatus = code;
+    requestBytes += bytes;
+}
+
+void MeteredWebServer::on(const String& path, THandlerFunction handler) {
+    on(path, HTTP_ANY, handler);
+}
+
+void MeteredWebServer::on(const String& path, HTTPMethod method, THandlerFunction handler) {
+    int routeId = registerRouteMetrics(path, method);
+    WebServer::on(path, method, [routeId, handler]() {
+        beginRouteRequest(routeId);
+        handler();
+        endRouteRequest();
+    });
+}
+
+void MeteredWebServer::on(const String& path, HTTPMethod method, THandlerFunction handler, THandlerFunction uploadHandler) {
+    // Yükleme parçaları ölçülmez; istek, son handler çalıştığında kaydedilir
+    int routeId = registerRouteMetrics(path, method);
+    WebServer::on(path, method, [routeId, handler]() {
+        beginRouteRequest(routeId);
+        handler();
+        endRouteRequest();
+    }, uploadHandler);
+}
+
+void MeteredWebServer::onNotFound(THandlerFunction handler) {
+    int routeId = registerRouteMetrics("<not_found>", HTTP_ANY);
+    WebServer::onNotFound([routeId, handler]() {
+        beginRouteRequest(routeId);
+        handler();
+        endRouteRequest();
+    });
+}
+
+void MeteredWebServer::send(int code, const char* contentType, const String& content) {
+    recordResponse(code, content.length());
+    WebServer::send(code, contentType, content);
+}
+
+void MeteredWebServer::send(int code, const String& contentType, const String& content) {
+    recordResponse(code, content.length());
+    WebServer::send(code, contentType, content);
+}
+
+void MeteredWebServer::send(int code, const char* contentType, const char* content) {
+    recordResponse(code, content ? strlen(content) : 0);
+    WebServer::send(code, contentType, content);
+}
+
+void MeteredWebServer::sendContent(const String& content) {
+    recordResponse(0, content.length());
+    WebServer::sendContent(content);
+}
+
+void MeteredWebServer::sendContent(const char* content, size_t length) {
+    recordResponse(0, length);
+    WebServer::sendContent(content, length);
+}
+
+// --- Prometheus çıktısı ---
+
+// Etiket değerindeki özel karakterleri kaçır
+static String escapeLabel(const String& value) {
+    String out;
+    out.reserve(value.length() + 4);
+    for (unsigned int i = 0; i < value.length(); i++) {
+        char c = value.charAt(i);
+        if (c == '\\' || c == '"') out += '\\';
+        if (c == '\n') { out += "\\n"; continue; }
+        out += c;
+    }
+    return out;
+}
+
+static String formatSeconds(uint64_t us) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%.6f", (double)us / 1000000.0);
+    return String(buf);
+}
+
+static String formatU64(uint64_t value) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+    return String(buf);
+}
+
+static String routeLabels(const RouteMetrics& m) {
+    return "route=\"" + escapeLabel(m.path) + "\",method=\"" + methodName(m.method) + "\"";
+}
+
+// Parça büyüdükçe gönder (Prometheus aynı ailenin satırlarını ardışık ister)
+static void flushChunk(String& chunk, bool force) {
+    if (chunk.length() == 0 || (!force && chunk.length() < 1024)) return;
+    server.sendContent(chunk);
+    chunk = "";
+}
+
+static void appendFamilyHeader(String& chunk, const char* name, const char* type, const char* help) {
+    chunk += "# HELP ";
+    chunk += name;
+    chunk += " ";
+    chunk += help;
+    chunk += "\n# TYPE ";
+    chunk += name;
+    chunk += " ";
+    chunk += type;
+    chunk += "\n";
+}
+
+// GET /metrics - Prometheus text format (0.0.4), sadece çağrılmış route'lar.
+// Çıktı parça parça gönderilir; tek büyük String oluşturulmaz.
+void handleMetricsAPI() {
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4; charset=utf-8", "");
+
+    String chunk;
+    chunk.reserve(1280);
+
+    appendFamilyHeader(chunk, "webui_device_info", "gauge", "Cihaz ve trafo merkezi bilgisi");
+    chunk += "webui_device_info{device=\"" + escapeLabel(settings.deviceName) +
+             "\",station=\"" + escapeLabel(settings.transformerStation) + "\"} 1\n";
+    appendFamilyHeader(chunk, "webui_uptime_seconds", "counter", "Çalışma süresi");
+    chunk += "webui_uptime_seconds " + String(millis() / 1000) + "\n";
+    appendFamilyHeader(chunk, "webui_free_heap_bytes", "gauge", "Boş heap");
+    chunk += "webui_free_heap_bytes " + String(ESP.getFreeHeap()) + "\n";
+
+    // İstek sayısı (durum koduna göre)
+    appendFamilyHeader(chunk, "webui_http_requests_total", "counter", "Route başına istek sayısı");
+    for (int r = 0; r < routeMetricsCount; r++) {
+        const RouteMetrics& m = routeMetrics[r];
+        if (m.count == 0) continue;
+        String labels = routeLabels(m);
+        for (int i = 0; i < MAX_STATUS_CODES && m.statuses[i].code != 0; i++) {
+            chunk += "webui_http_requests_total{" + labels + ",code=\"" + String(m.statuses[i].code) + "\"} " +
+                     String(m.statuses[i].count) + "\n";
+        }
+        if (m.otherStatuses > 0) {
+            chunk += "webui_http_requests_total{" + labels + ",code=\"other\"} " + String(m.otherStatuses) + "\n";
+        }
+        flushChunk(chunk, false);
+    }
+
+    // Gecikme histogramı
+    appendFamilyHeader(chunk, "webui_http_request_duration_seconds", "histogram", "Handler gecikmesi");
+    for (int r = 0; r < routeMetricsCount; r++) {
+        const RouteMetrics& m = routeMetrics[r];
+        if (m.count == 0) continue;
+        String labels = routeLabels(m);
+        uint32_t cumulative = 0;
+        for (size_t b = 0; b < LATENCY_BUCKET_COUNT; b++) {
+            cumulative += m.buckets[b];
+            chunk += "webui_http_request_duration_seconds_bucket{" + labels + ",le=\"" +
+                     formatSeconds(latencyBucketsUs[b]) + "\"} " + String(cumulative) + "\n";
+        }
+        cumulative += m.buckets[LATENCY_BUCKET_COUNT];
+        chunk += "webui_http_request_duration_seconds_bucket{" + labels + ",le=\"+Inf\"} " + String(cumulative) + "\n";
+        chunk += "webui_http_request_duration_seconds_sum{" + labels + "} " + formatSeconds(m.latencySumUs) + "\n";
+        chunk += "webui_http_request_duration_seconds_count{" + labels + "} " + String(m.count) + "\n";
+        flushChunk(chunk, false);
+    }
+
+    // Yanıt boyutu, UART ve JSON/gönderim süreleri
+    appendFamilyHeader(chunk, "webui_http_response_bytes_total", "counter", "Gönderilen gövde baytı");
+    for (int r = 0; r < routeMetricsCount; r++) {
+        const RouteMetrics& m = routeMetrics[r];
+        if (m.count == 0) continue;
+        chunk += "webui_http_response_bytes_total{" + routeLabels(m) + "} " + formatU64(m.bytesSum) + "\n";
+        flushChunk(chunk, false);
+    }
+
+    appendFamilyHeader(chunk, "webui_http_uart_seconds_total", "counter",
+                       "Handler içinde UART hattında geçen süre (kilit bekleme dahil)");
+    for (int r = 0; r < routeMetricsCount; r++) {
+        const RouteMetrics& m = routeMetrics[r];
+        if (m.count == 0) continue;
+        chunk += "webui_http_uart_seconds_total{" + routeLabels(m) + "} " + formatSeconds(m.uartSumUs) + "\n";
+        flushChunk(chunk, false);
+    }
+
+    appendFamilyHeader(chunk, "webui_http_build_seconds_total", "counter",
+                       "UART dışı handler süresi (JSON oluşturma ve gönderim)");
+    for (int r = 0; r < routeMetricsCount; r++) {
+        const RouteMetrics& m = routeMetrics[r];
+        if (m.count == 0) continue;
+        uint64_t buildUs = m.latencySumUs > m.uartSumUs ? m.latencySumUs - m.uartSumUs : 0;
+        chunk += "webui_http_build_seconds_total{" + routeLabels(m) + "} " + formatSeconds(buildUs) + "\n";
+        flushChunk(chunk, false);
+    }
+
+    flushChunk(chunk, true);
+    server.sendContent("");
+}
\ No newline at end of file
@@ -1,60 +1,37 @@
 #include "settings.h"
 #include "log_system.h"
 #include "crypto_utils.h"
-#include <Preferences.h>
+#include "auth_system.h"
+#include "settings_store.h"
 
-WebServer server(80);
+MeteredWebServer server(80);
 Settings settings;
 
+// Kalıcı alanlar initSettingsStore'da RAM'e alınır; burada sabitler ve ilk kurulum
 void loadSettings() {
-    Preferences prefs;
-    prefs.begin("app-settings", true);
-
-    settings.local_IP.fromString("192.168.1.160");
-    settings.gateway.fromString("192.168.1.1");
-    settings.subnet.fromString("255.255.255.0");
-    settings.primaryDNS.fromString("8.8.8.8");
-
-    settings.deviceName = prefs.getString("dev_name", "TEİAŞ EKLİM");
-    settings.transformerStation = prefs.getString("tm_name", "Ankara TM");
-    settings.username = prefs.getString("username", "admin");
     settings.currentBaudRate = 250000; // Sabit değer
-    settings.passwordSalt = prefs.getString("p_salt", "");
-    settings.passwordHash = prefs.getString("p_hash", "");
+    settings.SESSION_TIMEOUT = 7200000; // 120 dakika
 
     // İlk kurulum: Eğer hiç parola kaydedilmemişse varsayılan parolayı ayarla
     if (settings.passwordSalt.length() == 0 || settings.passwordHash.length() == 0) {
         String newSalt = generateRandomToken(16); // Rastgele bir tuz üret
         settings.passwordSalt = newSalt;
         // Varsayılan parola "1234"
-        settings.passwordHash = sha256("1234", newSalt);
-        
-        // Bu değişiklikleri kalıcı hale getirmek için yazma modunda açıp kaydedelim.
-        Preferences writePrefs;
-        writePrefs.begin("app-settings", false);
-        writePrefs.putString("p_salt", settings.passwordSalt);
-        writePrefs.putString("p_hash", settings.passwordHash);
-        writePrefs.end();
+        settings.passwordHash = hashPassword("1234", newSalt);
+        saveSettingsStore();
     }
 
-    prefs.end();
-
-    // Oturum başlangıçta geçersiz
-    settings.sessionToken = "";
-    settings.sessionStartTime = 0;
-    settings.isAdminSession = false;  // BU SATIRI EKLEYİN
-    settings.SESSION_TIMEOUT = 7200000; // 120 dakika
-
     addLog("Ayarlar yüklendi", INFO, "SETTINGS");
 }
 
 bool saveSettings(const String& newDevName, const String& newTmName, 
                   const String& newUsername, const String& newPassword) {
     
-    if (newDevName.length() < 3 || newDevName.length() > 50) return false;
+    if (newDevName.length() < 3 || newDevName.length() > DEVICE_NAME_MAX_LENGTH) return false;
+    if (newTmName.length() > TM_NAME_MAX_LENGTH) return false;
     
     // Kullanıcı adı validasyonu
-    if (newUsername.length() < 3 || newUsername.length() > 30) return false;
+    if (newUsername.length() < USERNAME_MIN_LENGTH || newUsername.length() > USERNAME_MAX_LENGTH) return false;
     
     // Kullanıcı adı karakter kontrolü
     for (char c : newUsername) {
@@ -64,39 +41,23 @@ bool saveSettings(const String& newDevName, const String& newTmName,
         }
     }
 
-    Preferences prefs;
-    prefs.begin("app-settings", false);
-
-    if (newDevName != settings.deviceName) {
-        settings.deviceName = newDevName;
-        prefs.putString("dev_name", newDevName);
-    }
-
-    if (newTmName != settings.transformerStation) {
-        settings.transformerStation = newTmName;
-        prefs.putString("tm_name", newTmName);
-    }
-
-    if (newUsername != settings.username) {
-        settings.username = newUsername;
-        prefs.putString("username", newUsername);
-    }
+    settings.deviceName = newDevName;
+    settings.transformerStation = newTmName;
+    settings.username = newUsername;
 
     // Şifre değişikliği
     if (newPassword.length() >= 4) {
         String newSalt = generateRandomToken(16); // Her zaman yeni, rastgele bir tuz
         settings.passwordSalt = newSalt;
-        settings.passwordHash = sha256(newPassword, newSalt);
-        prefs.putString("p_salt", settings.passwordSalt);
-        prefs.putString("p_hash", settings.passwordHash);
+        settings.passwordHash = hashPassword(newPassword, newSalt);
         
-        // Şifre değiştiğinde oturumu sonlandır
-        settings.sessionToken = "";
+        // Şifre değiştiğinde oturumları sonlandır
+        endAllSessions();
         
         addLog("Şifre değiştirildi, oturum sonlandırıldı.", INFO, "SETTINGS");
     }
 
-    prefs.end();
+    saveSettingsStore();
     addLog("Ayarlar kaydedildi", SUCCESS, "SETTINGS");
     return true;
 }
@@ -0,0 +1,454 @@
+// settings_store.cpp - Tek blob halinde kalıcı ayarlar ve ertelenmiş yazım
+#include "settings_store.h"
+#include "settings.h"
+#include "password_policy.h"
+#include "ntp_handler.h"
+#include "log_system.h"
+#include "data_version.h"
+#include <Preferences.h>
+#include <esp_rom_crc.h>
+
+#define SETTINGS_STORE_KEY   "blob"
+#define SETTINGS_STORE_MAGIC 0x47464354UL   // "TCFG"
+
+extern bool ntpConfigured;
+
+// Sabit boyutlu kayıt. Alanlar yalnızca sona eklenir; daha kısa (eski sürüm)
+// kayıtlar okunurken eksik alanlar varsayılanlarla doldurulur.
+struct SettingsRecord {
+    // Ağ
+    uint32_t localIP;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t primaryDNS;
+    uint32_t secondaryDNS;
+
+    // Cihaz ve hesap
+    char deviceName[96];
+    char transformerStation[96];
+    char username[32];
+    char passwordSalt[68];
+    char passwordHash[96];
+
+    // Parola politikası
+    uint8_t firstLoginPasswordChange;
+    uint8_t passwordExpiry;
+    uint8_t requireComplexPassword;
+    uint8_t isDefaultPassword;
+    int32_t passwordExpiryDays;
+    int32_t minPasswordLength;
+    int32_t passwordHistory;
+    uint32_t lastPasswordChange;
+
+    // NTP ve dsPIC ağ ayarları
+    char ntpServer1[64];
+    char ntpServer2[64];
+    char ntpSubnet[16];
+    char ntpGateway[16];
+    char ntpDNS[16];
+    int32_t timezone;
+    uint8_t ntpEnabled;
+    uint8_t reserved[3];
+
+    uint32_t hashIterations;
+};
+
+// Dolgu baytı yok: memcmp ile karşılaştırma ve blob düzeni buna dayanır
+static_assert(sizeof(SettingsRecord) == 616, "SettingsRecord düzeni değişti");
+// Doğrulanmış adlar sonlandırıcıyla birlikte alana sığmalı
+static_assert(sizeof(SettingsRecord::deviceName) > DEVICE_NAME_MAX_LENGTH, "deviceName alanı küçük");
+static_assert(sizeof(SettingsRecord::transformerStation) > TM_NAME_MAX_LENGTH, "transformerStation alanı küçük");
+static_assert(sizeof(SettingsRecord::username) > USERNAME_MAX_LENGTH, "username alanı küçük");
+
+struct SettingsBlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;     // Kayıt uzunluğu (başlık hariç)
+    uint32_t crc;        // Kayıt üzerinden CRC32
+};
+
+struct SettingsBlob {
+    SettingsBlobHeader header;
+    SettingsRecord record;
+};
+
+static portMUX_TYPE storeMux = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t writeMutex = NULL;
+
+// Son anlık görüntü ve yazım durumu (storeMux ile korunur)
+static SettingsRecord pending;
+static uint32_t storedHashIterations = 0;
+static bool dirty = false;
+static unsigned long dirtySince = 0;
+static unsigned long lastChange = 0;
+static unsigned long lastFailure = 0;
+static bool failed = false;             // Son yazım başarısız: yeniden deneme geciktirilir
+static SettingsStoreStats stats = {};
+
+// Yalnızca yazım görevinde (writeMutex altında) kullanılır
+static SettingsBlob writeBuffer;
+static SettingsRecord lastWritten;
+
+// Alana kopyalar; sığmazsa UTF-8 karakterini bölmeden kırpar. Kırpıldıysa true.
+static bool copyText(char* dest, size_t size, const String& value) {
+    size_t length = value.length();
+    bool truncated = length >= size;
+    if (truncated) {
+        length = size - 1;
+        while (length > 0 && (value[length] & 0xC0) == 0x80) length--;
+    }
+    memcpy(dest, value.c_str(), length);
+    dest[length] = '\0';
+    return truncated;
+}
+
+// Global'den kayda; kırpılırsa RAM'deki değer de kırpılmış haliyle değiştirilir
+// (doğrulama sınırları bunu önler, eski/elle yazılmış değerler için güvence)
+static void captureText(char* dest, size_t size, String& value, const char* name) {
+    if (copyText(dest, size, value)) {
+        value = dest;
+        addLog("⚠️ " + String(name) + " alana sığmadı, kırpıldı", WARN, "SETTINGS");
+    }
+}
+
+static void defaultRecord(SettingsRecord& r) {
+    memset(&r, 0, sizeof(r));
+    r.localIP = (uint32_t)IPAddress(192, 168, 1, 160);
+    r.gateway = (uint32_t)IPAddress(192, 168, 1, 1);
+    r.subnet = (uint32_t)IPAddress(255, 255, 255, 0);
+    r.primaryDNS = (uint32_t)IPAddress(8, 8, 8, 8);
+    strlcpy(r.deviceName, "TEİAŞ EKLİM", sizeof(r.deviceName));
+    strlcpy(r.transformerStation, "Ankara TM", sizeof(r.transformerStation));
+    strlcpy(r.username, "admin", sizeof(r.username));
+
+    r.firstLoginPasswordChange = true;
+    r.passwordExpiry = true;
+    r.requireComplexPassword = true;
+    r.isDefaultPassword = true;
+    r.passwordExpiryDays = 90;
+    r.minPasswordLength = 6;
+    r.passwordHistory = 3;
+
+    r.timezone = 3;
+    r.ntpEnabled = true;
+}
+
+// Global'lerden kayda
+static void captureRecord(SettingsRecord& r) {
+    memset(&r, 0, sizeof(r));
+    r.localIP = (uint32_t)settings.local_IP;
+    r.gateway = (uint32_t)settings.gateway;
+    r.subnet = (uint32_t)settings.subnet;
+    r.primaryDNS = (uint32_t)settings.primaryDNS;
+    r.secondaryDNS = (uint32_t)settings.secondaryDNS;
+    captureText(r.deviceName, sizeof(r.deviceName), settings.deviceName, "Cihaz adı");
+    captureText(r.transformerStation, sizeof(r.transformerStation), settings.transformerStation, "TM adı");
+    captureText(r.username, sizeof(r.username), settings.username, "Kullanıcı adı");
+    captureText(r.passwordSalt, sizeof(r.passwordSalt), settings.passwordSalt, "Parola tuzu");
+    captureText(r.passwordHash, sizeof(r.passwordHash), settings.passwordHash, "Parola özeti");
+
+    r.firstLoginPasswordChange = passwordPolicy.firstLoginPasswordChange;
+    r.passwordExpiry = passwordPolicy.passwordExpiry;
+    r.requireComplexPassword = passwordPolicy.requireComplexPassword;
+    r.isDefaultPassword = passwordPolicy.isDefaultPassword;
+    r.passwordExpiryDays = passwordPolicy.passwordExpiryDays;
+    r.minPasswordLength = passwordPolicy.minPasswordLength;
+    r.passwordHistory = passwordPolicy.passwordHistory;
+    r.lastPasswordChange = passwordPolicy.lastPasswordChange;
+
+    strlcpy(r.ntpServer1, ntpConfig.ntpServer1, sizeof(r.ntpServer1));
+    strlcpy(r.ntpServer2, ntpConfig.ntpServer2, sizeof(r.ntpServer2));
+    strlcpy(r.ntpSubnet, ntpConfig.subnet, sizeof(r.ntpSubnet));
+    strlcpy(r.ntpGateway, ntpConfig.gateway, sizeof(r.ntpGateway));
+    strlcpy(r.ntpDNS, ntpConfig.dns, sizeof(r.ntpDNS));
+    r.timezone = ntpConfig.timezone;
+    r.ntpEnabled = ntpConfig.enabled;
+}
+
+// Kayıttan global'lere (yalnızca açılışta)
+static void applyRecord(const SettingsRecord& r) {
+    settings.local_IP = IPAddress(r.localIP);
+    settings.gateway = IPAddress(r.gateway);
+    settings.subnet = IPAddress(r.subnet);
+    settings.primaryDNS = IPAddress(r.primaryDNS);
+    settings.secondaryDNS = IPAddress(r.secondaryDNS);
+    settings.deviceName = r.deviceName;
+    settings.transformerStation = r.transformerStation;
+    settings.username = r.username;
+    settings.passwordSalt = r.passwordSalt;
+    settings.passwordHash = r.passwordHash;
+
+    passwordPolicy.firstLoginPasswordChange = r.firstLoginPasswordChange;
+    passwordPolicy.passwordExpiry = r.passwordExpiry;
+    passwordPolicy.requireComplexPassword = r.requireComplexPassword;
+    passwordPolicy.isDefaultPassword = r.isDefaultPassword;
+    passwordPolicy.passwordExpiryDays = r.passwordExpiryDays;
+    passwordPolicy.minPasswordLength = r.minPasswordLength;
+    passwordPolicy.passwordHistory = r.passwordHistory;
+    passwordPolicy.lastPasswordChange = r.lastPasswordChange;
+
+    strlcpy(ntpConfig.ntpServer1, r.ntpServer1, sizeof(ntpConfig.ntpServer1));
+    strlcpy(ntpConfig.ntpServer2, r.ntpServer2, sizeof(ntpConfig.ntpServer2));
+    strlcpy(ntpConfig.subnet, r.ntpSubnet, sizeof(ntpConfig.subnet));
+    strlcpy(ntpConfig.gateway, r.ntpGateway, sizeof(ntpConfig.gateway));
+    strlcpy(ntpConfig.dns, r.ntpDNS, sizeof(ntpConfig.dns));
+    ntpConfig.timezone = r.timezone;
+    ntpConfig.enabled = r.ntpEnabled;
+    ntpConfigured = r.ntpServer1[0] != '\0';
+
+    storedHashIterations = r.hashIterations;
+}
+
+static bool parseIP(const String& text, uint32_t& out) {
+    IPAddress ip;
+    if (!ip.fromString(text)) return false;
+    out = (uint32_t)ip;
+    return true;
+}
+
+// Tek seferlik taşıma: eski app-settings, pwd-policy, ntp-config ve crypto
+// namespace'leri okunur. Yalnızca hiç kayıt yokken çağrılır; bozuk kayıt eski
+// (bayat) ayarlarla değiştirilmez. Eski namespace'ler silinmez (geri dönüş için).
+static void readLegacyRecord(SettingsRecord& r) {
+    defaultRecord(r);
+    Preferences prefs;
+
+    if (prefs.begin("app-settings", true)) {
+        parseIP(prefs.getString("local_ip", ""), r.localIP);
+        parseIP(prefs.getString("gateway", ""), r.gateway);
+        parseIP(prefs.getString("subnet", ""), r.subnet);
+        if (!parseIP(prefs.getString("dns1", ""), r.primaryDNS)) {
+            parseIP(prefs.getString("dns", ""), r.primaryDNS);
+        }
+        parseIP(prefs.getString("dns2", ""), r.secondaryDNS);
+        copyText(r.deviceName, sizeof(r.deviceName), prefs.getString("dev_name", r.deviceName));
+        copyText(r.transformerStation, sizeof(r.transformerStation), prefs.getString("tm_name", r.transformerStation));
+        copyText(r.username, sizeof(r.username), prefs.getString("username", r.username));
+        copyText(r.passwordSalt, sizeof(r.passwordSalt), prefs.getString("p_salt", ""));
+        copyText(r.passwordHash, sizeof(r.passwordHash), prefs.getString("p_hash", ""));
+        prefs.end();
+    }
+
+    if (prefs.begin("pwd-policy", true)) {
+        r.firstLoginPasswordChange = prefs.getBool("first_change", true);
+        r.passwordExpiry = prefs.getBool("expiry", true);
+        r.passwordExpiryDays = prefs.getInt("expiry_days", 90);
+        r.minPasswordLength = prefs.getInt("min_length", 6);
+        r.requireComplexPassword = prefs.getBool("complex", true);
+        r.lastPasswordChange = prefs.getULong("last_change", 0);
+        r.isDefaultPassword = prefs.getBool("is_default", true);
+        r.passwordHistory = prefs.getInt("history", 3);
+        prefs.end();
+    }
+
+    if (prefs.begin("ntp-config", true)) {
+        copyText(r.ntpServer1, sizeof(r.ntpServer1), prefs.getString("ntp_server1", ""));
+        copyText(r.ntpServer2, sizeof(r.ntpServer2), prefs.getString("ntp_server2", ""));
+        copyText(r.ntpSubnet, sizeof(r.ntpSubnet), prefs.getString("subnet", "255.255.255.0"));
+        copyText(r.ntpGateway, sizeof(r.ntpGateway), prefs.getString("gateway", "192.168.1.1"));
+        copyText(r.ntpDNS, sizeof(r.ntpDNS), prefs.getString("dns", "8.8.8.8"));
+        r.timezone = prefs.getInt("timezone", 3);
+        r.ntpEnabled = prefs.getBool("enabled", true);
+        prefs.end();
+    }
+
+    if (prefs.begin("crypto", true)) {
+        r.hashIterations = prefs.getUInt("pbkdf2_iter", 0);
+        prefs.end();
+    }
+}
+
+enum StoredRecordState {
+    STORED_RECORD_OK,
+    STORED_RECORD_MISSING,   // Namespace veya anahtar yok: ilk açılış / taşıma
+    STORED_RECORD_CORRUPT    // Kayıt var ama okunamıyor
+};
+
+// Blob'u oku ve doğrula. Daha kısa (eski sürüm) kayıtlar varsayılanlarla tamamlanır.
+static StoredRecordState readStoredRecord(SettingsRecord& r) {
+    Preferences prefs;
+    if (!prefs.begin(SETTINGS_STORE_NAMESPACE, true)) return STORED_RECORD_MISSING;
+    bool exists = prefs.isKey(SETTINGS_STORE_KEY);
+    size_t length = exists ? prefs.getBytes(SETTINGS_STORE_KEY, &writeBuffer, sizeof(writeBuffer)) : 0;
+    prefs.end();
+    if (!exists) return STORED_RECORD_MISSING;
+
+    const SettingsBlobHeader& header = writeBuffer.header;
+    if (length < sizeof(header) || header.magic != SETTINGS_STORE_MAGIC) {
+        addLog("❌ Ayar kaydı başlığı geçersiz", ERROR, "SETTINGS");
+        return STORED_RECORD_CORRUPT;
+    }
+    if (header.length > sizeof(SettingsRecord) || length != sizeof(header) + header.length) {
+        addLog("❌ Ayar kaydı boyutu uyumsuz (v" + String(header.version) + ")", ERROR, "SETTINGS");
+        return STORED_RECORD_CORRUPT;
+    }
+    if (esp_rom_crc32_le(0, (const uint8_t*)&writeBuffer.record, header.length) != header.crc) {
+        addLog("❌ Ayar kaydı CRC hatası", ERROR, "SETTINGS");
+        return STORED_RECORD_CORRUPT;
+    }
+
+    defaultRecord(r);
+    memcpy(&r, &writeBuffer.record, header.length);
+    return STORED_RECORD_OK;
+}
+
+// Başarılıysa lastWritten güncellenir; başarısız yazımda flash'taki kayıt bilinmez
+static bool writeRecord(const SettingsRecord& r) {
+    writeBuffer.header.magic = SETTINGS_STORE_MAGIC;
+    writeBuffer.header.version = SETTINGS_STORE_VERSION;
+    writeBuffer.header.length = sizeof(SettingsRecord);
+    writeBuffer.record = r;
+    writeBuffer.header.crc = esp_rom_crc32_le(0, (const uint8_t*)&writeBuffer.record, sizeof(SettingsRecord));
+
+    Preferences prefs;
+    size_t written = 0;
+    if (prefs.begin(SETTINGS_STORE_NAMESPACE, false)) {
+        written = prefs.putBytes(SETTINGS_STORE_KEY, &writeBuffer, sizeof(writeBuffer));
+        prefs.end();
+    }
+
+    if (written != sizeof(writeBuffer)) {
+        addLog("❌ Ayar kaydı yazılamadı", ERROR, "SETTINGS");
+        return false;
+    }
+    lastWritten = r;
+    return true;
+}
+
+void initSettingsStore() {
+    if (writeMutex == NULL) {
+        writeMutex = xSemaphoreCreateMutex();
+    }
+
+    SettingsRecord record;
+    StoredRecordState state = readStoredRecord(record);
+    if (state == STORED_RECORD_OK) {
+        lastWritten = record;
+    } else if (state == STORED_RECORD_MISSING) {
+        readLegacyRecord(record);
+        stats.migrated = true;
+        if (writeRecord(record)) {
+            addLog("🗄️ Ayarlar tek kayda taşındı", INFO, "SETTINGS");
+        } else {
+            // Taşınan ayarlar RAM'de; uartTask yazımı yeniden dener
+            dirty = true;
+            dirtySince = millis();
+            lastChange = dirtySince;
+        }
+    } else {
+        // Bozuk kayıt: eski namespace'lerdeki bayat ayarlara dönülmez.
+        // Varsayılanlarla açılır; kayıt bir sonraki kaydetmede yenilenir.
+        defaultRecord(record);
+        memset(&lastWritten, 0, sizeof(lastWritten));
+        stats.corrupt = true;
+        addLog("🚨 Ayar kaydı bozuk! Cihaz VARSAYILAN ayarlarla (IP, kullanıcı, parola) açıldı", ERROR, "SETTINGS");
+    }
+
+    applyRecord(record);
+    pending = record;
+}
+
+void saveSettingsStore() {
+    // Anlık görüntü kilit dışında alınır; kilit altında yalnızca kopyalanır
+    SettingsRecord snapshot;
+    captureRecord(snapshot);
+
+    unsigned long now = millis();
+    portENTER_CRITICAL(&storeMux);
+    snapshot.hashIterations = storedHashIterations;
+    pending = snapshot;
+    if (!dirty) dirtySince = now;
+    dirty = true;
+    lastChange = now;
+    stats.saves++;
+    portEXIT_CRITICAL(&storeMux);
+
+    // Panel durum bölümü ve diğer okurlar bu sayaçla değişikliği fark eder
+    bumpDataVersion(DATA_SETTINGS);
+}
+
+static void writePending() {
+    if (xSemaphoreTake(writeMutex, pdMS_TO_TICKS(2000)) != pdTRUE) return;
+
+    static SettingsRecord record;
+    portENTER_CRITICAL(&storeMux);
+    bool due = dirty;
+    unsigned long since = dirtySince;
+    record = pending;
+    dirty = false;
+    portEXIT_CRITICAL(&storeMux);
+
+    if (due) {
+        if (memcmp(&record, &lastWritten, sizeof(record)) == 0) {
+            portENTER_CRITICAL(&storeMux);
+            stats.skipped++;
+            portEXIT_CRITICAL(&storeMux);
+        } else if (writeRecord(record)) {
+            portENTER_CRITICAL(&storeMux);
+            stats.writes++;
+            failed = false;
+            portEXIT_CRITICAL(&storeMux);
+        } else {
+            // Kayıt kirli kalır; araya yeni kayıt girdiyse onun zamanları korunur
+            unsigned long now = millis();
+            portENTER_CRITICAL(&storeMux);
+            if (!dirty) {
+                dirty = true;
+                dirtySince = since;
+            }
+            stats.failures++;
+            failed = true;
+            lastFailure = now;
+            portEXIT_CRITICAL(&storeMux);
+        }
+    }
+
+    xSemaphoreGive(writeMutex);
+}
+
+void processSettingsStore() {
+    unsigned long now = millis();
+    portENTER_CRITICAL(&storeMux);
+    bool due = dirty && (now - lastChange >= SETTINGS_WRITE_DELAY_MS ||
+                         now - dirtySince >= SETTINGS_WRITE_MAX_DELAY_MS);
+    if (failed && now - lastFailure < SETTINGS_WRITE_RETRY_MS) due = false;
+    portEXIT_CRITICAL(&storeMux);
+
+    if (due) writePending();
+}
+
+void flushSettingsStore() {
+    writePending();
+}
+
+void getStoredDeviceNames(String& deviceName, String& transformerStation) {
+    char name[sizeof(SettingsRecord::deviceName)];
+    char station[sizeof(SettingsRecord::transformerStation)];
+    portENTER_CRITICAL(&storeMux);
+    memcpy(name, pending.deviceName, sizeof(name));
+    memcpy(station, pending.transformerStation, sizeof(station));
+    portEXIT_CRITICAL(&storeMux);
+    name[sizeof(name) - 1] = '\0';
+    station[sizeof(station) - 1] = '\0';
+    deviceName = name;
+    transformerStation = station;
+}
+
+SettingsStoreStats getSettingsStoreStats() {
+    portENTER_CRITICAL(&storeMux);
+    SettingsStoreStats copy = stats;
+    copy.dirty = dirty;
+    portEXIT_CRITICAL(&storeMux);
+    return copy;
+}
+
+uint32_t getStoredHashIterations() {
+    return storedHashIterations;
+}
+
+void setStoredHashIterations(uint32_t iterations) {
+    portENTER_CRITICAL(&storeMux);
+    storedHashIterations = iterations;
+    portEXIT_CRITICAL(&storeMux);
+    saveSettingsStore();
+}
\ No newline at end of file
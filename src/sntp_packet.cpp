@@ -0,0 +1,54 @@
+// sntp_packet.cpp - SNTP yanıt paketinin oluşturulması (donanımdan bağımsız)
+#include "sntp_packet.h"
+#include <string.h>
+
+uint32_t sntpReadU32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+void sntpWriteU32(uint8_t* p, uint32_t value) {
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+// ESP32 sistem saati dsPIC gibi yerel saattedir; NTP UTC ister
+void sntpTimestamp(int64_t localSec, uint32_t usec, int32_t timezoneHours, uint32_t& sec, uint32_t& frac) {
+    int64_t utc = localSec - (int64_t)timezoneHours * 3600;
+    sec = (uint32_t)(utc + NTP_UNIX_OFFSET);
+    frac = (uint32_t)(((uint64_t)usec << 32) / 1000000);
+}
+
+bool sntpIsClientRequest(const uint8_t* packet, size_t length) {
+    if (length < NTP_PACKET_SIZE) return false;
+    uint8_t version = (packet[0] >> 3) & 0x07;
+    return (packet[0] & 0x07) == NTP_MODE_CLIENT && version >= 1 && version <= 4;
+}
+
+void sntpBuildResponse(uint8_t* packet, const SNTPHeader& header, uint32_t receiveSec, uint32_t receiveFrac) {
+    uint8_t version = (packet[0] >> 3) & 0x07;
+    uint8_t poll = packet[2];
+
+    // İstemcinin gönderme zamanı yanıtta "originate" olur
+    uint8_t originate[8];
+    memcpy(originate, packet + 40, 8);
+
+    memset(packet, 0, NTP_PACKET_SIZE);
+    packet[0] = ((header.synced ? NTP_LI_NONE : NTP_LI_ALARM) << 6) | (version << 3) | NTP_MODE_SERVER;
+    packet[1] = header.stratum;
+    packet[2] = poll;
+    packet[3] = (uint8_t)NTP_PRECISION;
+    sntpWriteU32(packet + 8, header.rootDispersion);
+    sntpWriteU32(packet + 12, header.referenceId);
+    sntpWriteU32(packet + 16, header.referenceSec);
+    sntpWriteU32(packet + 20, header.referenceFrac);
+    memcpy(packet + 24, originate, 8);
+    sntpWriteU32(packet + 32, receiveSec);
+    sntpWriteU32(packet + 36, receiveFrac);
+}
+
+void sntpSetTransmit(uint8_t* packet, uint32_t sec, uint32_t frac) {
+    sntpWriteU32(packet + 40, sec);
+    sntpWriteU32(packet + 44, frac);
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+// sntp_server.cpp - Disipline edilmiş yerel saatten SNTP yanıtları
+#include "sntp_server.h"
+#include "sntp_packet.h"
+#include "time_sync.h"
+#include "clock_discipline.h"
+#include "ntp_handler.h"
+#include "log_system.h"
+#include <lwip/sockets.h>
+#include <sys/time.h>
+
+static TaskHandle_t sntpTaskHandle = NULL;
+static volatile uint32_t requestCount = 0;
+static volatile uint32_t droppedCount = 0;
+
+// Yanıt başlığı alanları - her istekte hesaplanmasın diye saniyede bir tazelenir
+static SNTPHeader header = { false, NTP_STRATUM_UNSYNC, 0, 0, 0, 0 };
+
+static void ntpTimestamp(const struct timeval& tv, uint32_t& sec, uint32_t& frac) {
+    sntpTimestamp(tv.tv_sec, tv.tv_usec, ntpConfig.timezone, sec, frac);
+}
+
+static void refreshHeader() {
+    ClockDisciplineStatus clock = getClockDisciplineStatus();
+    unsigned long age = millis() - timeData.lastSync;
+    bool synced = timeData.isValid && clock.locked && age < SNTP_SYNC_MAX_AGE;
+
+    SNTPHeader next;
+    next.synced = synced;
+    next.stratum = synced ? SNTP_STRATUM_SYNCED : NTP_STRATUM_UNSYNC;
+
+    // Belirsizlik + son ölçümden bu yana olası sürüklenme (5 ppm)
+    uint64_t dispersionUs = clock.uncertaintyUs + (uint64_t)age * 5 / 1000;
+    next.rootDispersion = (uint32_t)min((dispersionUs << 16) / 1000000, (uint64_t)0xFFFFFFFF);
+
+    // Referans kimliği: dsPIC'in bağlı olduğu NTP sunucusu (IPv4), yoksa "DSPC"
+    IPAddress upstream;
+    if (ntpConfig.ntpServer1[0] && upstream.fromString(ntpConfig.ntpServer1)) {
+        next.referenceId = ((uint32_t)upstream[0] << 24) | ((uint32_t)upstream[1] << 16) |
+                           ((uint32_t)upstream[2] << 8) | upstream[3];
+    } else {
+        next.referenceId = ('D' << 24) | ('S' << 16) | ('P' << 8) | 'C';
+    }
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    now.tv_sec -= age / 1000;
+    ntpTimestamp(now, next.referenceSec, next.referenceFrac);
+
+    if (synced != header.synced) {
+        addLog(synced ? "✅ SNTP sunucusu senkron yanıt veriyor" : "⚠️ SNTP sunucusu senkron değil (LI=3)",
+               synced ? SUCCESS : WARN, "SNTP");
+    }
+    header = next;
+}
+
+static void sntpTask(void* parameter) {
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        addLog("❌ SNTP soketi açılamadı", ERROR, "SNTP");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(SNTP_PORT);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (struct sockaddr*)&local, sizeof(local)) < 0) {
+        addLog("❌ SNTP portu bağlanamadı: " + String(SNTP_PORT), ERROR, "SNTP");
+        close(sock);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // Beklerken de başlık saniyede bir tazelensin
+    struct timeval timeout = { 1, 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    addLog("🕐 SNTP sunucusu başlatıldı (UDP " + String(SNTP_PORT) + ")", SUCCESS, "SNTP");
+
+    uint8_t packet[NTP_PACKET_SIZE];
+    unsigned long windowStart = millis();
+    unsigned long lastRefresh = 0;
+    uint32_t windowCount = 0;
+    refreshHeader();
+
+    while (true) {
+        struct sockaddr_in client;
+        socklen_t clientLen = sizeof(client);
+        int len = recvfrom(sock, packet, sizeof(packet), 0, (struct sockaddr*)&client, &clientLen);
+
+        struct timeval received;
+        gettimeofday(&received, NULL);
+
+        unsigned long now = millis();
+        if (now - lastRefresh >= 1000) {
+            refreshHeader();
+            lastRefresh = now;
+        }
+        if (len < 0) continue;
+
+        // Sadece istemci modundaki (3) NTPv1-4 istekleri yanıtlanır
+        if (!sntpIsClientRequest(packet, len)) {
+            droppedCount++;
+            continue;
+        }
+
+        if (now - windowStart >= 1000) {
+            windowStart = now;
+            windowCount = 0;
+        }
+        if (++windowCount > SNTP_MAX_REQUESTS_PER_SEC) {
+            droppedCount++;
+            continue;
+        }
+
+        uint32_t sec, frac;
+        ntpTimestamp(received, sec, frac);
+        sntpBuildResponse(packet, header, sec, frac);
+
+        struct timeval transmit;
+        gettimeofday(&transmit, NULL);
+        ntpTimestamp(transmit, sec, frac);
+        sntpSetTransmit(packet, sec, frac);
+
+        sendto(sock, packet, NTP_PACKET_SIZE, 0, (struct sockaddr*)&client, clientLen);
+        requestCount++;
+    }
+}
+
+void initSNTPServer() {
+    if (sntpTaskHandle) return;
+    xTaskCreatePinnedToCore(sntpTask, "SNTP", 3072, NULL, SNTP_TASK_PRIORITY, &sntpTaskHandle, 0);
+}
+
+SNTPStats getSNTPStats() {
+    SNTPStats stats;
+    stats.running = sntpTaskHandle != NULL;
+    stats.synced = header.synced;
+    stats.stratum = header.stratum;
+    stats.requests = requestCount;
+    stats.dropped = droppedCount;
+    return stats;
+}
\ No newline at end of file
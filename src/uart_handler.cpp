@@ -1,7 +1,11 @@
 #include "uart_handler.h"
 #include "log_system.h"
 #include "settings.h"
+#include "dashboard_snapshot.h"
+#include "data_version.h"
+#include "route_metrics.h"
 #include <Preferences.h>
+#include <esp_timer.h>
 
 // UART Pin tanımlamaları
 #define UART_RX_PIN 4   // IO4 - RX2
@@ -24,6 +28,48 @@ bool uartHealthy = true;
 String lastResponse = "";
 UARTStatistics uartStats = {0, 0, 0, 0, 0, 100.0};
 
+// UART hattı kilidi (recursive: kilitli fonksiyonlar birbirini çağırabilir)
+static SemaphoreHandle_t uartMutex = NULL;
+static int uartLockDepth = 0;              // Sadece kilidi tutan task değiştirir
+static unsigned long uartLockStartUs = 0;  // En dıştaki kilit isteğinin zamanı (bekleme dahil)
+
+bool lockUART(unsigned long timeoutMs) {
+    if (uartMutex == NULL) return true; // initUART öncesi tek task çalışıyor
+
+    unsigned long waitStart = micros();
+    if (xSemaphoreTakeRecursive(uartMutex, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) {
+        addRouteUartTime(micros() - waitStart);
+        return false;
+    }
+    if (uartLockDepth++ == 0) {
+        uartLockStartUs = waitStart;
+    }
+    return true;
+}
+
+void unlockUART() {
+    if (uartMutex != NULL) {
+        // Route ölçümü: hatta geçen süre istek içindeyse o route'a yazılır
+        if (--uartLockDepth == 0) {
+            addRouteUartTime(micros() - uartLockStartUs);
+        }
+        xSemaphoreGiveRecursive(uartMutex);
+    }
+}
+
+// Fonksiyon kapsamı boyunca UART hattını tutan yardımcı. Kilit alınamazsa
+// (başka komut 5 sn'den uzun sürdü) çağıran hatta dokunmadan hata döner.
+class UARTLockGuard {
+public:
+    UARTLockGuard() : held(lockUART()) {
+        if (!held) addLog("⚠️ UART hattı meşgul, komut gönderilmedi", WARN, "UART");
+    }
+    ~UARTLockGuard() { if (held) unlockUART(); }
+    bool locked() const { return held; }
+private:
+    bool held;
+};
+
 // Buffer temizleme
 void clearUARTBuffer() {
     delay(50);
@@ -53,6 +99,9 @@ void updateUARTStats(bool success) {
 
 // UART reset
 void resetUART() {
+    UARTLockGuard guard;
+    if (!guard.locked()) return;
+    
     addLog("🔄 UART reset ediliyor...", WARN, "UART");
     
     UART_PORT.end();
@@ -79,6 +128,10 @@ void resetUART() {
 void initUART() {
     addLog("🚀 UART başlatılıyor...", INFO, "UART");
     
+    if (uartMutex == NULL) {
+        uartMutex = xSemaphoreCreateRecursiveMutex();
+    }
+    
     pinMode(UART_RX_PIN, INPUT);
     pinMode(UART_TX_PIN, OUTPUT);
     
@@ -100,6 +153,9 @@ void initUART() {
 
 // UART bağlantı testi
 bool testUARTConnection() {
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
+    
     addLog("🧪 UART bağlantısı test ediliyor...", INFO, "UART");
     
     if (UART_PORT.available()) {
@@ -253,10 +309,19 @@ String readFaultResponse(unsigned long timeout = 500) {
 
 // Özel komut gönderme
 bool sendCustomCommand(const String& command, String& response, unsigned long timeout) {
+    int64_t sentUs, receivedUs;
+    return sendTimedCommand(command, response, timeout, sentUs, receivedUs);
+}
+
+// Zaman damgaları kilit alındıktan sonra alınır; kilit beklemesi ölçüme girmez
+bool sendTimedCommand(const String& command, String& response, unsigned long timeout, int64_t& sentUs, int64_t& receivedUs) {
     if (command.length() == 0 || command.length() > 100) {
         return false;
     }
     
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
+    
     if (!uartHealthy) {
         resetUART();
     }
@@ -265,10 +330,12 @@ bool sendCustomCommand(const String& command, String& response, unsigned long ti
     
     UART_PORT.print(command);
     UART_PORT.flush();
+    sentUs = esp_timer_get_time();
     
     uartStats.totalFramesSent++;
     
     response = safeReadUARTResponse(timeout == 0 ? UART_TIMEOUT : timeout);
+    receivedUs = esp_timer_get_time();
     
     bool success = response.length() > 0;
     updateUARTStats(success);
@@ -301,6 +368,8 @@ bool sendBaudRateCommand(long baudRate) {
             return false;
     }
     
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
     clearUARTBuffer();
     
     UART_PORT.print(command);
@@ -331,6 +400,8 @@ bool sendBaudRateCommand(long baudRate) {
 
 // dsPIC'ten mevcut baudrate değerini al
 int getCurrentBaudRateFromDsPIC() {
+    UARTLockGuard guard;
+    if (!guard.locked()) return -1;
     clearUARTBuffer();
     
     // BN komutunu gönder
@@ -339,12 +410,12 @@ int getCurrentBaudRateFromDsPIC() {
     
     uartStats.totalFramesSent++;
     
-    addLog("📊 Mevcut baudrate sorgulanıyor (BN komutu)", DEBUG, "UART");
+    LOG_DEBUG("UART", "📊 Mevcut baudrate sorgulanıyor (BN komutu)");
     
     String response = safeReadUARTResponse(2000);
 
     if (response.length() >= 2 && response.charAt(0) == 'B') {
-        addLog("📥 Baudrate yanıtı: " + response, DEBUG, "UART");
+        LOG_DEBUG("UART", "📥 Baudrate yanıtı: %s", response.c_str());
         
         // ":" varsa ondan sonrasını al, yoksa eski formatı kullan
         int colonIndex = response.indexOf(':');
@@ -447,16 +518,18 @@ bool sendToSecondCard(const String& data) {
     
     // Debug için alınan veriyi göster
     if (response.length() > 0) {
-        addLog("İkinci karttan gelen: " + response, DEBUG, "UART3");
+        LOG_DEBUG("UART3", "İkinci karttan gelen: %s", response.c_str());
         
+#if LOG_COMPILE_LEVEL >= LOG_RANK_DEBUG
         // Hex formatında da göster
-        String hexDump = "Hex: ";
+        char hexDump[61];
+        size_t hexLength = 0;
         for (unsigned int i = 0; i < response.length() && i < 20; i++) {
-            char hex[4];
-            sprintf(hex, "%02X ", (unsigned char)response[i]);
-            hexDump += hex;
+            hexLength += snprintf(hexDump + hexLength, sizeof(hexDump) - hexLength, "%02X ", (unsigned char)response[i]);
         }
-        addLog(hexDump, DEBUG, "UART3");
+        hexDump[hexLength] = '\0';
+        LOG_DEBUG("UART3", "Hex: %s", hexDump);
+#endif
     }
     
     return false;
@@ -466,6 +539,8 @@ bool sendToSecondCard(const String& data) {
 
 // Toplam arıza sayısını al (AN komutu)
 int getTotalFaultCount() {
+    UARTLockGuard guard;
+    if (!guard.locked()) return 0;
     clearUARTBuffer();
     
     UART_PORT.print("AN");
@@ -473,12 +548,12 @@ int getTotalFaultCount() {
     
     uartStats.totalFramesSent++;
     
-    addLog("📊 Arıza sayısı sorgulanıyor (AN komutu)", DEBUG, "UART");
+    LOG_DEBUG("UART", "📊 Arıza sayısı sorgulanıyor (AN komutu)");
     
     String response = safeReadUARTResponse(2000);
     
     if (response.length() >= 2 && response.charAt(0) == 'A') {
-        addLog("📥 Gelen yanıt: " + response, DEBUG, "UART");
+        LOG_DEBUG("UART", "📥 Gelen yanıt: %s", response.c_str());
         
         // A'dan sonrasını sayıya çevir
         String numberStr = response.substring(1);  
@@ -490,6 +565,7 @@ int getTotalFaultCount() {
         if (actualFaultCount >= 0) {
             addLog("✅ Toplam arıza sayısı: " + String(actualFaultCount), SUCCESS, "UART");
             updateUARTStats(true);
+            notifyFaultCount(actualFaultCount);
             return actualFaultCount;
         }
     }
@@ -501,6 +577,8 @@ int getTotalFaultCount() {
 
 // Belirli bir arıza adresini sorgula
 bool requestSpecificFault(int faultNumber) {
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
     // Önceki veriyi temizle
     lastResponse = "";
     
@@ -561,17 +639,19 @@ String getLastFaultResponse() {
 
 // Test komutu gönder
 bool sendTestCommand(const String& testCmd) {
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
     clearUARTBuffer();
     
     UART_PORT.print(testCmd);
     UART_PORT.flush();
     
-    addLog("🧪 Test komutu gönderildi: " + testCmd, DEBUG, "UART");
+    LOG_DEBUG("UART", "🧪 Test komutu gönderildi: %s", testCmd.c_str());
     
     String response = safeReadUARTResponse(3000);
     
     if (response.length() > 0) {
-        addLog("📡 Test yanıtı: " + response, DEBUG, "UART");
+        LOG_DEBUG("UART", "📡 Test yanıtı: %s", response.c_str());
         return true;
     } else {
         addLog("❌ Test komutu için yanıt yok", WARN, "UART");
@@ -624,6 +704,8 @@ String getUARTStatus() {
 
 // dsPIC'teki tüm arızaları sil (tT komutu)
 bool deleteAllFaultsFromDsPIC() {
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
     clearUARTBuffer();
     
     // tT komutunu gönder
@@ -636,8 +718,11 @@ bool deleteAllFaultsFromDsPIC() {
     
     String response = safeReadUARTResponse(3000); // 3 saniye timeout
     
+    // Silme denendi - arıza listesi değişmiş olabilir, önbellekli ETag'leri geçersiz kıl
+    bumpDataVersion(DATA_FAULTS);
+    
     if (response.length() > 0) {
-        addLog("📥 tT komut yanıtı: " + response, DEBUG, "UART");
+        LOG_DEBUG("UART", "📥 tT komut yanıtı: %s", response.c_str());
         
         // Başarılı yanıt kontrolü
         if (response == "OK" || response == "ACK" || response.indexOf("DELETED") >= 0 || response.indexOf("CLEARED") >= 0) {
@@ -663,6 +748,9 @@ bool deleteAllFaultsFromDsPIC() {
 
 // Son N arıza kaydını al (performans optimizasyonlu)
 bool requestLastNFaults(int count, std::vector<String>& faultData) {
+    UARTLockGuard guard; // Toplu okuma boyunca hattı bırakma
+    if (!guard.locked()) return false;
+    
     // Önce toplam arıza sayısını al
     int totalFaults = getTotalFaultCount();
     
@@ -704,6 +792,8 @@ bool requestLastNFaults(int count, std::vector<String>& faultData) {
 
 // LED durumunu dsPIC'ten al (LN komutu)
 bool requestLEDStatus(String& ledResponse) {
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
     clearUARTBuffer();
     
     // LN komutunu gönder
@@ -712,7 +802,7 @@ bool requestLEDStatus(String& ledResponse) {
     
     uartStats.totalFramesSent++;
     
-    addLog("💡 LED durumu sorgulanıyor (LN komutu)", DEBUG, "UART");
+    LOG_DEBUG("UART", "💡 LED durumu sorgulanıyor (LN komutu)");
     
     // Hızlı timeout kullan (LED sorgusu hızlı olmalı)
     ledResponse = safeReadUARTResponse(UART_QUICK_TIMEOUT); // 500ms
@@ -720,7 +810,7 @@ bool requestLEDStatus(String& ledResponse) {
     if (ledResponse.length() > 0) {
         // Format kontrolü: "L:XXXX" olmalı
         if (ledResponse.startsWith("L:") && ledResponse.length() >= 6) {
-            addLog("✅ LED durumu alındı: " + ledResponse, DEBUG, "UART");
+            LOG_DEBUG("UART", "✅ LED durumu alındı: %s", ledResponse.c_str());
             updateUARTStats(true);
             lastUARTActivity = millis();
             return true;
@@ -736,6 +826,17 @@ bool requestLEDStatus(String& ledResponse) {
     return false;
 }
 
+#if LOG_COMPILE_LEVEL >= LOG_RANK_DEBUG
+// Bir baytı 8 haneli ikili metne çevirir (debug logları için)
+static const char* formatBits(uint8_t value, char out[9]) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (value & (0x80 >> i)) ? '1' : '0';
+    }
+    out[8] = '\0';
+    return out;
+}
+#endif
+
 // LED durumunu otomatik parse et ve detaylı bilgi döndür (eski format - backward compatibility)
 bool parseLEDStatus(const String& ledData, uint8_t& inputByte, uint8_t& outputByte) {
     uint8_t alarmByte = 0;
@@ -776,18 +877,22 @@ bool parseLEDStatus(const String& ledData, uint8_t& inputByte, uint8_t& outputBy
         alarmByte = (uint8_t)strtol(alarmHex.c_str(), NULL, 16);
 
         // Debug log (alarm dahil)
-        addLog("📊 LED Parse: IN=0x" + String(inputByte, HEX) +
-               " (0b" + String(inputByte, BIN) + "), OUT=0x" + String(outputByte, HEX) +
-               " (0b" + String(outputByte, BIN) + "), ALARM=0x" + String(alarmByte, HEX) +
-               " (0b" + String(alarmByte, BIN) + ")", DEBUG, "UART");
+#if LOG_COMPILE_LEVEL >= LOG_RANK_DEBUG
+        char inBits[9], outBits[9], alarmBits[9];
+        LOG_DEBUG("UART", "📊 LED Parse: IN=0x%02X (0b%s), OUT=0x%02X (0b%s), ALARM=0x%02X (0b%s)",
+                  inputByte, formatBits(inputByte, inBits), outputByte, formatBits(outputByte, outBits),
+                  alarmByte, formatBits(alarmByte, alarmBits));
+#endif
     } else {
         // Eski format, alarm yok
         alarmByte = 0;
 
         // Debug log (alarm olmadan)
-        addLog("📊 LED Parse: IN=0x" + String(inputByte, HEX) +
-               " (0b" + String(inputByte, BIN) + "), OUT=0x" + String(outputByte, HEX) +
-               " (0b" + String(outputByte, BIN) + ")", DEBUG, "UART");
+#if LOG_COMPILE_LEVEL >= LOG_RANK_DEBUG
+        char inBits[9], outBits[9];
+        LOG_DEBUG("UART", "📊 LED Parse: IN=0x%02X (0b%s), OUT=0x%02X (0b%s)",
+                  inputByte, formatBits(inputByte, inBits), outputByte, formatBits(outputByte, outBits));
+#endif
     }
 
     return true;
@@ -870,6 +975,8 @@ String getLEDStatusReadable() {
 
 // NTP ayarlarını dsPIC'ten oku (XN komutu)
 bool requestNTPFromDsPIC(String& ntp1, String& ntp2) {
+    UARTLockGuard guard;
+    if (!guard.locked()) return false;
     clearUARTBuffer();
     
     // XN komutunu gönder
@@ -878,12 +985,12 @@ bool requestNTPFromDsPIC(String& ntp1, String& ntp2) {
     
     uartStats.totalFramesSent++;
     
-    addLog("📡 NTP ayarları dsPIC'ten sorgulanıyor (XN komutu)", DEBUG, "UART");
+    LOG_DEBUG("UART", "📡 NTP ayarları dsPIC'ten sorgulanıyor (XN komutu)");
     
     String response = safeReadUARTResponse(2000);
     
     if (response.length() > 0 && response.startsWith("X:")) {
-        addLog("📥 NTP yanıtı: " + response, DEBUG, "UART");
+        LOG_DEBUG("UART", "📥 NTP yanıtı: %s", response.c_str());
         
         // Format: X:19216800011801921680002180
         // X: sonrası 26 karakter olmalı (192168001180 + 192168000218 + 0)
@@ -972,7 +1079,7 @@ bool sendNTPToSecondCardOnly(const String& ntp1, const String& ntp2) {
         for (int retry = 0; retry < 3 && !sent1; retry++) {
             if (retry > 0) {
                 delay(100);
-                addLog("NTP1 Part1 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "UART3");
+                LOG_DEBUG("UART3", "NTP1 Part1 tekrar deneniyor (%d/3)", retry + 1);
             }
             
             if (sendToSecondCard(cmd1)) {
@@ -994,7 +1101,7 @@ bool sendNTPToSecondCardOnly(const String& ntp1, const String& ntp2) {
         for (int retry = 0; retry < 3 && !sent2; retry++) {
             if (retry > 0) {
                 delay(100);
-                addLog("NTP1 Part2 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "UART3");
+                LOG_DEBUG("UART3", "NTP1 Part2 tekrar deneniyor (%d/3)", retry + 1);
             }
             
             if (sendToSecondCard(cmd2)) {
@@ -1045,7 +1152,7 @@ bool sendNTPToSecondCardOnly(const String& ntp1, const String& ntp2) {
             for (int retry = 0; retry < 3 && !sent3; retry++) {
                 if (retry > 0) {
                     delay(100);
-                    addLog("NTP2 Part1 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "UART3");
+                    LOG_DEBUG("UART3", "NTP2 Part1 tekrar deneniyor (%d/3)", retry + 1);
                 }
                 
                 if (sendToSecondCard(cmd3)) {
@@ -1067,7 +1174,7 @@ bool sendNTPToSecondCardOnly(const String& ntp1, const String& ntp2) {
             for (int retry = 0; retry < 3 && !sent4; retry++) {
                 if (retry > 0) {
                     delay(100);
-                    addLog("NTP2 Part2 tekrar deneniyor (" + String(retry + 1) + "/3)", DEBUG, "UART3");
+                    LOG_DEBUG("UART3", "NTP2 Part2 tekrar deneniyor (%d/3)", retry + 1);
                 }
                 
                 if (sendToSecondCard(cmd4)) {
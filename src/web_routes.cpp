@@ -5,39 +5,42 @@
 #include "ntp_handler.h"
 #include "uart_handler.h"
 #include "log_system.h"
+#include "log_journal.h"
 #include "backup_restore.h"
 #include "password_policy.h"
+#include "crypto_utils.h"
+#include "client_limiter.h"
 #include <LittleFS.h>
 #include <WebServer.h>
 #include <ArduinoJson.h>
-#include <Preferences.h>
+#include "settings_store.h"
+#include "network_config.h"
 #include <ESPmDNS.h>
+#include <esp_rom_crc.h>
+#include <lwip/sockets.h>
 #include "datetime_handler.h"
 #include "fault_parser.h"
+#include "event_stream.h"
+#include "dashboard_snapshot.h"
+#include "route_metrics.h"
+#include "log_tail.h"
+#include "notification_feed.h"
 #include <vector>  // std::vector için
 
+// Arıza sayısı bu süreden yeniyse koşullu GET dsPIC'e sormadan 304 dönebilir
+#define FAULT_VERIFY_MS 15000
+
 extern DateTimeData datetimeData;
 
 // UART istatistikleri - extern olarak kullan (uart_handler.cpp'de tanımlı)
 extern UARTStatistics uartStats;  // DÜZELTME: Burada tanımlama değil, extern kullanım
 
-// Log sistemi - YENİ YAPIYLA
-extern std::vector<LogEntry> logStorage;  // Artık vector kullanıyoruz
-
-// Rate limiting için global değişkenler
-struct RateLimitData {
-    IPAddress clientIP;
-    unsigned long requests[20];
-    int requestIndex = 0;
-    unsigned long lastReset = 0;
-};
-RateLimitData rateLimitData;
+// Log sistemi - dairesel tampon (log_system.h)
 
 // Diğer extern tanımlamalar
-extern String getCurrentDateTime();
 extern String getUptime();
 extern bool isTimeSynced();
-extern WebServer server;
+extern MeteredWebServer server;
 extern Settings settings;
 extern bool ntpConfigured;
 extern PasswordPolicy passwordPolicy;
@@ -47,6 +50,16 @@ static FaultRecord faultRecords[100]; // Maksimum 100 arıza kaydı
 static int faultCount = 0;
 
 
+// WiFiClient::write gönderim penceresi dolunca saniyelerce bekler; burada
+// soket MSG_DONTWAIT ile yazılır ve kısa yazım hata sayılır
+bool writeClientNonBlocking(WiFiClient& client, const char* data, size_t length) {
+    if (!client.connected()) return false;
+    int fd = client.fd();
+    if (fd < 0) return false;
+    ssize_t sent = send(fd, data, length, MSG_DONTWAIT);
+    return sent == (ssize_t)length;
+}
+
 // Security headers ekle
 void addSecurityHeaders() {
     server.sendHeader("X-Content-Type-Options", "nosniff");
@@ -59,26 +72,13 @@ void addSecurityHeaders() {
     server.sendHeader("Accept-Encoding", "gzip, deflate");
 }
 
-// Rate limiting kontrolü
+// Rate limiting kontrolü - her istemcinin kendi token bucket'ı var
 bool checkRateLimit() {
     IPAddress clientIP = server.client().remoteIP();
-    unsigned long now = millis();
-    
-    // Farklı IP veya 1 dakika geçmişse sıfırla
-    if (clientIP != rateLimitData.clientIP || now - rateLimitData.lastReset > 60000) {
-        rateLimitData.clientIP = clientIP;
-        rateLimitData.requestIndex = 0;
-        rateLimitData.lastReset = now;
-    }
-    
-    // 1 dakikada 60 istekten fazlasına izin verme
-    if (rateLimitData.requestIndex >= 20) {
-        addLog("⚠️ Rate limit aşıldı: " + clientIP.toString(), WARN, "SECURITY");
-        return false;
-    }
-    
-    rateLimitData.requests[rateLimitData.requestIndex++] = now;
-    return true;
+    if (clientAllowRequest(clientIP)) return true;
+
+    addLog("⚠️ Rate limit aşıldı: " + clientIP.toString(), WARN, "SECURITY");
+    return false;
 }
 
 // Device Info API
@@ -98,18 +98,13 @@ void handleDeviceInfoAPI() {
     server.send(200, "application/json", output);
 }
 
+extern TaskHandle_t webTaskHandle;
+extern TaskHandle_t uartTaskHandle;
+
 // System Info API (Auth gerekli)
 void handleSystemInfoAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
-    // Rate limiting
-    if (!checkRateLimit()) {
-        server.send(429, "application/json", "{\"error\":\"Too many requests\"}");
-        return;
-    }
+    // Sistem bilgisi dashboard işiyle aynı aralıkta örneklenir
+    if (handleConditionalGet(DATA_SYSTEM)) return;
     
     JsonDocument doc;
     
@@ -127,6 +122,10 @@ void handleSystemInfoAPI() {
     doc["memory"]["minFreeHeap"] = ESP.getMinFreeHeap();
     doc["memory"]["maxAllocHeap"] = ESP.getMaxAllocHeap();
     
+    // Task yığınlarında açılıştan beri en az kalan alan (bayt)
+    if (webTaskHandle != NULL) doc["tasks"]["webStackFree"] = uxTaskGetStackHighWaterMark(webTaskHandle);
+    if (uartTaskHandle != NULL) doc["tasks"]["uartStackFree"] = uxTaskGetStackHighWaterMark(uartTaskHandle);
+    
     // Software info
     doc["software"]["version"] = "5.2";
     doc["software"]["sdk"] = ESP.getSdkVersion();
@@ -148,6 +147,15 @@ void handleSystemInfoAPI() {
     doc["filesystem"]["used"] = usedBytes;
     doc["filesystem"]["free"] = totalBytes - usedBytes;
     
+    // Ayar kaydı yazım istatistikleri
+    SettingsStoreStats store = getSettingsStoreStats();
+    doc["settingsStore"]["saves"] = store.saves;
+    doc["settingsStore"]["writes"] = store.writes;
+    doc["settingsStore"]["skipped"] = store.skipped;
+    doc["settingsStore"]["failures"] = store.failures;
+    doc["settingsStore"]["corrupt"] = store.corrupt;
+    doc["settingsStore"]["pending"] = store.dirty;
+    
     String output;
     serializeJson(doc, output);
     
@@ -157,11 +165,6 @@ void handleSystemInfoAPI() {
 
 // Network Configuration API - GET (değişiklik yok)
 void handleGetNetworkAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     addSecurityHeaders();
     
     JsonDocument doc;
@@ -183,6 +186,14 @@ void handleGetNetworkAPI() {
     doc["dhcp"] = false;
     doc["mode"] = "static";
     
+    // Canlı değişiklik onay bekliyorsa
+    StaticNetworkConfig pending;
+    unsigned long remainingMs;
+    if (getPendingNetworkChange(pending, remainingMs)) {
+        doc["pending"]["ip"] = pending.ip.toString();
+        doc["pending"]["remaining"] = remainingMs / 1000;
+    }
+    
     String output;
     serializeJson(doc, output);
     
@@ -191,11 +202,6 @@ void handleGetNetworkAPI() {
 
 // Network Configuration API - POST (Sadece Statik IP versiyonu)
 void handlePostNetworkAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     addSecurityHeaders();
     
     // Form'dan gelen değerler - ipMode kontrolü kaldırıldı, her zaman static
@@ -243,31 +249,20 @@ void handlePostNetworkAPI() {
             return;
         }
     }
-     // Settings'e kaydet
-    Preferences prefs;
-    prefs.begin("app-settings", false);
-    prefs.putString("local_ip", staticIP);
-    prefs.putString("gateway", gateway);
-    prefs.putString("subnet", subnet);
-    prefs.putString("dns1", dns1);
-    
-    if (dns2.length() > 0) {
-        prefs.putString("dns2", dns2);
-    }
+    // Yeni ayar canlı uygulanır; kayıt ancak yeni adresten onay gelince yapılır
+    StaticNetworkConfig next;
+    next.ip = testIP;
+    next.gateway = testGW;
+    next.subnet = testSubnet;
+    next.dns1 = testDNS1;
+    next.dns2 = dns2.length() > 0 ? testDNS2 : settings.secondaryDNS;
     
-    prefs.end();
-    
-    // Global settings güncelle
-    settings.local_IP.fromString(staticIP);
-    settings.gateway.fromString(gateway);
-    settings.subnet.fromString(subnet);
-    settings.primaryDNS.fromString(dns1);
-    
-    if (dns2.length() > 0) {
-        settings.secondaryDNS.fromString(dns2);
+    if (!requestNetworkChange(next)) {
+        server.send(409, "application/json", "{\"error\":\"Onay bekleyen bir ağ değişikliği var\"}");
+        return;
     }
     
-    addLog("✅ Statik IP ayarları kaydedildi: " + staticIP, SUCCESS, "NETWORK");
+    addLog("🌐 Ağ ayarı değişikliği istendi: " + staticIP, INFO, "NETWORK");
     addLog("  Gateway: " + gateway, INFO, "NETWORK");
     addLog("  Subnet: " + subnet, INFO, "NETWORK");
     addLog("  DNS1: " + dns1, INFO, "NETWORK");
@@ -279,84 +274,94 @@ void handlePostNetworkAPI() {
     // Başarılı yanıt
     JsonDocument response;
     response["success"] = true;
-    response["message"] = "Statik IP ayarları kaydedildi. Cihaz yeniden başlatılıyor...";
+    response["message"] = "Ağ ayarları uygulanıyor. Yeni adresten giriş yapıp onaylayın, aksi halde önceki ayara dönülecek.";
     response["newIP"] = staticIP;
+    response["confirmTimeout"] = NETWORK_CONFIRM_TIMEOUT_MS / 1000;
     
     String output;
     serializeJson(response, output);
     
     server.send(200, "application/json", output);
-    
-    // 2 saniye bekle ve restart et
-    delay(2000);
-    ESP.restart();
 }
 
-// Notification API
-void handleNotificationAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+// Canlı ağ değişikliğini onayla - yalnızca yeni adrese gelen istekle
+void handleConfirmNetworkAPI() {
+    addSecurityHeaders();
+    
+    StaticNetworkConfig pending;
+    unsigned long remainingMs;
+    if (!getPendingNetworkChange(pending, remainingMs)) {
+        server.send(409, "application/json", "{\"error\":\"Onay bekleyen ağ değişikliği yok\"}");
         return;
     }
     
-    JsonDocument doc;
-    JsonArray notifications = doc.to<JsonArray>();
-    
-    // Son kritik logları bildirim olarak göster - YENİ YAPI İLE
-    int notificationCount = 0;
-    
-    // logStorage vector'ünden son hataları al
-    for (auto it = logStorage.rbegin(); it != logStorage.rend() && notificationCount < 10; ++it) {
-        if (it->level == ERROR || it->level == WARN) {
-            JsonObject notif = notifications.add<JsonObject>();
-            notif["id"] = notificationCount;
-            notif["type"] = (it->level == ERROR) ? "error" : "warning";
-            notif["message"] = it->message;
-            notif["time"] = it->timestamp;
-            notif["read"] = false;
-            notificationCount++;
-        }
+    if (!confirmNetworkChange(server.client().localIP())) {
+        server.send(403, "application/json", "{\"error\":\"Onay yeni adres (" + pending.ip.toString() + ") üzerinden yapılmalı\"}");
+        return;
     }
     
-    doc["count"] = notificationCount;
-    
-    String output;
-    serializeJson(doc, output);
-    
-    addSecurityHeaders();
-    server.send(200, "application/json", output);
+    server.send(200, "application/json", "{\"success\":true}");
 }
 
 // System Reboot API
 void handleSystemRebootAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     addLog("🔄 Sistem yeniden başlatılıyor...", WARN, "SYSTEM");
     server.send(200, "application/json", "{\"success\":true,\"message\":\"Sistem 3 saniye içinde yeniden başlatılacak\"}");
     
     delay(3000);
+    flushSettingsStore();
+    flushLogJournal();
     ESP.restart();
 }
 
-// DateTime bilgisi çek - GET /api/datetime
-void handleGetDateTimeAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+// Parola özeti mikro-karşılaştırması - GET /api/system/hash-benchmark?kb=64
+void handleHashBenchmarkAPI() {
+    int kb = server.hasArg("kb") ? server.arg("kb").toInt() : 64;
+    kb = constrain(kb, 1, 128);
+
+    HashBenchmark result;
+    if (!runHashBenchmark(kb * 1024, result)) {
+        addSecurityHeaders();
+        server.send(503, "application/json", "{\"error\":\"Karşılaştırma tamponu ayrılamadı\"}");
         return;
     }
-    
+
+    JsonDocument doc;
+    doc["bytes"] = result.bytes;
+    doc["softwareKBps"] = result.softwareKBps;
+    doc["hardwareKBps"] = result.hardwareKBps;
+    doc["speedup"] = result.softwareKBps > 0 ? result.hardwareKBps / result.softwareKBps : 0;
+    doc["pbkdf2Iterations"] = result.iterations;
+    doc["pbkdf2Ms"] = result.pbkdf2Ms;
+
+    String output;
+    serializeJson(doc, output);
+
+    addSecurityHeaders();
+    server.send(200, "application/json", output);
+}
+
+// dsPIC okumasını ekran biçimleriyle JSON'a ekle
+static void addDateTimeJSON(JsonDocument& doc, const CivilTime& value) {
+    char buffer[CIVIL_WIRE_SIZE];
+    bool valid = value.isValid();
+    formatDisplayDate(value, buffer, sizeof(buffer));
+    doc["date"] = valid ? buffer : "";
+    formatIsoTime(value, buffer, sizeof(buffer));
+    doc["time"] = valid ? buffer : "";
+    formatDsPICDateTime(value, buffer, sizeof(buffer));
+    doc["rawData"] = valid ? buffer : "";
+}
+
+// DateTime bilgisi çek - GET /api/datetime
+void handleGetDateTimeAPI() {
     addSecurityHeaders();
     
     JsonDocument doc;
     
     // Mevcut datetime verisi
     doc["isValid"] = isDateTimeDataValid();
-    doc["date"] = datetimeData.date;
-    doc["time"] = datetimeData.time;
-    doc["rawData"] = datetimeData.rawData;
+    addDateTimeJSON(doc, datetimeData.value);
     
     if (datetimeData.lastUpdate > 0) {
         unsigned long elapsed = (millis() - datetimeData.lastUpdate) / 1000;
@@ -368,7 +373,9 @@ void handleGetDateTimeAPI() {
     }
     
     // ESP32 sistem saati
-    doc["esp32DateTime"] = getCurrentESP32DateTime();
+    char espDateTime[CIVIL_DATETIME_SIZE + 8];
+    getCurrentESP32DateTime(espDateTime, sizeof(espDateTime));
+    doc["esp32DateTime"] = espDateTime;
     
     String output;
     serializeJson(doc, output);
@@ -378,11 +385,6 @@ void handleGetDateTimeAPI() {
 
 // DateTime bilgisi güncelle - POST /api/datetime/fetch  
 void handleFetchDateTimeAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     addSecurityHeaders();
     
     addLog("DateTime bilgisi dsPIC'ten çekiliyor...", INFO, "DATETIME");
@@ -394,9 +396,7 @@ void handleFetchDateTimeAPI() {
     
     if (success) {
         doc["message"] = "Tarih-saat bilgisi başarıyla güncellendi";
-        doc["date"] = datetimeData.date;
-        doc["time"] = datetimeData.time;
-        doc["rawData"] = datetimeData.rawData;
+        addDateTimeJSON(doc, datetimeData.value);
     } else {
         doc["message"] = "Tarih-saat bilgisi alınamadı";
         doc["error"] = "dsPIC'ten yanıt alınamadı veya format geçersiz";
@@ -410,11 +410,6 @@ void handleFetchDateTimeAPI() {
 
 // DateTime ayarla - POST /api/datetime/set
 void handleSetDateTimeAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     addSecurityHeaders();
     
     String manualDate = server.arg("manualDate");  // Format: 2025-02-27
@@ -426,14 +421,15 @@ void handleSetDateTimeAPI() {
         return;
     }
     
-    if (!validateDateTime(manualDate, manualTime)) {
+    CivilTime value;
+    if (!parseIsoDateTime(manualDate.c_str(), manualTime.c_str(), value)) {
         server.send(400, "application/json", "{\"error\":\"Geçersiz tarih veya saat formatı\"}");
         return;
     }
     
     addLog("Manual tarih-saat ayarlanıyor: " + manualDate + " " + manualTime, INFO, "DATETIME");
     
-    bool success = setDateTimeToDsPIC(manualDate, manualTime);
+    bool success = setDateTimeToDsPIC(value);
     
     JsonDocument doc;
     doc["success"] = success;
@@ -442,8 +438,11 @@ void handleSetDateTimeAPI() {
         doc["message"] = "Tarih-saat başarıyla ayarlandı";
         doc["setDate"] = manualDate;
         doc["setTime"] = manualTime;
-        doc["timeCommand"] = formatTimeCommand(manualTime);
-        doc["dateCommand"] = formatDateCommand(manualDate);
+        char command[CIVIL_COMMAND_SIZE];
+        formatDsPICTimeCommand(value, command, sizeof(command));
+        doc["timeCommand"] = command;
+        formatDsPICDateCommand(value, command, sizeof(command));
+        doc["dateCommand"] = command;
     } else {
         doc["message"] = "Tarih-saat ayarlanamadı";
         doc["error"] = "Komut gönderimi başarısız";
@@ -477,50 +476,90 @@ void updateMDNS() {
     }
 }
 
-void serveStaticFile(const String& path, const String& contentType) {
-    // Cache headers ekle
-    String cacheControl = "public, max-age=";
-    if (path.endsWith(".css") || path.endsWith(".js")) {
-        cacheControl += "604800"; // 7 gün
-        server.sendHeader("Cache-Control", cacheControl);
-    } else if (path.endsWith(".html")) {
-        cacheControl += "3600"; // 1 saat
-        server.sendHeader("Cache-Control", cacheControl);
+// İstemcinin If-None-Match başlığı alanın güncel ETag'i ile aynı mı?
+bool clientHasCurrentVersion(DataDomain domain) {
+    if (!server.hasHeader("If-None-Match")) return false;
+    return server.header("If-None-Match") == getDataETag(domain);
+}
+
+void sendNotModified(DataDomain domain) {
+    server.sendHeader("ETag", getDataETag(domain));
+    server.sendHeader("Cache-Control", "no-cache");
+    server.send(304);
+}
+
+// Eşleşirse 304 gönderir ve true döner; aksi halde yanıta ETag ekler,
+// çağıran dokümanı normal şekilde oluşturur
+bool handleConditionalGet(DataDomain domain) {
+    if (clientHasCurrentVersion(domain)) {
+        sendNotModified(domain);
+        return true;
+    }
+    server.sendHeader("ETag", getDataETag(domain));
+    server.sendHeader("Cache-Control", "no-cache");
+    return false;
+}
+
+// Statik dosya ETag'i: boyut + içerik CRC32'si. Dosyalar yalnızca dosya sistemi
+// yeniden yüklenince (yeniden başlatmayla) değişir; özet yol başına bir kez hesaplanır.
+struct StaticETag {
+    String path;
+    String etag;
+};
+static std::vector<StaticETag> staticETags;
+
+static String staticFileETag(const String& path, File& file) {
+    for (const StaticETag& entry : staticETags) {
+        if (entry.path == path) return entry.etag;
     }
     
-    // ETag desteği için basit bir hash
-    String etag = "\"" + String(path.length()) + "-" + String(LittleFS.totalBytes()) + "\"";
-    server.sendHeader("ETag", etag);
-    
-    // Client ETag kontrolü
-    if (server.hasHeader("If-None-Match")) {
-        String clientEtag = server.header("If-None-Match");
-        if (clientEtag == etag) {
-            server.send(304); // Not Modified
-            return;
-        }
+    uint8_t buffer[512];
+    uint32_t crc = 0;
+    size_t got;
+    while ((got = file.read(buffer, sizeof(buffer))) > 0) {
+        crc = esp_rom_crc32_le(crc, buffer, got);
     }
+    file.seek(0);
     
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%x-%08x\"", (unsigned)file.size(), (unsigned)crc);
+    staticETags.push_back({ path, String(etag) });
+    return String(etag);
+}
+
+void serveStaticFile(const String& path, const String& contentType) {
     // Gzip kontrolü - ÖNCELİKLİ
     String pathWithGz = path + ".gz";
-    if (LittleFS.exists(pathWithGz)) {
-        File file = LittleFS.open(pathWithGz, "r");
-        server.sendHeader("Content-Encoding", "gzip");
-        server.sendHeader("Vary", "Accept-Encoding");
-        server.streamFile(file, contentType);
-        file.close();
+    bool gzip = LittleFS.exists(pathWithGz);
+    if (!gzip && !LittleFS.exists(path)) {
+        server.send(404, "text/plain", "404: Not Found");
         return;
     }
-
-    // Normal dosya
-    if (LittleFS.exists(path)) {
-        File file = LittleFS.open(path, "r");
-        server.streamFile(file, contentType);
+    
+    File file = LittleFS.open(gzip ? pathWithGz : path, "r");
+    if (!file) {
+        server.send(404, "text/plain", "404: Not Found");
+        return;
+    }
+    
+    // İçerik ETag'i ile her yüklemede doğrulanır; dosya değişmediyse 304 döner
+    String etag = staticFileETag(gzip ? pathWithGz : path, file);
+    server.sendHeader("ETag", etag);
+    server.sendHeader("Cache-Control", "no-cache");
+    
+    // Client ETag kontrolü
+    if (server.hasHeader("If-None-Match") && server.header("If-None-Match") == etag) {
         file.close();
+        server.send(304); // Not Modified
         return;
     }
-
-    server.send(404, "text/plain", "404: Not Found");
+    
+    if (gzip) {
+        server.sendHeader("Content-Encoding", "gzip");
+        server.sendHeader("Vary", "Accept-Encoding");
+    }
+    server.streamFile(file, contentType);
+    file.close();
 }
 
 
@@ -531,31 +570,47 @@ String getUptime() {
     return String(buffer);
 }
 
-// API Handler'lar
-void handleStatusAPI() {
-    if (!checkSession()) {
-        server.send(401, "text/plain", "Unauthorized");
-        return;
-    }
-    
+// Durum JSON'u (API ve push kanalı ortak kullanır)
+String buildStatusJSON() {
     JsonDocument doc;
-    doc["datetime"] = getCurrentDateTime();
+    char datetime[CIVIL_DATETIME_SIZE];
+    formatIsoDateTime(civilNow(), datetime, sizeof(datetime));
+    doc["datetime"] = datetime;
     doc["uptime"] = getUptime();
-    doc["deviceName"] = settings.deviceName;
-    doc["tmName"] = settings.transformerStation;
+    doc["uptimeSeconds"] = millis() / 1000;
+    // Panel görüntüsü uartTask'ta üretilir: adlar ayar kaydının anlık görüntüsünden
+    String deviceName, tmName;
+    getStoredDeviceNames(deviceName, tmName);
+    doc["deviceName"] = deviceName;
+    doc["tmName"] = tmName;
     doc["deviceIP"] = ETH.localIP().toString();
     doc["ethernetStatus"] = ETH.linkUp();
     doc["timeSynced"] = isTimeSynced();
     doc["freeHeap"] = ESP.getFreeHeap();
     doc["totalHeap"] = ESP.getHeapSize();
 
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+// API Handler'lar
+void handleStatusAPI() {
+    server.send(200, "application/json", buildStatusJSON());
+}
+
+// Oturum canlı tutma - GET /api/session/refresh
+void handleSessionRefresh() {
+    JsonDocument doc;
+    doc["success"] = true;
+    doc["timeoutSeconds"] = settings.SESSION_TIMEOUT / 1000;
+    
     String output;
     serializeJson(doc, output);
     server.send(200, "application/json", output);
 }
 
 void handleGetSettingsAPI() {
-    if (!checkSession()) { server.send(401); return; }
     JsonDocument doc;
     doc["deviceName"] = settings.deviceName;
     doc["tmName"] = settings.transformerStation;
@@ -566,7 +621,6 @@ void handleGetSettingsAPI() {
 }
 
 void handlePostSettingsAPI() {
-    if (!checkSession()) { server.send(401); return; }
     if (saveSettings(server.arg("deviceName"), server.arg("tmName"), server.arg("username"), server.arg("password"))) {
         server.send(200, "text/plain", "OK");
     } else {
@@ -576,8 +630,9 @@ void handlePostSettingsAPI() {
 
 // YENİ: Arıza sayısını al API'si
 void handleGetFaultCountAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+    // Sayı yakın zamanda doğrulandıysa ve istemcide güncel sürüm varsa dsPIC'e sorma
+    if (getFaultCountAge() < FAULT_VERIFY_MS && clientHasCurrentVersion(DATA_FAULTS)) {
+        sendNotModified(DATA_FAULTS);
         return;
     }
     
@@ -585,6 +640,9 @@ void handleGetFaultCountAPI() {
     
     int count = getTotalFaultCount(); // uart_handler.cpp'deki yeni fonksiyon
     
+    // Sorgu sürümü güncelledi; sayı değişmediyse dokümanı oluşturma
+    if (handleConditionalGet(DATA_FAULTS)) return;
+    
     JsonDocument doc;
     doc["success"] = (count > 0);
     doc["count"] = count;
@@ -601,11 +659,6 @@ void handleGetFaultCountAPI() {
 
 // YENİ: Belirli bir arıza kaydını al
 void handleGetSpecificFaultAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     String faultNoStr = server.arg("faultNo");
     if (faultNoStr.length() == 0) {
         server.send(400, "application/json", "{\"error\":\"faultNo parameter required\"}");
@@ -642,11 +695,6 @@ void handleGetSpecificFaultAPI() {
 }
 // dsPIC'teki arızaları sil API'si
 void handleDeleteFaultsFromDsPICAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     addLog("🗑️ dsPIC arıza silme isteği alındı", INFO, "API");
     
     // tT komutu gönder
@@ -676,11 +724,6 @@ void handleDeleteFaultsFromDsPICAPI() {
 
 // Son N arızayı al API'si
 void handleGetLastNFaultsAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     // Kaç arıza isteniyor? (varsayılan 50)
     int count = 50;
     if (server.hasArg("count")) {
@@ -689,6 +732,12 @@ void handleGetLastNFaultsAPI() {
         if (count > 100) count = 100; // Maksimum 100 ile sınırla
     }
     
+    // Toplu okuma pahalı: önce sayının güncel olduğundan emin ol, değişmediyse 304
+    if (getFaultCountAge() >= FAULT_VERIFY_MS && clientHasCurrentVersion(DATA_FAULTS)) {
+        getTotalFaultCount();
+    }
+    if (handleConditionalGet(DATA_FAULTS)) return;
+    
     addLog("📥 Son " + String(count) + " arıza isteniyor", INFO, "API");
     
     std::vector<String> faultData;
@@ -725,11 +774,6 @@ void handleGetLastNFaultsAPI() {
 
 // Mevcut handleParsedFaultAPI fonksiyonunu GÜNCELLE
 void handleParsedFaultAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     String action = server.arg("action");
     
     if (action == "count") {
@@ -799,11 +843,6 @@ void handleParsedFaultAPI() {
 
 // ✅ handleUARTTestAPI fonksiyonu
 void handleUARTTestAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
     addLog("🧪 UART test başlatılıyor...", INFO, "WEB");
     
     JsonDocument doc;
@@ -832,18 +871,8 @@ void handleUARTTestAPI() {
     server.send(200, "application/json", output);
 }
 
-// LED durumu API handler'ı - GÜNCELLENMİŞ VERSİYON
-void handleGetLedStatusAPI() {
-    if (!checkSession()) {
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return;
-    }
-    
-    // "LN" komutuyla LED durumunu dsPIC'ten iste
-    String ledResponse;
-    bool success = sendCustomCommand("LN", ledResponse, 2000);
-    
-    JsonDocument doc;
+// LN yanıtını JSON'a çevir (API ve push kanalı ortak kullanır, log yazmaz)
+bool buildLedStatusJSON(JsonDocument& doc, bool success, const String& ledResponse) {
     doc["success"] = success;
     doc["command"] = "LN";
     doc["response"] = ledResponse;
@@ -949,15 +978,6 @@ void handleGetLedStatusAPI() {
                 doc["parsed"]["activeInputs"] = activeInputs;
                 doc["parsed"]["activeOutputs"] = activeOutputs;
 
-                // Log ekle (alarm bilgisiyle)
-                String logMsg = "LED durumu: IN=" + String(activeInputs) + "/8, OUT=" +
-                               String(activeOutputs) + "/8";
-                if (alarmByte != 0) {
-                    logMsg += ", ALARM=0x" + String((int)alarmByte, HEX);
-                }
-                logMsg += " [" + hexData + "]";
-                addLog(logMsg, INFO, "LED");
-
             } else {
                 doc["parsed"]["valid"] = false;
                 doc["parsed"]["error"] = "Data too short (expected at least 4 chars)";
@@ -971,6 +991,29 @@ void handleGetLedStatusAPI() {
         doc["parsed"]["error"] = "No response from dsPIC";
     }
     
+    
+    return doc["parsed"]["valid"] | false;
+}
+
+// LED durumu API handler'ı - GÜNCELLENMİŞ VERSİYON
+void handleGetLedStatusAPI() {
+    // "LN" komutuyla LED durumunu dsPIC'ten iste
+    String ledResponse;
+    bool success = sendCustomCommand("LN", ledResponse, 2000);
+    
+    JsonDocument doc;
+    if (buildLedStatusJSON(doc, success, ledResponse)) {
+        // Log ekle (alarm bilgisiyle)
+        long alarmByte = doc["parsed"]["alarmByte"] | 0;
+        String logMsg = "LED durumu: IN=" + String(doc["parsed"]["activeInputs"].as<int>()) + "/8, OUT=" +
+                       String(doc["parsed"]["activeOutputs"].as<int>()) + "/8";
+        if (alarmByte != 0) {
+            logMsg += ", ALARM=0x" + String((int)alarmByte, HEX);
+        }
+        logMsg += " [" + doc["parsed"]["rawData"].as<String>() + "]";
+        addLog(logMsg, INFO, "LED");
+    }
+    
     String output;
     serializeJson(doc, output);
     
@@ -979,12 +1022,7 @@ void handleGetLedStatusAPI() {
 }
 
 void handleGetNtpAPI() {
-    if (!checkSession()) { 
-        server.send(401); 
-        return; 
-    }
-    
-    addLog("🌐 NTP ayarları sorgulanıyor", DEBUG, "API");
+    LOG_DEBUG("API", "🌐 NTP ayarları sorgulanıyor");
     
      // dsPIC'ten güncel NTP ayarlarını al
     String ntp1_from_dspic = "";
@@ -995,41 +1033,26 @@ void handleGetNtpAPI() {
     if (dspicSuccess) {
         addLog("✅ dsPIC'ten NTP alındı: NTP1=" + ntp1_from_dspic + ", NTP2=" + ntp2_from_dspic, SUCCESS, "API");
         
-        // Global config'i güncelle
-        ntp1_from_dspic.toCharArray(ntpConfig.ntpServer1, sizeof(ntpConfig.ntpServer1));
-        ntp2_from_dspic.toCharArray(ntpConfig.ntpServer2, sizeof(ntpConfig.ntpServer2));
-        
-        // Preferences'a da kaydet
-        Preferences preferences;
-        preferences.begin("ntp-config", false);
-        preferences.putString("ntp_server1", ntp1_from_dspic);
-        preferences.putString("ntp_server2", ntp2_from_dspic);
-        preferences.end();
+        // Global config'i güncelle; değiştiyse kayıt ertelenmiş yazımla saklanır
+        if (ntp1_from_dspic != ntpConfig.ntpServer1 || ntp2_from_dspic != ntpConfig.ntpServer2) {
+            ntp1_from_dspic.toCharArray(ntpConfig.ntpServer1, sizeof(ntpConfig.ntpServer1));
+            ntp2_from_dspic.toCharArray(ntpConfig.ntpServer2, sizeof(ntpConfig.ntpServer2));
+            saveSettingsStore();
+        }
     } else {
         addLog("⚠️ dsPIC'ten NTP alınamadı, lokal değerler kullanılıyor", WARN, "API");
         
-        Preferences preferences;
-        preferences.begin("ntp-config", true);
-        ntp1_from_dspic = preferences.getString("ntp_server1", "192.168.3.2");
-        ntp2_from_dspic = preferences.getString("ntp_server2", "8.8.8.8");
-        preferences.end();
+        ntp1_from_dspic = ntpConfig.ntpServer1[0] ? ntpConfig.ntpServer1 : "192.168.3.2";
+        ntp2_from_dspic = ntpConfig.ntpServer2[0] ? ntpConfig.ntpServer2 : "8.8.8.8";
     }
     
-    // Network ayarlarını da oku
-    Preferences preferences;
-    preferences.begin("ntp-config", true);
-    String subnet = preferences.getString("subnet", "255.255.255.0");
-    String gateway = preferences.getString("gateway", "192.168.3.1");
-    String dns = preferences.getString("dns", "8.8.8.8");
-    preferences.end();
-    
-    // JSON yanıtı hazırla
+    // JSON yanıtı hazırla (network ayarları RAM'deki kayıttan)
     JsonDocument doc;
     doc["ntpServer1"] = ntp1_from_dspic;
     doc["ntpServer2"] = ntp2_from_dspic;
-    doc["subnet"] = subnet;           // YENİ
-    doc["gateway"] = gateway;         // YENİ
-    doc["dns"] = dns;                 // YENİ
+    doc["subnet"] = ntpConfig.subnet;
+    doc["gateway"] = ntpConfig.gateway;
+    doc["dns"] = ntpConfig.dns;
     doc["timezone"] = ntpConfig.timezone;
     doc["enabled"] = ntpConfig.enabled;
     doc["configured"] = ntpConfigured;
@@ -1038,18 +1061,13 @@ void handleGetNtpAPI() {
     String output;
     serializeJson(doc, output);
     
-    addLog("📤 NTP ayarları gönderildi: " + output, DEBUG, "API");
+    LOG_DEBUG("API", "📤 NTP ayarları gönderildi: %s", output.c_str());
     
     server.send(200, "application/json", output);
 }
 
 // ✅ BU FONKSİYONU DA BULUN VE DEĞİŞTİRİN:
 void handlePostNtpAPI() {
-    if (!checkSession()) { 
-        server.send(401); 
-        return; 
-    }
-    
     String server1 = server.arg("ntpServer1");
     String server2 = server.arg("ntpServer2");
     String subnet = server.arg("ntpSubnet");      // YENİ
@@ -1063,26 +1081,15 @@ void handlePostNtpAPI() {
     if (saveNTPSettings(server1, server2, subnet, gateway, dns, 3)) {
         // Başarılı kayıt sonrası backend'e gönder (zaten saveNTPSettings içinde yapılıyor)
         
-        // Kontrol için tekrar oku
-        Preferences preferences;
-        preferences.begin("ntp-config", true);
-        String checkServer1 = preferences.getString("ntp_server1", "");
-        String checkServer2 = preferences.getString("ntp_server2", "");
-        String checkSubnet = preferences.getString("subnet", "");
-        String checkGateway = preferences.getString("gateway", "");
-        String checkDNS = preferences.getString("dns", "");
-        preferences.end();
-        
-        addLog("✅ NTP kayıt kontrolü - NTP1: " + checkServer1 + ", NTP2: " + checkServer2, SUCCESS, "API");
-        
+        // Kaydedilen değerler RAM'deki kayıttan döner; flash yazımı arka planda
         JsonDocument doc;
         doc["success"] = true;
         doc["message"] = "NTP ve network ayarları kaydedildi";
-        doc["ntpServer1"] = checkServer1;
-        doc["ntpServer2"] = checkServer2;
-        doc["subnet"] = checkSubnet;
-        doc["gateway"] = checkGateway;
-        doc["dns"] = checkDNS;
+        doc["ntpServer1"] = ntpConfig.ntpServer1;
+        doc["ntpServer2"] = ntpConfig.ntpServer2;
+        doc["subnet"] = ntpConfig.subnet;
+        doc["gateway"] = ntpConfig.gateway;
+        doc["dns"] = ntpConfig.dns;
         
         String output;
         serializeJson(doc, output);
@@ -1096,11 +1103,6 @@ void handlePostNtpAPI() {
 
 // Baudrate değiştirme
 void handlePostBaudRateAPI() {
-    if (!checkSession()) { 
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return; 
-    }
-    
     String baudStr = server.arg("baud");
     if (baudStr.length() == 0) {
         server.send(400, "application/json", "{\"error\":\"Baudrate parametresi eksik\"}");
@@ -1112,15 +1114,9 @@ void handlePostBaudRateAPI() {
     addLog("⚙️ Baudrate değişikliği: " + String(newBaudRate) + " bps", INFO, "API");
     
     if (changeBaudRate(newBaudRate)) {
-        // Başarılı değişiklik sonrası ayarları kaydet
+        // Baudrate açılışta sabit değere döner; yalnızca çalışan değer güncellenir
         settings.currentBaudRate = newBaudRate;
         
-        // Preferences ile kaydet
-        Preferences prefs;
-        prefs.begin("app-settings", false);
-        prefs.putLong("baudRate", newBaudRate);
-        prefs.end();
-        
         JsonDocument doc;
         doc["success"] = true;
         doc["newBaudRate"] = newBaudRate;
@@ -1137,11 +1133,6 @@ void handlePostBaudRateAPI() {
 
 // Mevcut baudrate'i dsPIC'ten al
 void handleGetCurrentBaudRateAPI() {
-    if (!checkSession()) { 
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return; 
-    }
-    
     addLog("📡 Mevcut baudrate dsPIC'ten sorgulanıyor", INFO, "API");
     
     int currentBaud = getCurrentBaudRateFromDsPIC(); // uart_handler.cpp'deki yeni fonksiyon
@@ -1171,27 +1162,63 @@ void handleGetCurrentBaudRateAPI() {
 
 // Password change sayfası için token kontrolü (ama atmaz)
 void handlePasswordChangeCheck() {
-    String token = "";
-    if (server.hasHeader("Authorization")) {
-        String authHeader = server.header("Authorization");
-        if (authHeader.startsWith("Bearer ")) {
-            token = authHeader.substring(7);
-        }
-    }
+    const String& token = getRequestToken();
     
     // Token yoksa veya geçersizse sadece uyarı döndür
-    if (token.length() == 0 || settings.sessionToken.length() == 0 || token != settings.sessionToken) {
+    if (!isTokenValid(token)) {
         server.send(200, "application/json", "{\"validSession\":false,\"message\":\"Oturum geçersiz ama devam edebilirsiniz\"}");
     } else {
         server.send(200, "application/json", "{\"validSession\":true}");
     }
 }
 
-void handleGetLogsAPI() {
-    if (!checkSession()) { 
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return; 
+LogQuery parseLogQueryArgs() {
+    String levelFilter = server.arg("level");  // all, ERROR, WARN, INFO, etc.
+    String sourceFilter = server.arg("source"); // all veya belirli kaynak
+    String searchFilter = server.arg("search"); // Arama terimi
+    
+    LogQuery query;
+    if (levelFilter.length() > 0 && levelFilter != "all") {
+        query.level = logLevelFromString(levelFilter);
+    }
+    if (sourceFilter.length() > 0 && sourceFilter != "all") {
+        int sourceId = findLogSource(sourceFilter);
+        query.source = (sourceId >= 0) ? sourceId : LOG_SOURCE_NONE;
+    }
+    if (searchFilter.length() > 0) {
+        query.search = searchFilter;
+        query.search.toLowerCase();
+    }
+    return query;
+}
+
+void addLogEntryJSON(JsonArray& logs, const LogEntry& log) {
+    JsonObject logEntry = logs.add<JsonObject>();
+    logEntry["t"] = formatLogTimestamp(log.epoch);
+    logEntry["m"] = log.message;
+    logEntry["l"] = logLevelToString(log.level);
+    logEntry["s"] = getLogSourceName(log.source);
+    logEntry["id"] = log.seq; // Açılıştan beri benzersiz kayıt numarası
+    if (log.repeat > 0) {
+        // Tekrar penceresinde birleştirilen olay: toplam adet ve son görülme
+        logEntry["n"] = (uint32_t)log.repeat + 1;
+        logEntry["tl"] = formatLogTimestamp(log.lastEpoch);
+        if (log.lastMessage.length() > 0) logEntry["ml"] = log.lastMessage;
     }
+}
+
+void addLogStatsJSON(JsonDocument& doc) {
+    size_t levelCounts[LOG_LEVEL_COUNT];
+    getLogLevelCounts(levelCounts);
+    doc["stats"]["errorCount"] = levelCounts[ERROR];
+    doc["stats"]["warnCount"] = levelCounts[WARN];
+    doc["stats"]["infoCount"] = levelCounts[INFO];
+    doc["stats"]["successCount"] = levelCounts[SUCCESS];
+}
+
+void handleGetLogsAPI() {
+    // Yeni log yoksa sayfa/filtre fark etmeksizin içerik aynıdır
+    if (handleConditionalGet(DATA_LOGS)) return;
     
     // Sayfa numarasını al (varsayılan 1)
     int pageNumber = 1;
@@ -1200,82 +1227,45 @@ void handleGetLogsAPI() {
         if (pageNumber < 1) pageNumber = 1;
     }
     
-    // Filtre parametrelerini al (opsiyonel)
-    String levelFilter = server.arg("level");  // all, ERROR, WARN, INFO, etc.
-    String sourceFilter = server.arg("source"); // all veya belirli kaynak
-    String searchFilter = server.arg("search"); // Arama terimi
+    // Filtreler sayfalamadan önce uygulanır
+    LogQuery query = parseLogQueryArgs();
+    
+    // Eşleşen kayıtları al; istenen sayfa son sayfayı aşıyorsa son sayfaya çek
+    std::vector<LogEntry> pageLogs;
+    bool partial;
+    size_t totalMatches = queryLogs(query, pageNumber, pageLogs, &partial);
+    int totalPages = (totalMatches == 0) ? 1 : (totalMatches + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (pageNumber > totalPages) {
+        pageNumber = totalPages;
+        pageLogs.clear();
+        totalMatches = queryLogs(query, pageNumber, pageLogs, &partial);
+    }
     
     JsonDocument doc;
     
-    // Pagination bilgileri
+    // Pagination bilgileri (filtrelenmiş görünüme göre)
     doc["currentPage"] = pageNumber;
     doc["pageSize"] = PAGE_SIZE;
-    doc["totalLogs"] = getTotalLogCount();
-    doc["totalPages"] = getTotalPageCount();
-    
-    // Sayfa loglarını al
-    std::vector<LogEntry> pageLogs = getLogsPage(pageNumber);
+    doc["totalLogs"] = totalMatches;
+    doc["totalPages"] = totalPages;
+    if (partial) doc["partial"] = true;       // Günlük tarama sınırı: toplam alt sınır
+    doc["lastSeq"] = logStorage.lastSeq();   // /api/logs/tail imleci
+    doc["bootId"] = getBootId();             // İmleç bu açılışa ait
     
     JsonArray logArray = doc["logs"].to<JsonArray>();
     
     for (const auto& log : pageLogs) {
-        // Filtreleme kontrolü
-        bool includeLog = true;
-        
-        // Level filtresi
-        if (levelFilter.length() > 0 && levelFilter != "all") {
-            if (logLevelToString(log.level) != levelFilter) {
-                includeLog = false;
-            }
-        }
-        
-        // Source filtresi  
-        if (includeLog && sourceFilter.length() > 0 && sourceFilter != "all") {
-            if (log.source != sourceFilter) {
-                includeLog = false;
-            }
-        }
-        
-        // Arama filtresi
-        if (includeLog && searchFilter.length() > 0) {
-            String searchLower = searchFilter;
-            searchLower.toLowerCase();
-            String messageLower = log.message;
-            messageLower.toLowerCase();
-            String sourceLower = log.source;
-            sourceLower.toLowerCase();
-            
-            if (messageLower.indexOf(searchLower) == -1 && 
-                sourceLower.indexOf(searchLower) == -1) {
-                includeLog = false;
-            }
-        }
-        
-        if (includeLog) {
-            JsonObject logEntry = logArray.add<JsonObject>();
-            logEntry["t"] = log.timestamp;
-            logEntry["m"] = log.message;
-            logEntry["l"] = logLevelToString(log.level);
-            logEntry["s"] = log.source;
-            logEntry["id"] = log.millis_time; // Unique ID için millis kullan
-        }
+        addLogEntryJSON(logArray, log);
     }
     
-    // İstatistikler
-    int errorCount = 0, warnCount = 0, infoCount = 0, successCount = 0;
-    for (const auto& log : logStorage) {
-        switch(log.level) {
-            case ERROR: errorCount++; break;
-            case WARN: warnCount++; break;
-            case INFO: infoCount++; break;
-            case SUCCESS: successCount++; break;
-        }
-    }
+    // İstatistikler - indeks sayaçlarından, tarama yok
+    addLogStatsJSON(doc);
     
-    doc["stats"]["errorCount"] = errorCount;
-    doc["stats"]["warnCount"] = warnCount;
-    doc["stats"]["infoCount"] = infoCount;
-    doc["stats"]["successCount"] = successCount;
+    // Kaynak filtresi seçenekleri sayfadan bağımsız olarak tüm kaynaklardan gelir
+    JsonArray sources = doc["sources"].to<JsonArray>();
+    for (int i = 0; i < getLogSourceCount(); i++) {
+        sources.add(getLogSourceName(i));
+    }
     
     String output;
     serializeJson(doc, output);
@@ -1286,16 +1276,14 @@ void handleGetLogsAPI() {
 
 // handleClearLogsAPI fonksiyonunu güncelle - GERÇEKTEN TEMİZLEYECEK
 void handleClearLogsAPI() {
-    if (!checkSession()) { 
-        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-        return; 
-    }
-    
     // Temizlemeden önce log sayısını kaydet
     int previousLogCount = getTotalLogCount();
     
     // GERÇEKTEN TÜM LOGLARI TEMİZLE
-    clearLogs();
+    if (!clearLogs()) {
+        server.send(503, "application/json", "{\"error\":\"Log kuyruğu meşgul, temizleme uygulanamadı\"}");
+        return;
+    }
     
     // Başarılı yanıt
     JsonDocument doc;
@@ -1314,130 +1302,164 @@ void handleClearLogsAPI() {
     addLog("✅ " + String(previousLogCount) + " log kaydı kullanıcı tarafından temizlendi", SUCCESS, "SYSTEM");
 }
 
-void setupWebRoutes() {
+// Fault komutları için debug endpoint'i - POST /api/uart/send
+void handleUARTSendAPI() {
+    String command = server.arg("command");
+    if (command.length() == 0) {
+        server.send(400, "application/json", "{\"error\":\"Command parameter required\"}");
+        return;
+    }
     
-    server.on("/favicon.ico", HTTP_GET, []() { server.send(204); });
+    addLog("🧪 Manuel komut gönderiliyor: " + command, INFO, "UART");
     
-    // ANA SAYFALAR (Oturum kontrolü yok, JS halledecek)
-    server.on("/", HTTP_GET, []() { serveStaticFile("/index.html", "text/html"); });
-    server.on("/login.html", HTTP_GET, []() { serveStaticFile("/login.html", "text/html"); });
-    server.on("/password_change.html", HTTP_GET, []() { serveStaticFile("/password_change.html", "text/html"); });
+    String response;
+    bool success = sendCustomCommand(command, response, 3000);
     
-    // STATİK DOSYALAR
-    server.on("/style.css", HTTP_GET, []() { serveStaticFile("/style.css", "text/css"); });
-    server.on("/script.js", HTTP_GET, []() { serveStaticFile("/script.js", "application/javascript"); });
-    server.on("/login.js", HTTP_GET, []() { serveStaticFile("/login.js", "application/javascript"); });
-
-    // SPA SAYFA PARÇALARI (Oturum kontrolü GEREKLİ)
-    server.on("/pages/dashboard.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/dashboard.html", "text/html"); else server.send(401); });
-    server.on("/pages/network.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/network.html", "text/html"); else server.send(401); });
-    server.on("/pages/systeminfo.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/systeminfo.html", "text/html"); else server.send(401); });
-    server.on("/pages/ntp.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/ntp.html", "text/html"); else server.send(401); });
-    server.on("/pages/baudrate.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/baudrate.html", "text/html"); else server.send(401); });
-    server.on("/pages/fault.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/fault.html", "text/html"); else server.send(401); });
-    server.on("/pages/log.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/log.html", "text/html"); else server.send(401); });
-    server.on("/pages/datetime.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/datetime.html", "text/html"); else server.send(401); });
-    server.on("/pages/account.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/account.html", "text/html"); else server.send(401); });
-    server.on("/pages/backup.html", HTTP_GET, []() { if(checkSession()) serveStaticFile("/pages/backup.html", "text/html"); else server.send(401); });
+    JsonDocument doc;
+    doc["command"] = command;
+    doc["success"] = success;
+    doc["response"] = response;
+    doc["responseLength"] = response.length();
+    doc["timestamp"] = getFormattedTimestamp();
+    
+    String output;
+    serializeJson(doc, output);
+    
+    server.send(200, "application/json", output);
+}
 
+// Route tablosu: path, method, oturum gereksinimi, hız sınıfı, handler.
+// Oturum ve hız limiti kontrolleri handler'larda değil dispatchRoute'ta yapılır.
+static const RouteDef apiRoutes[] = {
     // KİMLİK DOĞRULAMA
-    server.on("/login", HTTP_POST, handleUserLogin);
-    server.on("/logout", HTTP_GET, handleUserLogout);
+    { "/login",                      HTTP_POST, ROUTE_PUBLIC,  RATE_NONE,    handleUserLogin },
+    { "/logout",                     HTTP_GET,  ROUTE_PUBLIC,  RATE_NONE,    handleUserLogout },
+    { "/api/change-password",        HTTP_POST, ROUTE_PUBLIC,  RATE_NONE,    handlePasswordChangeAPI },
+    { "/api/check-password-session", HTTP_GET,  ROUTE_PUBLIC,  RATE_NONE,    handlePasswordChangeCheck },  // Soft kontrol
+
+    // Sistem
+    { "/api/device-info",            HTTP_GET,  ROUTE_PUBLIC,  RATE_NONE,    handleDeviceInfoAPI },
+    { "/api/system-info",            HTTP_GET,  ROUTE_SESSION, RATE_LIMITED, handleSystemInfoAPI },
+    { "/api/system/reboot",          HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleSystemRebootAPI },
+    { "/api/system/hash-benchmark",  HTTP_GET,  ROUTE_SESSION, RATE_LIMITED, handleHashBenchmarkAPI },
+    { "/api/status",                 HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleStatusAPI },
+    { "/api/dashboard",              HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleDashboardAPI },      // Panel anlık görüntüsü
+    { "/api/notifications",          HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleNotificationAPI },    // since=<id>
+    { "/api/notifications/read",     HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleNotificationReadAPI },
+    { "/api/session/refresh",        HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleSessionRefresh },
+    { "/api/events",                 HTTP_GET,  ROUTE_PUBLIC,  RATE_NONE,    handleEventStreamAPI },    // Jeton query'de, kendi kontrolü
+    { "/metrics",                    HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleMetricsAPI },        // Prometheus route ölçümleri (Bearer token)
+
+    // Ayarlar ve ağ
+    { "/api/settings",               HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetSettingsAPI },
+    { "/api/settings",               HTTP_POST, ROUTE_SESSION, RATE_NONE,    handlePostSettingsAPI },
+    { "/api/network",                HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetNetworkAPI },
+    { "/api/network",                HTTP_POST, ROUTE_SESSION, RATE_NONE,    handlePostNetworkAPI },
+    { "/api/network/confirm",        HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleConfirmNetworkAPI },
+    { "/api/ntp",                    HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetNtpAPI },
+    { "/api/ntp",                    HTTP_POST, ROUTE_SESSION, RATE_NONE,    handlePostNtpAPI },
+    { "/api/baudrate/current",       HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetCurrentBaudRateAPI },
+    { "/api/baudrate",               HTTP_POST, ROUTE_SESSION, RATE_NONE,    handlePostBaudRateAPI },
+
+    // Loglar
+    { "/api/logs",                   HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetLogsAPI },
+    { "/api/logs/clear",             HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleClearLogsAPI },
+    { "/api/logs/tail",              HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleLogTailAPI },        // since=<seq>, uzun bekleme
+
+    // DateTime
+    { "/api/datetime",               HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetDateTimeAPI },
+    { "/api/datetime/fetch",         HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleFetchDateTimeAPI },
+    { "/api/datetime/set",           HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleSetDateTimeAPI },
+
+    // UART / LED
+    { "/api/uart/test",              HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleUARTTestAPI },
+    { "/api/uart/send",              HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleUARTSendAPI },
+    { "/api/led/status",             HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetLedStatusAPI },
+
+    // Arızalar
+    { "/api/faults/count",           HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetFaultCountAPI },
+    { "/api/faults/get",             HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleGetSpecificFaultAPI },
+    { "/api/faults/parsed",          HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleParsedFaultAPI },
+    { "/api/faults/delete",          HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleDeleteFaultsFromDsPICAPI },
+    { "/api/faults/last",            HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleGetLastNFaultsAPI },
+
+    // Yedekleme (yükleme parçaları handleBackupUpload'da ayrıca kontrol edilir)
+    { "/api/backup/download",        HTTP_GET,  ROUTE_SESSION, RATE_NONE,    handleBackupDownload },
+    { "/api/backup/upload",          HTTP_POST, ROUTE_SESSION, RATE_NONE,    handleBackupRestore, handleBackupUpload },
+};
 
-    // API ENDPOINT'LERİ
+// Oturum gerektirmeyen statik dosyalar
+static const char* const publicFiles[][2] = {
+    { "/index.html",           "text/html" },
+    { "/login.html",           "text/html" },
+    { "/password_change.html", "text/html" },
+    { "/style.css",            "text/css" },
+    { "/script.js",            "application/javascript" },
+    { "/login.js",             "application/javascript" },
+};
 
-    // Device Info (Auth gerekmez)
-    server.on("/api/device-info", HTTP_GET, handleDeviceInfoAPI);
-    
-    // System Info (Auth gerekli)
-    server.on("/api/system-info", HTTP_GET, handleSystemInfoAPI);
-
-    // Network Configuration
-    server.on("/api/network", HTTP_GET, handleGetNetworkAPI);
-    server.on("/api/network", HTTP_POST, handlePostNetworkAPI);
-
-    // Notifications
-    server.on("/api/notifications", HTTP_GET, handleNotificationAPI);
-    
-    // System Reboot
-    server.on("/api/system/reboot", HTTP_POST, handleSystemRebootAPI);
-
-    server.on("/api/status", HTTP_GET, handleStatusAPI);
-    server.on("/api/settings", HTTP_GET, handleGetSettingsAPI);
-    server.on("/api/settings", HTTP_POST, handlePostSettingsAPI);
-    server.on("/api/ntp", HTTP_GET, handleGetNtpAPI);
-    server.on("/api/ntp", HTTP_POST, handlePostNtpAPI);
-    server.on("/api/baudrate/current", HTTP_GET, handleGetCurrentBaudRateAPI);  // Mevcut baudrate sorgula
-    server.on("/api/baudrate", HTTP_POST, handlePostBaudRateAPI);   // Baudrate değiştir
-    server.on("/api/logs", HTTP_GET, handleGetLogsAPI);
-    server.on("/api/logs/clear", HTTP_POST, handleClearLogsAPI);
-    // DateTime API endpoints
-    server.on("/api/datetime", HTTP_GET, handleGetDateTimeAPI);
-    server.on("/api/datetime/fetch", HTTP_POST, handleFetchDateTimeAPI);
-    server.on("/api/datetime/set", HTTP_POST, handleSetDateTimeAPI);
-    // ✅ UART Test API'si ekle
-    server.on("/api/uart/test", HTTP_GET, handleUARTTestAPI);
-    // ✅ LED API'si ekle
-    server.on("/api/led/status", HTTP_GET, handleGetLedStatusAPI);
-
-    // YENİ route'ları EKLE:
-    server.on("/api/faults/count", HTTP_GET, handleGetFaultCountAPI);
-    server.on("/api/faults/get", HTTP_POST, handleGetSpecificFaultAPI);
-    server.on("/api/faults/parsed", HTTP_POST, handleParsedFaultAPI); // Güncellendi
-
-     // ✅ Fault komutları için debug endpoint'leri
-    server.on("/api/uart/send", HTTP_POST, []() {
-        if (!checkSession()) {
-            server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
-            return;
-        }
-        
-        String command = server.arg("command");
-        if (command.length() == 0) {
-            server.send(400, "application/json", "{\"error\":\"Command parameter required\"}");
-            return;
-        }
-        
-        addLog("🧪 Manuel komut gönderiliyor: " + command, INFO, "UART");
-        
-        String response;
-        bool success = sendCustomCommand(command, response, 3000);
-        
-        JsonDocument doc;
-        doc["command"] = command;
-        doc["success"] = success;
-        doc["response"] = response;
-        doc["responseLength"] = response.length();
-        doc["timestamp"] = getFormattedTimestamp();
-        
-        String output;
-        serializeJson(doc, output);
-        
-        server.send(200, "application/json", output);
-    });
+// SPA sayfa parçaları (oturum gerekli)
+static const char* const sessionPages[] = {
+    "dashboard", "network", "systeminfo", "ntp", "baudrate",
+    "fault", "log", "datetime", "account", "backup"
+};
 
-    // Arıza silme API'si
-    server.on("/api/faults/delete", HTTP_POST, handleDeleteFaultsFromDsPICAPI);
-    
-    // Son N arızayı al API'si
-    server.on("/api/faults/last", HTTP_GET, handleGetLastNFaultsAPI);
+// Tek dispatch adımı: jeton bir kez ayrıştırılır, ara katmanlar sırayla uygulanır
+static void dispatchRoute(const RouteDef& route) {
+    beginRequestSession();
 
+    if (route.auth == ROUTE_SESSION && !checkSession()) {
+        server.send(401, "application/json", "{\"error\":\"Unauthorized\"}");
+    } else if (route.rate == RATE_LIMITED && !checkRateLimit()) {
+        server.send(429, "application/json", "{\"error\":\"Too many requests\"}");
+    } else {
+        route.handler();
+    }
+
+    endRequestSession();
+}
+
+void setupWebRoutes() {
+    // Koşullu GET için If-None-Match başlığını topla (Authorization her zaman toplanır)
+    const char* headerKeys[] = { "If-None-Match" };
+    server.collectHeaders(headerKeys, 1);
+    
+    server.on("/favicon.ico", HTTP_GET, []() { server.send(204); });
     
-    server.on("/api/backup/download", HTTP_GET, handleBackupDownload);
-    // Yedek yükleme için doğru handler tanımı
-    server.on("/api/backup/upload", HTTP_POST, 
-        []() { server.send(200, "text/plain", "OK"); }, // Önce bir OK yanıtı gönderilir
-        handleBackupUpload // Sonra dosya yükleme işlenir
-    );
-    server.on("/api/change-password", HTTP_POST, handlePasswordChangeAPI);
+    // ANA SAYFALAR VE STATİK DOSYALAR (Oturum kontrolü yok, JS halledecek)
+    server.on("/", HTTP_GET, []() { serveStaticFile("/index.html", "text/html"); });
+    for (const auto& file : publicFiles) {
+        String path = file[0];
+        String contentType = file[1];
+        server.on(path, HTTP_GET, [path, contentType]() { serveStaticFile(path, contentType); });
+    }
+
+    // SPA SAYFA PARÇALARI (Oturum kontrolü GEREKLİ)
+    for (const char* page : sessionPages) {
+        String path = "/pages/" + String(page) + ".html";
+        server.on(path, HTTP_GET, [path]() {
+            beginRequestSession();
+            if (checkSession()) serveStaticFile(path, "text/html");
+            else server.send(401);
+            endRequestSession();
+        });
+    }
 
-    // Password Change Check (soft check)
-    server.on("/api/check-password-session", HTTP_GET, handlePasswordChangeCheck);
+    // API ENDPOINT'LERİ
+    for (const RouteDef& route : apiRoutes) {
+        const RouteDef* def = &route;
+        if (route.uploadHandler != NULL) {
+            server.on(route.path, route.method, [def]() { dispatchRoute(*def); }, route.uploadHandler);
+        } else {
+            server.on(route.path, route.method, [def]() { dispatchRoute(*def); });
+        }
+    }
     
     // Her response'ta security headers ekle
     server.onNotFound([]() {
         addSecurityHeaders();
-        addLog("404 isteği: " + server.uri(), WARN, "WEB");
+        // Tarama patlamaları tek kayda katlanır; ilk ve son yol görünür kalır
+        addLogf(WARN, "WEB", "404 isteği: %s", server.uri().c_str());
         server.send(404, "application/json", "{\"error\":\"Not Found\"}");
     });
     
@@ -0,0 +1,109 @@
+// test_main.cpp - SNTP paket biçimi birim testleri (pio test -e native)
+#include <unity.h>
+#include <string.h>
+#include "sntp_packet.h"
+
+static SNTPHeader syncedHeader() {
+    SNTPHeader header;
+    header.synced = true;
+    header.stratum = 3;
+    header.rootDispersion = 0x00001234;
+    header.referenceId = 0xC0A80101;      // 192.168.1.1
+    header.referenceSec = 0xE8000000;
+    header.referenceFrac = 0x80000000;
+    return header;
+}
+
+static void makeRequest(uint8_t* packet, uint8_t version, uint8_t mode) {
+    memset(packet, 0, NTP_PACKET_SIZE);
+    packet[0] = (version << 3) | mode;
+    packet[2] = 6;                         // poll
+    for (int i = 0; i < 8; i++) packet[40 + i] = 0xA0 + i;   // İstemci gönderme zamanı
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_timestamp_epoch_and_timezone() {
+    uint32_t sec, frac;
+    sntpTimestamp(0, 0, 0, sec, frac);
+    TEST_ASSERT_EQUAL_UINT32(NTP_UNIX_OFFSET, sec);
+    TEST_ASSERT_EQUAL_UINT32(0, frac);
+
+    // Yerel saat UTC+3: 03:00 yerel = 00:00 UTC
+    sntpTimestamp(3 * 3600, 500000, 3, sec, frac);
+    TEST_ASSERT_EQUAL_UINT32(NTP_UNIX_OFFSET, sec);
+    TEST_ASSERT_EQUAL_UINT32(0x80000000UL, frac);
+
+    // Negatif dilim
+    sntpTimestamp(0, 0, -5, sec, frac);
+    TEST_ASSERT_EQUAL_UINT32(NTP_UNIX_OFFSET + 5 * 3600, sec);
+}
+
+void test_request_filter() {
+    uint8_t packet[NTP_PACKET_SIZE];
+    makeRequest(packet, 4, NTP_MODE_CLIENT);
+    TEST_ASSERT_TRUE(sntpIsClientRequest(packet, NTP_PACKET_SIZE));
+    TEST_ASSERT_FALSE(sntpIsClientRequest(packet, NTP_PACKET_SIZE - 1));
+
+    makeRequest(packet, 1, NTP_MODE_CLIENT);
+    TEST_ASSERT_TRUE(sntpIsClientRequest(packet, NTP_PACKET_SIZE));
+
+    makeRequest(packet, 0, NTP_MODE_CLIENT);
+    TEST_ASSERT_FALSE(sntpIsClientRequest(packet, NTP_PACKET_SIZE));
+    makeRequest(packet, 5, NTP_MODE_CLIENT);
+    TEST_ASSERT_FALSE(sntpIsClientRequest(packet, NTP_PACKET_SIZE));
+
+    // Sunucu modundaki paket (yansıtma) yanıtlanmaz
+    makeRequest(packet, 4, NTP_MODE_SERVER);
+    TEST_ASSERT_FALSE(sntpIsClientRequest(packet, NTP_PACKET_SIZE));
+}
+
+void test_response_fields() {
+    uint8_t packet[NTP_PACKET_SIZE];
+    makeRequest(packet, 3, NTP_MODE_CLIENT);
+    SNTPHeader header = syncedHeader();
+
+    sntpBuildResponse(packet, header, 0x11223344, 0x55667788);
+    sntpSetTransmit(packet, 0x11223345, 0x01020304);
+
+    TEST_ASSERT_EQUAL_UINT8((NTP_LI_NONE << 6) | (3 << 3) | NTP_MODE_SERVER, packet[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, packet[1]);
+    TEST_ASSERT_EQUAL_UINT8(6, packet[2]);
+    TEST_ASSERT_EQUAL_INT8(NTP_PRECISION, (int8_t)packet[3]);
+    TEST_ASSERT_EQUAL_UINT32(0, sntpReadU32(packet + 4));               // Root delay
+    TEST_ASSERT_EQUAL_UINT32(0x00001234, sntpReadU32(packet + 8));
+    TEST_ASSERT_EQUAL_UINT32(0xC0A80101, sntpReadU32(packet + 12));
+    TEST_ASSERT_EQUAL_UINT32(0xE8000000, sntpReadU32(packet + 16));
+    TEST_ASSERT_EQUAL_UINT32(0x80000000, sntpReadU32(packet + 20));
+
+    // İstemcinin gönderme zamanı originate alanına taşınır
+    for (int i = 0; i < 8; i++) TEST_ASSERT_EQUAL_UINT8(0xA0 + i, packet[24 + i]);
+
+    TEST_ASSERT_EQUAL_UINT32(0x11223344, sntpReadU32(packet + 32));
+    TEST_ASSERT_EQUAL_UINT32(0x55667788, sntpReadU32(packet + 36));
+    TEST_ASSERT_EQUAL_UINT32(0x11223345, sntpReadU32(packet + 40));
+    TEST_ASSERT_EQUAL_UINT32(0x01020304, sntpReadU32(packet + 44));
+}
+
+void test_unsynced_response_sets_alarm() {
+    uint8_t packet[NTP_PACKET_SIZE];
+    makeRequest(packet, 4, NTP_MODE_CLIENT);
+    SNTPHeader header = syncedHeader();
+    header.synced = false;
+    header.stratum = NTP_STRATUM_UNSYNC;
+
+    sntpBuildResponse(packet, header, 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(NTP_LI_ALARM, packet[0] >> 6);
+    TEST_ASSERT_EQUAL_UINT8(4, (packet[0] >> 3) & 0x07);
+    TEST_ASSERT_EQUAL_UINT8(NTP_STRATUM_UNSYNC, packet[1]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_timestamp_epoch_and_timezone);
+    RUN_TEST(test_request_filter);
+    RUN_TEST(test_response_fields);
+    RUN_TEST(test_unsynced_response_sets_alarm);
+    return UNITY_END();
+}
\ No newline at end of file